@@ -28,13 +28,16 @@
 #include "omegaConfig.h"
 #include "omega/ApplicationBase.h"
 #include "omega/Application.h"
+#include "omega/AsyncLogSink.h"
 #include "omega/AsyncTask.h"
 #include "omega/CameraController.h"
 #include "omega/Color.h"
 #include "omega/DisplaySystem.h"
 #include "omega/EventSharingModule.h"
+#include "omega/FrameArena.h"
 #include "omega/GpuResource.h"
 #include "omega/MissionControl.h"
+#include "omega/StatsStream.h"
 #include "omega/RenderTarget.h"
 #include "omega/RenderTarget.h"
 #include "omega/SystemManager.h"
@@ -42,6 +45,10 @@
 #include "omega/PythonInterpreter.h"
 #include "omega/Texture.h"
 #include "omega/ImageUtils.h"
+#include "omega/ResourceCache.h"
+#include "omega/SceneReplicationModule.h"
+#include "omega/PosePredictor.h"
+#include "omega/TileQualityPolicy.h"
 #include "omega/TrackedObject.h"
 
 // Include the modules config file.
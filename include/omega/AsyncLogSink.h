@@ -0,0 +1,109 @@
+/******************************************************************************
+ * THE OMEGA LIB PROJECT
+ *-----------------------------------------------------------------------------
+ * Copyright 2010-2013		Electronic Visualization Laboratory, 
+ *							University of Illinois at Chicago
+ * Authors:										
+ *  Alessandro Febretti		febret@gmail.com
+ *-----------------------------------------------------------------------------
+ * Copyright (c) 2010-2013, Electronic Visualization Laboratory,  
+ * University of Illinois at Chicago
+ * All rights reserved.
+ * Redistribution and use in source and binary forms, with or without modification, 
+ * are permitted provided that the following conditions are met:
+ * 
+ * Redistributions of source code must retain the above copyright notice, this 
+ * list of conditions and the following disclaimer. Redistributions in binary 
+ * form must reproduce the above copyright notice, this list of conditions and 
+ * the following disclaimer in the documentation and/or other materials provided 
+ * with the distribution. 
+ * 
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" 
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO THE 
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE 
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE 
+ * LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL 
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE  GOODS OR 
+ * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER 
+ * CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, 
+ * OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE 
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ *-----------------------------------------------------------------------------
+ * What's in this file
+ *	A log listener that moves the cost of log output off the threads that 
+ *  generate it.
+ ******************************************************************************/
+#ifndef __ASYNC_LOG_SINK_H__
+#define __ASYNC_LOG_SINK_H__
+
+#include "omega/osystem.h"
+
+namespace omega
+{
+    class LogWriterThread;
+
+    ///////////////////////////////////////////////////////////////////////////
+    //! Delivers log lines to listeners (console, mission control) from a 
+    //! background thread. Each thread generating log lines writes them to its
+    //! own fixed-size ring buffer, without taking any lock. A single writer 
+    //! thread drains the buffers and calls the listeners.
+    //! When a thread logs faster than the writer can keep up, lines that do 
+    //! not fit its buffer are dropped and a notice with the number of dropped
+    //! lines is sent instead. Consecutive identical lines are merged into one
+    //! line with a repeat count.
+    //! Lines generated by one thread are delivered in order, but lines from 
+    //! different threads may be interleaved differently than they were 
+    //! generated.
+    class OMEGA_API AsyncLogSink: public ILogListener
+    {
+    friend class LogWriterThread;
+    public:
+        //! Number of lines each thread can buffer.
+        static const int RingSize = 1024;
+        //! Interval at which the writer checks for new lines, in milliseconds.
+        static const int WriterInterval = 5;
+
+    public:
+        //! Starts asynchronous logging. Listeners registered through 
+        //! addListener after this call are fed by the writer thread.
+        static void enable();
+        //! Delivers all pending lines, stops the writer thread and gives 
+        //! listeners back to the standard synchronous logger.
+        static void disable();
+        static bool isEnabled() { return mysInstance != NULL; }
+
+        //! Use these instead of ologaddlistener / ologremlistener: when 
+        //! asynchronous logging is disabled they just forward to them.
+        //! After removeListener returns, the listener is guaranteed not to 
+        //! receive more lines.
+        //@{
+        static void addListener(ILogListener* listener);
+        static void removeListener(ILogListener* listener);
+        //@}
+
+        //! Returns the total number of lines dropped because a thread ring 
+        //! buffer was full.
+        static uint getDroppedLines();
+
+        // ILogListener override. Called by the thread generating the line.
+        virtual void addLine(const String& line);
+
+    private:
+        AsyncLogSink();
+        ~AsyncLogSink();
+
+        //! Delivers all pending lines. Returns the number of lines read.
+        int drain();
+        void deliver(const String& line);
+
+    private:
+        static AsyncLogSink* mysInstance;
+
+        LogWriterThread* myWriter;
+        Lock myListenersLock;
+        List<ILogListener*> myListeners;
+        Vector<String> myLines;
+    };
+}; // namespace omega
+
+#endif
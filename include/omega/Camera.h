@@ -43,6 +43,7 @@
 #include "omega/SceneNode.h"
 #include "omega/RenderTarget.h"
 #include "omega/CameraOutput.h"
+#include "omega/PosePredictor.h"
 
 namespace omega {
 	//! Id to be assigned to crated cameras
@@ -50,6 +51,40 @@ namespace omega {
 
 	class CameraController;
 	class Camera;
+
+	///////////////////////////////////////////////////////////////////////////
+	//! A lock-free ring of head poses stamped with the frame number they will
+	//! be drawn in. There must be a single writer (the thread starting 
+	//! frames), while any number of readers (pipe threads) can read 
+	//! concurrently. Readers never block the writer: a reader retries if the
+	//! slot it is reading gets overwritten.
+	class OMEGA_API HeadPoseLatch
+	{
+	public:
+		//! Number of stamped poses kept. Must be larger than the display 
+		//! system frame latency.
+		static const int Size = 8;
+
+	public:
+		HeadPoseLatch();
+		void write(uint64 frameNum, const Vector3f& position, const Quaternion& orientation);
+		//! Reads the pose stamped with the target frame. Returns false if no
+		//! pose is available for that frame.
+		bool read(uint64 targetFrame, Vector3f* position, Quaternion* orientation);
+
+	private:
+		struct Slot
+		{
+			// Odd while the slot is being written.
+			volatile uint sequence;
+			volatile uint64 frameNum;
+			// NOTE: poses are stored as plain floats to avoid alignment 
+			// requirements on the slot array.
+			float position[3];
+			float orientation[4];
+		};
+		Slot mySlots[Size];
+	};
 	///////////////////////////////////////////////////////////////////////////
 	//! Implements a listener that can be attached to cameras to listen to draw
 	//! methods. All user method implementations must be reentrant, since they
@@ -157,6 +192,35 @@ namespace omega {
 		//! Set eye separation for stereo rendering
 		void setEyeSeparation(float value) { myEyeSeparation = value; }
 		float getEyeSeparation() { return myEyeSeparation; }
+		//! When late latching is enabled, renderers draw frame N using the 
+		//! newest tracker sample received before the master starts frame N,
+		//! instead of the head transform computed at the beginning of the 
+		//! frame update. The master computes the pose (predicted to the 
+		//! display time if a head pose predictor is set) after the update and
+		//! sends it to all cluster nodes with the frame, so all nodes draw a
+		//! frame using the same pose. Requires the equalizer display system.
+		void setLateLatchEnabled(bool value) { myLateLatchEnabled = value; }
+		bool isLateLatchEnabled() { return myLateLatchEnabled; }
+		//! Sets a predictor used to extrapolate the tracked head pose to the
+		//! expected display time. Set to NULL to disable head pose prediction.
+		//! When externalSamples is true, the caller feeds samples to the 
+		//! predictor and the camera does not add its own tracker events.
+		void setHeadPosePredictor(PosePredictor* value, bool externalSamples = false)
+		{ myHeadPosePredictor = value; myHeadPosePredictorExternal = externalSamples; }
+		PosePredictor* getHeadPosePredictor() { return myHeadPosePredictor; }
+		//@}
+
+		//! Late latching implementation, used by the display system.
+		//@{
+		//! @internal Called on the master for events received after the 
+		//! frame update. The events are not consumed: they are dispatched 
+		//! to the camera as usual at the next frame.
+		void addLateSample(const Event& evt);
+		//! @internal Called on the master after the late samples have been
+		//! added: returns the head pose to draw the frame being started with.
+		void computeLateHeadPose(const UpdateContext& context, Vector3f* position, Quaternion* orientation);
+		//! @internal Called on all nodes before renderers draw the frame.
+		void setLatchedHeadPose(uint64 frameNum, const Vector3f& position, const Quaternion& orientation);
 		//@}
 
 		//! Converts a point from local to world coordinates using the camera position and orientation
@@ -218,6 +282,16 @@ namespace omega {
 		Quaternion myHeadOrientation;
 		//! Observer head transform
 		AffineTransform3 myHeadTransform;
+		//! Late latching
+		bool myLateLatchEnabled;
+		HeadPoseLatch myHeadPoseLatch;
+		//! Newest tracker sample received after the frame update
+		Vector3f myLateSamplePosition;
+		Quaternion myLateSampleOrientation;
+		bool myLateSampleValid;
+		//! Head pose prediction
+		Ref<PosePredictor> myHeadPosePredictor;
+		bool myHeadPosePredictorExternal;
 
 		//! Eye separation
 		float myEyeSeparation;
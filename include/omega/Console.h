@@ -90,6 +90,9 @@ namespace omega {
 	class OMEGA_API ConsoleRenderPass: public RenderPass
 	{
 	public:
+		//! Maximum number of stats shown in the stats view.
+		static const int MaxStatLines = 32;
+
 		ConsoleRenderPass(Renderer* renderer, Console* owner);
 		void render(Renderer* renderer, const DrawContext& context);
 
@@ -236,7 +236,8 @@ namespace omega
         DisplayConfig(): 
             disableConfigGenerator(false), latency(1), 
             enableSwapSync(true), forceMono(false), verbose(false),
-            invertStereo(false),
+            invertStereo(false), groupTilesByDevice(false),
+            idleMode(false), idleTimeout(5.0f), idleFrameInterval(1.0f),
             rayToPointConverter(NULL)
         {
             memset(tileGrid, 0, sizeof(tileGrid));
@@ -296,6 +297,11 @@ namespace omega
         //! Disable window borders
         bool borderless;
 
+        //! When set to true, all the tiles of a node that use the same device
+        //! are placed in a single pipe, even when they are not listed 
+        //! consecutively. Default is false.
+        bool groupTilesByDevice;
+
         // Display fps on each tile.
         bool drawFps;
 
@@ -321,10 +327,36 @@ namespace omega
         int numNodes;
         //! Node configurations for a multimachine display system.
         DisplayNodeConfig nodes[MaxNodes];
-        //! Interval in milliseconds between node launcher commands
+        //! Time in milliseconds the master waits after launching nodes. Used
+        //! only when the launcher handshake is disabled.
         int launcherInterval; 
+        //! When set to true, the master launches all nodes and waits for each
+        //! of them to report it is ready, instead of waiting for a fixed 
+        //! launcher interval. Default is false.
+        bool launcherHandshake;
+        //! Maximum time in milliseconds the master waits for nodes to report
+        //! they are ready.
+        int launcherTimeout;
+        //! Host name and port nodes use to reach the master launcher. 
+        //! Default to the master host name and basePort - 1. The host name
+        //! is also used by nodes to reach the master mission control server.
+        String launcherHost;
+        int launcherPort;
         //! Node launcher command.
         String nodeLauncher;
+
+        //! Render on demand
+        //@{
+        //! When set to true, the master stops drawing frames on all nodes 
+        //! while nothing changes in the application.
+        bool idleMode;
+        //! Time in seconds without changes before the display becomes idle.
+        float idleTimeout;
+        //! When idle, draw a frame every idleFrameInterval seconds, to let
+        //! time-based application logic run. 0 = draw no frames until a 
+        //! change is detected.
+        float idleFrameInterval;
+        //@}
         //! Node killer command.
         String nodeKiller;
         //! Default port used to connect to nodes
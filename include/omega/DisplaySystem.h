@@ -96,11 +96,32 @@ public:
     const Color& getBackgroundColor() { return myBackgroundColor; }
     void setBackgroundColor(const Color& value) { myBackgroundColor = value; }
 
+    //! Render on demand
+    //! When idle mode is enabled in the display configuration, the display
+    //! system stops drawing frames (or draws them at a low rate) after a 
+    //! period without changes. Changes include input events, scene node
+    //! updates, shared data changes and explicit redraw requests.
+    //@{
+    //! Marks the display content as changed, waking up an idle display.
+    //! Can be called from any thread.
+    static void requestRedraw() { mysRedrawRequested = true; }
+    bool isIdle() { return myIdle; }
+    //! Returns the time in seconds the last waitForRedraw call blocked for.
+    //! Frame updates exclude it from the frame time, so animations resume 
+    //! where they stopped instead of jumping forward after an idle period.
+    float getIdleWaitTime() { return myIdleWaitTime; }
+    //@}
+
 protected:
 
     DisplaySystem():
-         myBackgroundColor(0.2f, 0.2f, 0.2f)
+         myBackgroundColor(0.2f, 0.2f, 0.2f),
+         myIdle(false),
+         myLastChangeTime(0),
+         myLastIdleFrameTime(0),
+         myIdleWaitTime(0)
     {
+        myIdleTimer.start();
         // Increase the display config reference count: this is done because 
         // DisplayConfig may be accessed by reference (for instance through the
         // getDIsplayConfig python API call), and releasing that reference would
@@ -108,10 +129,23 @@ protected:
         myDisplayConfig.ref();
     }
 
+    //! Called by display system implementations before starting a frame.
+    //! When idle mode is enabled and nothing changed, blocks until a change
+    //! is detected or the next idle frame is due.
+    void waitForRedraw();
+
     DisplayConfig myDisplayConfig;
 
 private:
     Color myBackgroundColor;
+
+    // Render on demand
+    static volatile bool mysRedrawRequested;
+    bool myIdle;
+    Timer myIdleTimer;
+    float myLastChangeTime;
+    float myLastIdleFrameTime;
+    float myIdleWaitTime;
 };
 
 }; // namespace omega
@@ -78,6 +78,24 @@ namespace omega
 		Eye eye;
 		//! The current draw task.
 		Task task;
+		//! Scale of the scene resolution with respect to the native tile
+		//! resolution. Lower than 1 when the renderer uses dynamic resolution.
+		float resolutionScale;
+
+		//! Tile quality
+		//! Set at the start of each frame by the renderer tile quality policy.
+		//@{
+		//! The quality class of the tile, or -1 for full quality.
+		int tileQualityClass;
+		float tileResolutionScale;
+		//! When true, the tile is drawn in mono regardless of its stereo mode.
+		bool tileForceMono;
+		int tileFrameInterval;
+		//! Last frame in which the tile scene was drawn to the renderer scaled
+		//! scene target, or 0 if the scaled scene is not valid.
+		uint64 lastScaledSceneFrame;
+		void updateTileQuality();
+		//@}
 		//! Information about the drawing channel associated with this context.
 		//ChannelInfo* channel;
 		const DisplayTileConfig* tile;
@@ -111,7 +129,7 @@ namespace omega
 		void updateViewport();
 		void setupInterleaver();
 		void initializeStencilInterleaver(int gliWindowWidth, int gliWindowHeight);
-		DisplayTileConfig::StereoMode getCurrentStereoMode();
+		DisplayTileConfig::StereoMode getCurrentStereoMode() const;
 		// Clears the frame buffer.
 		void clear();
 		bool stencilInitialized;
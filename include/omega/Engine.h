@@ -45,6 +45,7 @@
 #include "SceneQuery.h"
 #include "Camera.h"
 #include "Font.h"
+#include "FrameArena.h"
 #include "omicron/SoundManager.h"
 
 namespace omega {
@@ -104,6 +105,11 @@ namespace omega {
         Camera* getCameraById(int id);
         CameraCollection getCameras();
         CameraCollection getCameras() const;
+        //! Copies the camera list into a frame vector. Renderers call this
+        //! from their own threads, while cameras get created and destroyed in
+        //! the main thread. The vector allocates from the calling thread frame
+        //! arena, so this does not touch the heap.
+        void getCameras(FrameVector< Ref<Camera> >::Type& cameras) const;
         //@}
 
         //! Font management
@@ -134,6 +140,8 @@ namespace omega {
 
         //! Sound management
         //@{
+        //! Finishes sound initialization once the sound server is running.
+        //! Called by Engine::update on the master node.
         void initializeSound();
         SoundManager* getSoundManager();
         SoundEnvironment* getSoundEnvironment();
@@ -145,6 +153,26 @@ namespace omega {
         Event::Flags getPrimaryButton() { return myPrimaryButton; }
         //@}
 
+        //! Fixed timestep simulation
+        //! Modules implementing EngineModule::fixedUpdate are run at a fixed
+        //! rate, independent from the frame rate. Scene nodes moved by fixed
+        //! update code can enable transform interpolation (see 
+        //! SceneNode::setTransformInterpolationEnabled) to move smoothly 
+        //! between simulation steps. Fixed updates run after module updates.
+        //@{
+        //! Sets the number of fixed updates per second.
+        void setFixedUpdateRate(float value);
+        float getFixedUpdateRate() { return myFixedUpdateRate; }
+        //! Sets the maximum number of fixed updates run during a single frame.
+        //! When a frame takes longer than this, the leftover simulation time
+        //! is dropped and the simulation slows down instead of spiraling.
+        void setMaxFixedUpdatesPerFrame(int value) { myMaxFixedUpdatesPerFrame = value; }
+        int getMaxFixedUpdatesPerFrame() { return myMaxFixedUpdatesPerFrame; }
+        //! Returns the fraction of a fixed timestep elapsed since the last 
+        //! fixed update (0 - 1). Use to blend simulation state for rendering.
+        float getFixedUpdateAlpha() { return myFixedUpdateAlpha; }
+        //@}
+
         virtual void initialize();
         virtual void dispose();
         //! Resets the omegalib engine to its initial state. Useful for runtime
@@ -168,6 +196,20 @@ namespace omega {
         void refreshPointer(int pointerId, const Event& evt);
         //@}
 
+        //! Polls the sound server connection and updates the sound listener.
+        void updateSound(const UpdateContext& context);
+
+        //! Runs the fixed updates due this frame and interpolates transforms
+        //! of nodes moved by them.
+        void fixedUpdate(const UpdateContext& context);
+
+        //! Interpolated node registration, called by SceneNode.
+        //@{
+        friend class SceneNode;
+        void addInterpolatedNode(SceneNode* node);
+        void removeInterpolatedNode(SceneNode* node);
+        //@}
+
     private:
         static Engine* mysInstance;
 
@@ -177,6 +219,10 @@ namespace omega {
         // Engine lock, used when client / server thread synchronization is needed.
         Lock myLock;
 
+        // Nodes with transform interpolation enabled. Declared before myScene
+        // so it outlives the scene nodes unregistering from it.
+        List<SceneNode*> myInterpolatedNodes;
+
         Ref<SceneNode> myScene;
 
         // Pointers
@@ -210,23 +256,43 @@ namespace omega {
         // Cameras.
         Ref<Camera> myDefaultCamera;
         CameraCollection myCameras;
+        // Protects myCameras from being read by renderers while it changes.
+        mutable Lock myCamerasLock;
 
         // Sound
+        enum SoundServerState { SoundServerDisabled, SoundServerConnecting, SoundServerReady };
         Ref<SoundManager> soundManager;
         Ref<SoundEnvironment> soundEnv;
-        int lastSoundServerCheck;
-        int soundServerCheckDelay;
+        SoundServerState soundServerState;
+        // Time of the last sound server connection attempt and interval 
+        // between attempts, in seconds.
+        float lastSoundServerCheck;
+        float soundServerCheckDelay;
         bool soundEnabled;
         bool soundReady;
+        // Sound server host added to the asset cache manager. initializeSound
+        // runs again after each reconnection, and must not add it twice.
+        String soundCacheHost;
 
         // Input mapping
         Event::Flags myPrimaryButton;
 
+        // Fixed timestep simulation
+        float myFixedUpdateRate;
+        int myMaxFixedUpdatesPerFrame;
+        float myFixedTimeAccumulator;
+        float myFixedUpdateAlpha;
+        // Simulation time and number of fixed updates run so far.
+        float myFixedTime;
+        uint64 myFixedUpdateCount;
+
         // Stats
         Ref<Stat> myHandleEventTimeStat;
         Ref<Stat> myUpdateTimeStat;
         Ref<Stat> mySceneUpdateTimeStat;
         Ref<Stat> myModuleUpdateTimeStat;
+        Ref<Stat> myFixedUpdateTimeStat;
+        Ref<Stat> myFixedUpdateCountStat;
     };
 
     ///////////////////////////////////////////////////////////////////////////
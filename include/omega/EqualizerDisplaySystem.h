@@ -100,10 +100,30 @@ namespace omega
 
         void exitConfig();
 
+        //! @internal Slave nodes: tells the master launcher this node is 
+        //! ready. Called once the node listens for master connections.
+        void signalNodeReady();
+
+        //! Cluster frame timing (enabled by config/clusterTiming). Valid 
+        //! on the application node only.
+        //@{
+        //! Returns the node that took longest to produce the last completed
+        //! frame, or an empty string if frame timing is disabled.
+        String getSlowestNode();
+        //! Returns the tile with the longest draw time on the slowest node.
+        String getSlowestTile();
+        //! @internal Returns the number of nodes in the generated equalizer
+        //! configuration.
+        int getNumEqNodes() { return myNumEqNodes; }
+        //@}
+
     private:
         void generateEqConfig();
         void setupEqInitArgs(int& numArgs, const char** argv);
         String buildTileConfig(String& indent, const String tileName, int x, int y, int width, int height, int device, int curdevice, bool fullscreen, bool borderless);
+        //! Launches all the enabled cluster nodes. If the launcher handshake
+        //! is enabled, waits for each node to report it is ready.
+        void launchNodes();
 
     private:
         SystemManager* mySys;
@@ -117,6 +137,8 @@ namespace omega
 
         // Debug
         bool myDebugMouse;
+
+        int myNumEqNodes;
     };
 
 }; // namespace omega
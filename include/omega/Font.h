@@ -70,6 +70,8 @@ namespace omega {
 	private:
 		static Lock sLock;
 		FTFont* myFontImpl;
+		// Sizes of the strings measured with computeSize so far.
+		Dictionary<String, Vector2f> myTextSizeCache;
 	};
 }; // namespace omega
 
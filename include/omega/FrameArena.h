@@ -0,0 +1,127 @@
+/******************************************************************************
+ * THE OMEGA LIB PROJECT
+ *-----------------------------------------------------------------------------
+ * Copyright 2010-2013		Electronic Visualization Laboratory, 
+ *							University of Illinois at Chicago
+ * Authors:										
+ *  Alessandro Febretti		febret@gmail.com
+ *-----------------------------------------------------------------------------
+ * Copyright (c) 2010-2013, Electronic Visualization Laboratory,  
+ * University of Illinois at Chicago
+ * All rights reserved.
+ * Redistribution and use in source and binary forms, with or without modification, 
+ * are permitted provided that the following conditions are met:
+ * 
+ * Redistributions of source code must retain the above copyright notice, this 
+ * list of conditions and the following disclaimer. Redistributions in binary 
+ * form must reproduce the above copyright notice, this list of conditions and 
+ * the following disclaimer in the documentation and/or other materials provided 
+ * with the distribution. 
+ * 
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" 
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO THE 
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE 
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE 
+ * LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL 
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE  GOODS OR 
+ * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER 
+ * CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, 
+ * OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE 
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ *-----------------------------------------------------------------------------
+ * What's in this file
+ *	A per-thread linear allocator for objects that live for a single frame.
+ ******************************************************************************/
+#ifndef __FRAME_ARENA_H__
+#define __FRAME_ARENA_H__
+
+#include "omega/osystem.h"
+#include <new>
+#include <vector>
+
+namespace omega
+{
+    ///////////////////////////////////////////////////////////////////////////
+    //! Each thread owns an arena of memory blocks. Allocations bump a pointer
+    //! in the current block, and are all released at once when the thread
+    //! resets its arena at the start of its frame. Blocks are kept across 
+    //! resets, so once an arena has grown to the frame peak it stops touching
+    //! the heap.
+    //! Memory from the arena must not outlive the frame it was allocated in:
+    //! use it for temporary containers local to a frame loop call.
+    class OMEGA_API FrameArena
+    {
+    public:
+        //! Size of the blocks allocated by the arenas. Larger allocations get
+        //! a dedicated block.
+        static const int BlockSize = 64 * 1024;
+
+    public:
+        //! Allocates memory from the calling thread arena. Throws 
+        //! std::bad_alloc if the arena needs a new block and the heap is
+        //! exhausted.
+        static void* allocate(size_t size);
+        //! Releases all the memory allocated by the calling thread. Call at 
+        //! the start of the thread frame.
+        static void reset();
+        //! Samples the 'Frame arena allocations' and 'Frame arena heap blocks'
+        //! stats with the totals of all threads since the last call. Called 
+        //! once per frame by the engine.
+        static void updateStats();
+    };
+
+    ///////////////////////////////////////////////////////////////////////////
+    //! Standard library allocator using the calling thread frame arena. 
+    //! Deallocation is a no-op: memory is reclaimed when the arena resets.
+    template<typename T>
+    class FrameAllocator
+    {
+    public:
+        typedef T value_type;
+        typedef T* pointer;
+        typedef const T* const_pointer;
+        typedef T& reference;
+        typedef const T& const_reference;
+        typedef size_t size_type;
+        typedef ptrdiff_t difference_type;
+
+        template<typename U> struct rebind { typedef FrameAllocator<U> other; };
+
+    public:
+        FrameAllocator() {}
+        template<typename U> FrameAllocator(const FrameAllocator<U>&) {}
+
+        pointer address(reference r) const { return &r; }
+        const_pointer address(const_reference r) const { return &r; }
+
+        pointer allocate(size_type n, const void* = 0)
+        { return static_cast<pointer>(FrameArena::allocate(n * sizeof(T))); }
+        void deallocate(pointer, size_type) {}
+
+        size_type max_size() const { return size_type(-1) / sizeof(T); }
+
+        void construct(pointer p, const T& value) { new(p) T(value); }
+        void destroy(pointer p) { p->~T(); }
+    };
+
+    ///////////////////////////////////////////////////////////////////////////
+    template<typename T, typename U>
+    inline bool operator==(const FrameAllocator<T>&, const FrameAllocator<U>&)
+    { return true; }
+
+    ///////////////////////////////////////////////////////////////////////////
+    template<typename T, typename U>
+    inline bool operator!=(const FrameAllocator<T>&, const FrameAllocator<U>&)
+    { return false; }
+
+    ///////////////////////////////////////////////////////////////////////////
+    //! A vector allocated from the frame arena, i.e. 
+    //! FrameVector<RenderPass*>::Type passes;
+    template<typename T>
+    struct FrameVector
+    {
+        typedef std::vector<T, FrameAllocator<T> > Type;
+    };
+}; // namespace omega
+
+#endif
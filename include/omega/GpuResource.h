@@ -42,6 +42,9 @@
 
 namespace omega
 {
+	class TextureSource;
+	struct DrawContext;
+
 	///////////////////////////////////////////////////////////////////////////////////////////////
 	class OMEGA_API GpuContext: public ReferenceType
 	{
@@ -55,15 +58,51 @@ namespace omega
 			TextureUnit3 = GL_TEXTURE3 };
 
 		GpuContext();
+		~GpuContext();
 
 		uint getId() { return myId; }
 		//GpuManager* getGpu() { return myGpu; }
 
+		//! Memory accounting
+		//@{
+		//! Called by GPU resources when they allocate or release GPU storage.
+		void addResidentBytes(size_t bytes) { myResidentBytes += bytes; }
+		void removeResidentBytes(size_t bytes);
+		size_t getResidentBytes() { return myResidentBytes; }
+		//! Sets the GPU memory budget for this context in bytes. 
+		//! A value of 0 means no budget.
+		void setMemoryBudget(size_t bytes) { myMemoryBudget = bytes; }
+		size_t getMemoryBudget() { return myMemoryBudget; }
+		bool isOverBudget() 
+		{ return myMemoryBudget != 0 && myResidentBytes > myMemoryBudget; }
+		//! Returns true only for the first call in each frame. Renderers
+		//! sharing this context use it to sample per-context stats once.
+		bool beginStatsSample(uint64 frameNum);
+		//@}
+
+		//! Staged texture uploads
+		//@{
+		//! Queues a dirty texture source for upload on this context. Called
+		//! by TextureSource::setDirty.
+		void queueTextureUpload(TextureSource* source);
+		//! Uploads queued texture sources, stopping after maxBytes have been 
+		//! uploaded (0 = no limit). Called by the renderer at frame start.
+		//! Returns the number of refreshed texture sources.
+		int processTextureUploads(const DrawContext& context, size_t maxBytes);
+		//@}
+
 	private:
 		static uint mysNumContexts;
 		static Lock mysContextLock;
 
 		uint myId;
+		size_t myResidentBytes;
+		size_t myMemoryBudget;
+		uint64 myStatsSampleFrame;
+		Lock myStatsSampleLock;
+
+		Lock myUploadLock;
+		List< Ref<TextureSource> > myUploadQueue;
 		//GpuManager* myGpu;
 	};
 
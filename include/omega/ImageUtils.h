@@ -93,9 +93,29 @@ namespace omega {
 		static void setImageLoaderThreads(int num) { sNumLoaderThreads = num; }
 		//! Gets the number of image loading threads
 		static int getImageLoaderThreads() { return sNumLoaderThreads; }
+
+		//! Compressed texture cache
+		//@{
+		//! Enables the compressed texture cache. Loaded images are compressed
+		//! to a block-compressed gpu format by a background thread, and stored
+		//! in the cache directory using a hash of the image file contents as 
+		//! key. Following loads of the same image skip decoding and upload the
+		//! compressed data directly. The directory can be shared by all the 
+		//! nodes running on a host.
+		static void enableTextureCache(const String& cacheDir);
+		static void disableTextureCache() { sTextureCacheEnabled = false; }
+		static bool isTextureCacheEnabled() { return sTextureCacheEnabled; }
+		//! Compresses the passed pixel data and stores it in the texture cache,
+		//! using its texture cache key. Does nothing if the pixels have been
+		//! modified since loading. Called by the texture cache writer thread.
+		static void storeCachedTexture(PixelData* data);
+		//@}
 		
 	private:
 		static Ref<PixelData> ffbmpToPixelData(FIBITMAP*& image, const String& filename);
+		static Ref<PixelData> loadCachedTexture(const String& key, const String& sourcePath);
+		static void queueCachedTexture(PixelData* data);
+		static String getTextureCacheKey(const byte* data, size_t size);
 
 	private:
 		static Vector<void*> sPreallocBlocks;
@@ -104,6 +124,8 @@ namespace omega {
 		static List<Thread*> sImageLoaderThread;
 		static bool sVerbose;
 		static int sNumLoaderThreads;
+		static bool sTextureCacheEnabled;
+		static String sTextureCacheDir;
 
 	private:
 		ImageUtils() {}
@@ -40,6 +40,7 @@
 
 #include "omega/osystem.h"
 #include "omega/StatsManager.h"
+#include "omega/StatsStream.h"
 #include "omega/ModuleServices.h"
 #include "omega/PythonInterpreter.h"
 #include "omicron/Tcp.h"
@@ -92,6 +93,34 @@ namespace omega {
 		//! stup message with current data (name, min, max, average 
 		//! times / values) about statistics enabled by a sten message.
 		static const char* StatUpdate;
+		//! stsb <sample rate> <send rate> [pattern][|pattern]* - subscribes 
+		//! to a binary stream of stat values. Patterns can contain * 
+		//! wildcards. Rates are in Hz, zero meaning every frame. Stats 
+		//! matching the patterns are sampled at the sample rate, and sent in
+		//! batches at the send rate, as stbn messages. Subscriptions from 
+		//! multiple clients are merged. An empty pattern list stops the 
+		//! stream.
+		static const char* StatSubscribe;
+		//! stbn <binary data> - a batch of stat samples, encoded by 
+		//! StatsStreamEncoder. The server only forwards these messages to
+		//! clients that sent a stsb message.
+		static const char* StatStream;
+
+		//! nrdy <hostname:port> - sent by cluster nodes to the master node 
+		//! launcher when they are ready to accept display system connections
+		//! (see EqualizerDisplaySystem)
+		static const char* NodeReady;
+
+		//! caps <client|server> [capability]* - sent by clients to the server
+		//! when connecting, and by the server back to the client: lists the 
+		//! optional protocol features supported by the sender. The only 
+		//! capability currently defined is 'batch'. Peers that do not send 
+		//! this message are assumed to support none.
+		static const char* Capabilities;
+		//! mbat [<id> <size> <data>]* - a batch of messages, each with its 
+		//! own 4-character id and size. Only sent to peers that advertised the
+		//! 'batch' capability.
+		static const char* Batch;
 
 	private:
 		//! Can't be instantiated.
@@ -121,20 +150,77 @@ namespace omega {
 		virtual void handleConnected();
 		virtual void handleError(const ConnectionError& err);
 
-		void sendMessage(const char* header, void* data, int size);
+		//! Sends a message. With asynchronous sending enabled, the message is
+		//! queued and actually sent by the next call to flush(). Returns false
+		//! if the message was dropped because the send queue is full.
+		bool sendMessage(const char* header, void* data, int size);
 		//! Client side: tells the server we are done talking and waits for graceful close.
 		void goodbyeServer();
+		//! Tells the peer which optional protocol features we support.
+		void sendCapabilities();
 
 		String getName() { return myName; }
 		virtual void setName(const String& name);
 
+		//! Asynchronous sending
+		//@{
+		//! When enabled, messages are queued by sendMessage and written to the
+		//! socket in one go by flush(). Disabled by default.
+		void setAsyncSendEnabled(bool value) { myAsyncSendEnabled = value; }
+		bool isAsyncSendEnabled() { return myAsyncSendEnabled; }
+		//! Writes all queued messages. Can be called while other threads 
+		//! queue new messages.
+		void flush();
+		//! Sets the maximum size of the send queue, in bytes. When the queue
+		//! is full, new log and stat update messages are dropped. Other 
+		//! messages are always queued. Defaults to 4MB.
+		void setMaxQueueSize(int bytes) { myMaxQueueSize = bytes; }
+		int getMaxQueueSize() { return myMaxQueueSize; }
+		int getQueueSize() { return myQueueSize; }
+		//! Returns the number of messages dropped because the queue was full.
+		uint getDroppedMessages() { return myDroppedMessages; }
+		//! When enabled (default), queued messages are sent as a single batch
+		//! message, if the peer supports it.
+		void setBatchingEnabled(bool value) { myBatchingEnabled = value; }
+		bool isBatchingEnabled() { return myBatchingEnabled; }
+		bool isPeerBatchingSupported() { return myPeerBatchingSupported; }
+		//@}
+
+		//! Server side: true if the client on this connection subscribed to
+		//! stat streams.
+		void setStatStreamListener(bool value) { myStatStreamListener = value; }
+		bool isStatStreamListener() { return myStatStreamListener; }
+
+	private:
+		void dispatchMessage(const char* header, char* data, int size);
+		void handleCapabilities(char* data);
+		static void appendFrame(Vector<char>& buffer, const char* header, const void* data, int size);
+
 	private:
-		static const int BufferSize = 1024;
-		char myBuffer[BufferSize];
+		//! Messages bigger than this are considered a protocol error.
+		static const int MaxMessageSize = 64 * 1024 * 1024;
+		//! Space reserved at the beginning of the send queue for a batch 
+		//! message header.
+		static const int BatchHeaderSize = 8;
+
+		Vector<char> myBuffer;
 		MissionControlServer* myServer;
 		MissionControlConnection* myRecipient; // Message destination when private-message mode is enabled.
 		IMissionControlMessageHandler* myMessageHandler;
 		String myName;
+
+		// Send queue: a sequence of message frames, preceded by 
+		// BatchHeaderSize reserved bytes.
+		bool myAsyncSendEnabled;
+		Lock myQueueLock;
+		Vector<char> myQueue;
+		int myQueueSize;
+		int myQueuedMessages;
+		int myMaxQueueSize;
+		uint myDroppedMessages;
+		bool myBatchingEnabled;
+		bool myPeerBatchingSupported;
+		bool myStatStreamListener;
 	};
 
 	///////////////////////////////////////////////////////////////////////////
@@ -149,19 +235,36 @@ namespace omega {
 
 		virtual void initialize();
 		virtual void dispose();
+		//! Accepts connections, handles incoming messages, then sends queued
+		//! log lines and messages to all clients.
+		virtual void poll();
 
 		virtual TcpConnection* createConnection(const ConnectionInfo& ci);
 		void closeConnection(MissionControlConnection* conn);
 		MissionControlConnection* findConnection(const String& name);
 		void handleMessage(const char* header, void* data, int size, MissionControlConnection* sender = NULL);
 		void setMessageHandler(IMissionControlMessageHandler* msgHandler) { myMessageHandler = msgHandler; }
+		//! Sets an object that merges the stat streams of all connected 
+		//! clients. The server subscribes new clients to the stats needed by
+		//! the aggregator.
+		void setStatsAggregator(StatsAggregator* aggregator) { myStatsAggregator = aggregator; }
+		StatsAggregator* getStatsAggregator() { return myStatsAggregator; }
 	
-		// from ILogListener
+		// from ILogListener. Lines are queued and sent to clients during 
+		// the next poll, so slow clients never stall the logging thread.
 		virtual void addLine(const String& line);
 
 	private:
+		//! Maximum number of log lines waiting to be sent. Older lines are 
+		//! dropped first.
+		static const int MaxPendingLogLines = 4096;
+
 		List<MissionControlConnection*> myConnections;
 		IMissionControlMessageHandler* myMessageHandler;
+		Ref<StatsAggregator> myStatsAggregator;
+
+		Lock myLogLock;
+		List<String> myPendingLogLines;
 	};
 
 	///////////////////////////////////////////////////////////////////////////
@@ -221,6 +324,8 @@ namespace omega {
 		asio::io_service myIoService;
 		Ref<MissionControlConnection> myConnection;
 		List<Stat*> myEnabledStats;
+		StatsStreamEncoder myStatsStream;
+		Vector<char> myStatsMessage;
 	};
 
 	///////////////////////////////////////////////////////////////////////////
@@ -55,14 +55,14 @@ namespace omega {
 		EngineModule(const String& name): 
 		  myInitialized(false), myEngine(NULL), myName(name), 
 			  myPriority(PriorityNormal), mySharedDataEnabled(false),
-			  myEventTimeStat(NULL),  myUpdateTimeStat(NULL) 
+			  myEventTimeStat(NULL),  myUpdateTimeStat(NULL), myEventTime(0)
 		  {
 		  }
 
 		EngineModule(): 
 		  myInitialized(false), myEngine(NULL), myName(mysNameGenerator.generate()), 
 			  myPriority(PriorityNormal), mySharedDataEnabled(false),
-			  myEventTimeStat(NULL),  myUpdateTimeStat(NULL) 
+			  myEventTimeStat(NULL),  myUpdateTimeStat(NULL), myEventTime(0)
 	      {
 		  }
 
@@ -73,6 +73,11 @@ namespace omega {
 		virtual void initialize() {}
 		virtual void dispose() {}
 		virtual void update(const UpdateContext& context) {}
+		//! Called at the fixed simulation rate set by the engine (see 
+		//! Engine::setFixedUpdateRate). Can be called zero or more times per
+		//! frame. context.dt is always the fixed timestep. Put simulation 
+		//! code (i.e. physics stepping) here instead of update.
+		virtual void fixedUpdate(const UpdateContext& context) {}
 		virtual void handleEvent(const Event& evt) {}
 		virtual bool handleCommand(const String& cmd) { return false; }
 		virtual void commitSharedData(SharedOStream& out) {}
@@ -102,9 +107,12 @@ namespace omega {
 
 		static NameGenerator mysNameGenerator;
 
-		// Statistics
+		// Statistics. Created when the module initializes. The event time
+		// stat gets one sample per frame, with the total time spent handling
+		// the events received during that frame (accumulated in myEventTime).
 		Ref<Stat> myEventTimeStat;
 		Ref<Stat> myUpdateTimeStat;
+		double myEventTime;
 	};
 
 	///////////////////////////////////////////////////////////////////////////
@@ -114,6 +122,8 @@ namespace omega {
 		static void addModule(EngineModule* module);
 		static void removeModule(EngineModule* module);
 		static void update(Engine* srv, const UpdateContext& context);
+		//! Runs a fixed update step on all initialized modules.
+		static void fixedUpdate(const UpdateContext& context);
 		//! Dispatches an event to all modules with the specified priority.
 		static void handleEvent(const Event& evt, EngineModule::Priority p);
 		static bool handleCommand(const String& cmd);
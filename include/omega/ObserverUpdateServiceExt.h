@@ -76,6 +76,8 @@ namespace omega
 		float myCurrentMovementThreshold;
 		float myMovementThresholdTarget;
 		float myMovementThresholdCoeff;
+
+		Ref<PosePredictor> myPosePredictor;
 	};
 
 	///////////////////////////////////////////////////////////////////////////////////////////////
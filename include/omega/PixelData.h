@@ -44,7 +44,9 @@ namespace omega {
 	{
 	public:
 		enum Format { FormatRgb, FormatRgba, FormatMonochrome};
-		enum UsageFlags { /*RenderTexture = 1 << 0 ,*/ PixelBufferObject = 1 << 1 };
+		//! CompressedStorage: the pixel data only stores block-compressed data
+		//! (see setCompressedData) and does not allocate uncompressed storage.
+		enum UsageFlags { /*RenderTexture = 1 << 0 ,*/ PixelBufferObject = 1 << 1, CompressedStorage = 1 << 2 };
 	
 	public:
 		//! Static creation function to keep consistent with Python API
@@ -53,7 +55,10 @@ namespace omega {
 		PixelData(Format fmt, int width, int height, byte* data = NULL, uint usageFlags = 0);
 		virtual ~PixelData();
 
-		byte* map();
+		//! Maps the pixel data for access. Mapping for write access drops the
+		//! compressed copy of the image and its texture cache key. Read-only
+		//! access keeps them.
+		byte* map(bool readOnly = false);
 		void unmap();
 
 		byte* bind(const GpuContext* context);
@@ -92,11 +97,34 @@ namespace omega {
 		void endPixelAccess();
 		//@}
 
+		//! Compressed textures
+		//@{
+		//! Sets block-compressed data (in the specified GL format) for this 
+		//! image. The pixel data takes ownership of the passed buffer. When
+		//! present, compressed data is uploaded directly to textures.
+		void setCompressedData(uint glFormat, byte* data, size_t size);
+		bool isCompressed() { return myCompressedData != NULL; }
+		uint getCompressedFormat() { return myCompressedFormat; }
+		byte* getCompressedData() { return myCompressedData; }
+		size_t getCompressedSize() { return myCompressedSize; }
+		//! Key of this image in the ImageUtils texture cache. The key is 
+		//! cleared when the pixels are modified, so the cache is not filled
+		//! with a modified image.
+		void setTextureCacheKey(const String& key) { myTextureCacheKey = key; }
+		const String& getTextureCacheKey() { return myTextureCacheKey; }
+		//! Sets the image file this pixel data was loaded from. Pixel data 
+		//! loaded from the texture cache only stores compressed data: the
+		//! source file is decoded on the first access to uncompressed pixels.
+		void setSourceFile(const String& path) { mySourceFile = path; }
+		//@}
+
 	protected:
 		void refreshTexture(Texture* texture, const DrawContext& context);
 
 	private:
 		void updateSize();
+		void clearCompressedData();
+		void decodeSourceFile();
 
 	private:
 		uint myUsageFlags;
@@ -112,6 +140,13 @@ namespace omega {
 
 		// PBO stuff
 		GLuint myPBOId;
+
+		// Compressed texture stuff
+		uint myCompressedFormat;
+		byte* myCompressedData;
+		size_t myCompressedSize;
+		String myTextureCacheKey;
+		String mySourceFile;
 	};
 }; // namespace omega
 
@@ -0,0 +1,128 @@
+/******************************************************************************
+ * THE OMEGA LIB PROJECT
+ *-----------------------------------------------------------------------------
+ * Copyright 2010-2013		Electronic Visualization Laboratory, 
+ *							University of Illinois at Chicago
+ * Authors:										
+ *  Alessandro Febretti		febret@gmail.com
+ *-----------------------------------------------------------------------------
+ * Copyright (c) 2010-2013, Electronic Visualization Laboratory,  
+ * University of Illinois at Chicago
+ * All rights reserved.
+ * Redistribution and use in source and binary forms, with or without modification, 
+ * are permitted provided that the following conditions are met:
+ * 
+ * Redistributions of source code must retain the above copyright notice, this 
+ * list of conditions and the following disclaimer. Redistributions in binary 
+ * form must reproduce the above copyright notice, this list of conditions and 
+ * the following disclaimer in the documentation and/or other materials provided 
+ * with the distribution. 
+ * 
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" 
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO THE 
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE 
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE 
+ * LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL 
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE  GOODS OR 
+ * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER 
+ * CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, 
+ * OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE 
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ *-----------------------------------------------------------------------------
+ * What's in this file
+ *	A filter that smooths tracker poses and extrapolates them to the expected
+ *	display time, to reduce perceived motion-to-photon latency.
+ ******************************************************************************/
+#ifndef __POSE_PREDICTOR_H__
+#define __POSE_PREDICTOR_H__
+
+#include "osystem.h"
+#include "omega/ApplicationBase.h"
+
+namespace omega {
+	///////////////////////////////////////////////////////////////////////////
+	//! Filters tracker poses and predicts them at the time they will be 
+	//! displayed. Poses are smoothed using a one-euro filter (an adaptive 
+	//! low-pass filter that smooths jitter at low speeds and reduces lag at 
+	//! high speeds), and extrapolated using the filtered linear and angular 
+	//! velocities. Velocities are computed using the tracker event timestamps.
+	//! The prediction horizon is the expected latency between the frame update
+	//! and the frame display. It can be set explicitly, or measured from the
+	//! frame time and the display system latency.
+	//! Configuration (all values optional):
+	//! @code
+	//! posePrediction: {
+	//!     minCutoff = 1.0;        // Hz. Lower values = more smoothing at rest.
+	//!     beta = 0.5;             // Speed coefficient. Higher = less lag.
+	//!     derivativeCutoff = 1.0; // Hz. Velocity smoothing.
+	//!     predictionTime = -1.0;  // seconds. < 0 = use measured latency.
+	//!     maxPredictionTime = 0.1;// seconds. Limits extrapolation.
+	//! };
+	//! @endcode
+	class OMEGA_API PosePredictor: public ReferenceType
+	{
+	public:
+		PosePredictor();
+
+		void setup(const Setting& s);
+		void reset();
+
+		//! Adds a tracker sample. Time is the sample timestamp in seconds.
+		void addSample(double time, const Vector3f& position, const Quaternion& orientation);
+		//! Computes the pose predicted for the frame being updated.
+		//! Returns false if no samples have been received yet.
+		bool predict(const UpdateContext& context, Vector3f* position, Quaternion* orientation);
+		//! Computes the pose predicted for a frame after its update, using
+		//! samples added since then (see Camera late latching). Unlike
+		//! predict, does not update the frame time estimate or the sample
+		//! age, so later updates are not affected.
+		//! Returns false if no samples have been received yet.
+		bool predictLate(const UpdateContext& context, Vector3f* position, Quaternion* orientation);
+		//! Computes the pose predicted a specified time (in seconds) after the
+		//! last sample.
+		void predict(float horizon, Vector3f* position, Quaternion* orientation);
+
+		//! Filter options
+		//@{
+		void setMinCutoff(float value) { myMinCutoff = value; }
+		float getMinCutoff() { return myMinCutoff; }
+		void setBeta(float value) { myBeta = value; }
+		float getBeta() { return myBeta; }
+		void setDerivativeCutoff(float value) { myDerivativeCutoff = value; }
+		float getDerivativeCutoff() { return myDerivativeCutoff; }
+		//! Sets the prediction time in seconds. Pass a negative value to use
+		//! the measured frame latency.
+		void setPredictionTime(float value) { myPredictionTime = value; }
+		float getPredictionTime() { return myPredictionTime; }
+		void setMaxPredictionTime(float value) { myMaxPredictionTime = value; }
+		float getMaxPredictionTime() { return myMaxPredictionTime; }
+		//@}
+
+	private:
+		//! Returns the time between the frame update and the display of 
+		//! the frame, not including the age of the last sample.
+		float getLatency();
+
+	private:
+		float myMinCutoff;
+		float myBeta;
+		float myDerivativeCutoff;
+		float myPredictionTime;
+		float myMaxPredictionTime;
+
+		// Filter state
+		bool myHasSamples;
+		bool myNewSample;
+		double myLastSampleTime;
+		Vector3f myPosition;
+		Vector3f myVelocity;
+		Quaternion myOrientation;
+		Vector3f myAngularVelocity;
+
+		// Latency estimation
+		float myFrameTime;
+		float myLastSampleUpdateTime;
+	};
+}; // namespace omega
+
+#endif
@@ -138,6 +138,17 @@ namespace omega
 			bool needsSend;
 		};
 
+		//! A registered script callback and the stat tracking its cost.
+		struct ScriptCallback
+		{
+			void* callback;
+			Ref<Stat> timeStat;
+			//! Time spent in the callback since the last update. Event
+			//! callbacks run several times per frame, and get one sample 
+			//! per frame.
+			double frameTime;
+		};
+
 	protected:
 		bool myEnabled;
 		bool myShellEnabled;
@@ -150,9 +161,9 @@ namespace omega
 		Lock myInteractiveCommandLock;
 		List<QueuedCommand*> myCommandQueue;
 
-		List<void*> myUpdateCallbacks;
-		List<void*> myEventCallbacks;
-		List<void*> myDrawCallbacks;
+		List<ScriptCallback> myUpdateCallbacks;
+		List<ScriptCallback> myEventCallbacks;
+		List<ScriptCallback> myDrawCallbacks;
 
 		//char* myExecutablePath;
 
@@ -162,6 +173,7 @@ namespace omega
 		
 		// Stats
 		Ref<Stat> myUpdateTimeStat;
+		Timer myCallbackTimer;
 
 
 	private:
@@ -82,6 +82,8 @@ namespace omega
 		GLuint myId;
 		Type myType;
 		bool myBound;
+		// Frame buffer bound before this target, restored by unbind.
+		GLuint myPreviousId;
 
 		// Render buffer stuff
 		GLuint myRbColorId;
@@ -42,6 +42,7 @@
 #include "omega/ApplicationBase.h"
 #include "omega/SystemManager.h"
 #include "omega/RenderTarget.h"
+#include "omega/TileQualityPolicy.h"
 
 namespace omega {
 	class RenderPass;
@@ -60,6 +61,10 @@ namespace omega {
 
 		Engine* getEngine();
 
+		//! Returns an id unique to this renderer. Renderers for windows on the
+		//! same pipe share their gpu context.
+		uint getId() { return myId; }
+
 		void addRenderPass(RenderPass* pass);
 		void removeRenderPass(RenderPass* pass);
 		RenderPass* getRenderPass(const String& name);
@@ -84,12 +89,62 @@ namespace omega {
 		//@{
 		Texture* createTexture();
 		RenderTarget* createRenderTarget(RenderTarget::Type type);
+		//! Queues a resource for disposal at the end of the current frame.
+		void releaseResource(GpuResource* res);
+		//@}
+
+		//! Dynamic resolution
+		//! When dynamic resolution is enabled, scene draw tasks are rendered
+		//! to an offscreen target at a fraction of the tile resolution, and 
+		//! upscaled into the tile viewport. The resolution scale is adjusted 
+		//! at each frame to keep the context frame time close to a target.
+		//! Overlays are always drawn at native resolution.
+		//@{
+		void setDynamicResolutionEnabled(bool value);
+		bool isDynamicResolutionEnabled();
+		//! Sets the target frame time, in milliseconds.
+		void setTargetFrameTime(float value);
+		float getTargetFrameTime();
+		void setMinResolutionScale(float value);
+		float getMinResolutionScale();
+		float getResolutionScale();
+		//! Returns the resolution scale for the scene of the passed context,
+		//! combining the dynamic resolution scale and the tile quality.
+		float getSceneResolutionScale(const DrawContext& context);
+		//! Binds the offscreen target used to draw the scene at reduced 
+		//! resolution for the context tile.
+		void beginScaledSceneDraw(DrawContext& context, float scale);
+		//! Unbinds the offscreen scene target and upscales it into the tile
+		//! viewport.
+		void endScaledSceneDraw(DrawContext& context);
+		//! Upscales the last scene drawn for the context tile into the tile
+		//! viewport, without redrawing it.
+		void drawScaledScene(DrawContext& context);
+		//@}
+
+		//! Tile quality
+		//@{
+		//! Returns the policy used to lower the quality of tiles outside the
+		//! user field of view, or NULL if no policy is configured.
+		TileQualityPolicy* getTileQualityPolicy();
+		//! Adds the number of pixels saved by drawing a tile at reduced 
+		//! quality during the current frame.
+		void addSavedPixels(uint64 pixels);
 		//@}
 
 	private:
 		void innerDraw(const DrawContext& context, Camera* camera);
+		void collectUnusedResources(bool all);
+		void evictTextures(const FrameInfo& frame);
+		void updateResolutionScale(float frameTime);
+		void beginGpuTiming();
+		bool endGpuTiming(float* frameTime);
 
 	private:
+		static uint mysNumRenderers;
+		static Lock mysRendererLock;
+
+		uint myId;
 		Lock myRenderCommandLock;
 		Lock myRenderPassLock;
 
@@ -103,9 +158,55 @@ namespace omega {
 		Queue< Ref<IRendererCommand> > myRenderableCommands;
 
 		List< Ref<GpuResource> > myResources;
+		// Resources waiting to be disposed at the end of the current frame.
+		List< Ref<GpuResource> > myReleaseQueue;
+		// Unused resources are collected incrementally: each frame we check
+		// a few resources, starting from where the previous frame stopped.
+		List< Ref<GpuResource> >::iterator myCollectIterator;
+		size_t myTextureUploadBudget;
+		// Context passed to staged texture uploads. Its tile is the first 
+		// tile drawn by this renderer.
+		DrawContext myUploadContext;
+
+		// Dynamic resolution
+		struct ScaledSceneTarget
+		{
+			Ref<RenderTarget> target;
+			Ref<Texture> color;
+			Ref<Texture> depth;
+			// Resolution scale used for the last scene drawn to the target.
+			float scale;
+		};
+		Dictionary<const DisplayTileConfig*, ScaledSceneTarget> myScaledSceneTargets;
+		bool myDynamicResolutionEnabled;
+		float myTargetFrameTime;
+		float myMinResolutionScale;
+		float myResolutionScale;
+		// Frame time tolerance around the target. The resolution scale does 
+		// not change while the frame time stays within this band.
+		float myFrameTimeTolerance;
+		// Gpu frame timer used by dynamic resolution. Queries belong to the 
+		// renderer gl context, and are read back a few frames after being 
+		// issued to avoid stalling the pipeline.
+		static const int GpuTimerQueries = 4;
+		GLuint myGpuTimerQueries[GpuTimerQueries];
+		int myGpuTimerIndex;
+		int myGpuTimerPending;
+		bool myGpuTimerInitialized;
+		bool myGpuTimerSupported;
+		bool myGpuTimerActive;
+
+		// Tile quality
+		Ref<TileQualityPolicy> myTileQualityPolicy;
+		uint64 mySavedPixels;
+		uint64 mySavedPixelsFrame;
 
 		// Stats
 		Ref<Stat> myFrameTimeStat;
+		Ref<Stat> myGpuMemoryStat;
+		Ref<Stat> myResolutionScaleStat;
+		Ref<Stat> myGpuFrameTimeStat;
+		Ref<Stat> mySavedPixelsStat;
 	};
 
 	///////////////////////////////////////////////////////////////////////////
@@ -119,6 +220,42 @@ namespace omega {
 	///////////////////////////////////////////////////////////////////////////
 	inline DisplaySystem*  Renderer::getDisplaySystem() 
 	{ return SystemManager::instance()->getDisplaySystem(); }
+
+	///////////////////////////////////////////////////////////////////////////
+	inline void Renderer::setDynamicResolutionEnabled(bool value)
+	{ myDynamicResolutionEnabled = value; }
+
+	///////////////////////////////////////////////////////////////////////////
+	inline bool Renderer::isDynamicResolutionEnabled()
+	{ return myDynamicResolutionEnabled; }
+
+	///////////////////////////////////////////////////////////////////////////
+	inline void Renderer::setTargetFrameTime(float value)
+	{ myTargetFrameTime = value; }
+
+	///////////////////////////////////////////////////////////////////////////
+	inline float Renderer::getTargetFrameTime()
+	{ return myTargetFrameTime; }
+
+	///////////////////////////////////////////////////////////////////////////
+	inline void Renderer::setMinResolutionScale(float value)
+	{ myMinResolutionScale = value; }
+
+	///////////////////////////////////////////////////////////////////////////
+	inline float Renderer::getMinResolutionScale()
+	{ return myMinResolutionScale; }
+
+	///////////////////////////////////////////////////////////////////////////
+	inline float Renderer::getResolutionScale()
+	{ return myResolutionScale; }
+
+	///////////////////////////////////////////////////////////////////////////
+	inline TileQualityPolicy* Renderer::getTileQualityPolicy()
+	{ return myTileQualityPolicy; }
+
+	///////////////////////////////////////////////////////////////////////////
+	inline void Renderer::addSavedPixels(uint64 pixels)
+	{ mySavedPixels += pixels; }
 }; // namespace omega
 
 #endif
@@ -0,0 +1,91 @@
+/**************************************************************************************************
+ * THE OMEGA LIB PROJECT
+ *-------------------------------------------------------------------------------------------------
+ * Copyright 2010-2013		Electronic Visualization Laboratory, University of Illinois at Chicago
+ * Authors:										
+ *  Alessandro Febretti		febret@gmail.com
+ *-------------------------------------------------------------------------------------------------
+ * Copyright (c) 2010-2013, Electronic Visualization Laboratory, University of Illinois at Chicago
+ * All rights reserved.
+ * Redistribution and use in source and binary forms, with or without modification, are permitted 
+ * provided that the following conditions are met:
+ * 
+ * Redistributions of source code must retain the above copyright notice, this list of conditions 
+ * and the following disclaimer. Redistributions in binary form must reproduce the above copyright 
+ * notice, this list of conditions and the following disclaimer in the documentation and/or other 
+ * materials provided with the distribution. 
+ * 
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND ANY EXPRESS OR 
+ * IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO THE IMPLIED WARRANTIES OF MERCHANTABILITY AND 
+ * FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR 
+ * CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL 
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE  GOODS OR SERVICES; LOSS OF 
+ * USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, 
+ * WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN 
+ * ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+#ifndef __RESOURCE_CACHE_H__
+#define __RESOURCE_CACHE_H__
+
+#include "osystem.h"
+#include "omega/PixelData.h"
+#include "omega/ImageUtils.h"
+
+namespace omega {
+	///////////////////////////////////////////////////////////////////////////////////////////////
+	//! ResourceCache keeps cpu-side resources (font files, shader sources, images) that are shared
+	//! by all the renderers in a process. Without it, each renderer reads the same files from disk
+	//! during its initialization. Resources listed in the preload section of the system 
+	//! configuration are loaded in parallel at startup, while the display system is still being 
+	//! initialized:
+	//! @code
+	//! config: {
+	//!     preload: {
+	//!         threads = 4;
+	//!         files = ["ui/widget-base.vert", "ui/widget-base.frag"];
+	//!         images = ["images/logo.png"];
+	//!     };
+	//! };
+	//! @endcode
+	class OMEGA_API ResourceCache
+	{
+	public:
+		//! Starts loading the resources listed in the passed setting on background threads.
+		static void preload(const Setting& s);
+		//! Adds a single file to the preload queue.
+		static void preloadFile(const String& filename);
+		//! Queues an image for asynchronous loading. The image can then be retrieved through
+		//! ImageUtils::loadImage.
+		static void preloadImage(const String& filename);
+
+		//! Returns the contents of a text file. Files are read once and kept in the cache, and
+		//! read again if they changed on disk (i.e. an edited shader). If the file is still being
+		//! preloaded, waits for it to be loaded. Returns an empty string if the file does not 
+		//! exist.
+		static String getTextFile(const String& filename);
+		//! Returns the contents of a binary file. The returned buffer stays valid for the lifetime
+		//! of the process, even if the file is reloaded after a change. Returns false if the file
+		//! does not exist.
+		static bool getFileData(const String& filename, const byte** data, size_t* size);
+		//! Returns a preloaded image and removes it from the cache, or NULL if the image has not 
+		//! been preloaded.
+		static Ref<PixelData> takeImage(const String& filename);
+
+		//! Sets the number of threads used to preload files.
+		static void setPreloadThreads(int num) { sNumPreloadThreads = num; }
+		static int getPreloadThreads() { return sNumPreloadThreads; }
+
+		static void internalDispose();
+
+	private:
+		static const String* findOrLoadFile(const String& filename);
+		static void startPreloadThreads();
+
+	private:
+		static int sNumPreloadThreads;
+
+	private:
+		ResourceCache() {}
+	};
+}; // namespace omega
+
+#endif
@@ -96,7 +96,11 @@ namespace omega {
             myTracker(NULL),
             myNeedsBoundingBoxUpdate(false),
             myFacingCameraFixedY(false),
-            myFlags(0)
+            myFlags(0),
+            myTransformInterpolationEnabled(false),
+            myHasFixedTransform(false),
+            myReplicationId(0),
+            myReplicationFlags(0)
             {}
 
         SceneNode(Engine* server, const String& name):
@@ -112,11 +116,27 @@ namespace omega {
             myTracker(NULL),
             myNeedsBoundingBoxUpdate(false),
             myFacingCameraFixedY(false),
-            myFlags(0)
-            {}
+            myFlags(0),
+            myTransformInterpolationEnabled(false),
+            myHasFixedTransform(false),
+            myReplicationFlags(0)
+            { registerNode(); }
+
+        virtual ~SceneNode();
 
         Engine* getEngine();
 
+        //! Scene replication (see SceneReplicationModule)
+        //@{
+        //! Sets the id matching this node across cluster nodes. Only nodes
+        //! with a non-zero id are replicated. Ids must be unique, and each 
+        //! cluster node must give the same id to the same scene node.
+        void setReplicationId(uint id);
+        uint getReplicationId() { return myReplicationId; }
+        //! Returns the scene node with the specified replication id, or NULL.
+        static SceneNode* getByReplicationId(uint id);
+        //@}
+
         // Object
         //@{
         void addComponent(NodeComponent* o);
@@ -206,6 +226,18 @@ namespace omega {
         bool isFlagSet(uint bit);
         //@}
 
+        //! Transform interpolation
+        //@{
+        //! When enabled, the transform of this node is blended at each frame
+        //! between the transforms set by the last two fixed updates (see 
+        //! EngineModule::fixedUpdate and Engine::getFixedUpdateAlpha). Only 
+        //! enable on nodes moved exclusively by fixed update code: changes to
+        //! the node transform made outside fixed updates are overwritten.
+        void setTransformInterpolationEnabled(bool value);
+        bool isTransformInterpolationEnabled() 
+        { return myTransformInterpolationEnabled; }
+        //@}
+
     protected:
         virtual void updateTraversal(const UpdateContext& context);
         /// Only available internally - notification of parent.
@@ -218,6 +250,14 @@ namespace omega {
         void updateBoundingBox(bool force = false);
         bool needsBoundingBoxUpdate();
 
+        //! Fixed update support, called by Engine.
+        //@{
+        friend class Engine;
+        void beginFixedUpdate();
+        void endFixedUpdate();
+        void interpolateTransform(float alpha);
+        //@}
+
     private:
         Engine* myServer;
 
@@ -248,6 +288,21 @@ namespace omega {
         bool myFacingCameraFixedY;
         // Tracked object. This is internally managed and does not need Ref. 
         TrackedObject* myTracker;
+
+        // Transform interpolation: node transforms after the previous and 
+        // last fixed updates.
+        bool myTransformInterpolationEnabled;
+        bool myHasFixedTransform;
+        Vector3f myPrevFixedPosition;
+        Vector3f myFixedPosition;
+        Quaternion myPrevFixedOrientation;
+        Quaternion myFixedOrientation;
+
+        // Scene replication state (see SceneReplicationModule)
+        friend class SceneReplicationModule;
+        uint myReplicationId;
+        uint myReplicationFlags;
+        static Dictionary<uint, SceneNode*> mysNodesByReplicationId;
     };
 
     ///////////////////////////////////////////////////////////////////////////
@@ -0,0 +1,132 @@
+/******************************************************************************
+ * THE OMEGA LIB PROJECT
+ *-----------------------------------------------------------------------------
+ * Copyright 2010-2013		Electronic Visualization Laboratory, 
+ *							University of Illinois at Chicago
+ * Authors:										
+ *  Alessandro Febretti		febret@gmail.com
+ *-----------------------------------------------------------------------------
+ * Copyright (c) 2010-2013, Electronic Visualization Laboratory,  
+ * University of Illinois at Chicago
+ * All rights reserved.
+ * Redistribution and use in source and binary forms, with or without modification, 
+ * are permitted provided that the following conditions are met:
+ * 
+ * Redistributions of source code must retain the above copyright notice, this 
+ * list of conditions and the following disclaimer. Redistributions in binary 
+ * form must reproduce the above copyright notice, this list of conditions and 
+ * the following disclaimer in the documentation and/or other materials provided 
+ * with the distribution. 
+ * 
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" 
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO THE 
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE 
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE 
+ * LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL 
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE  GOODS OR 
+ * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER 
+ * CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, 
+ * OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE 
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ *-----------------------------------------------------------------------------
+ * What's in this file
+ *	A module replicating scene node transforms from the master to slave nodes.
+ ******************************************************************************/
+#ifndef __SCENE_REPLICATION_MODULE_H__
+#define __SCENE_REPLICATION_MODULE_H__
+
+#include "omega/osystem.h"
+#include "omega/ModuleServices.h"
+
+namespace omega
+{
+	class SceneNode;
+
+	///////////////////////////////////////////////////////////////////////////
+	//! Sends scene node changes made on the master to slave nodes.
+	//! @remarks
+	//!		When enabled, the master collects the scene nodes whose local 
+	//!		transform or visibility changed, and sends the changed values to
+	//!		slaves. This lets applications move nodes from master-only code.
+	//!		Only nodes with a replication id are replicated (see 
+	//!		SceneNode::setReplicationId). Node creation, deletion and 
+	//!		reparenting are not replicated.
+	//!		Changes made during a frame are displayed from the next frame on
+	//!		all nodes: while the master renders, replicated nodes show the 
+	//!		values it last sent, and get their application values back before
+	//!		the next frame events are processed.
+	class OMEGA_API SceneReplicationModule: public EngineModule
+	{
+	public:
+		enum DirtyFlags 
+		{ 
+			TransformDirty = 1 << 0, 
+			VisibilityDirty = 1 << 1,
+			//! The node shows its committed values, and its application 
+			//! values are stored in its node state.
+			LiveStateStored = 1 << 2
+		};
+
+		enum ChangeFlags
+		{
+			PositionChanged = 1 << 0,
+			OrientationChanged = 1 << 1,
+			ScaleChanged = 1 << 2,
+			VisibilityChanged = 1 << 3
+		};
+
+	public:
+		//! Enables scene replication. Needs to be called on all nodes.
+		static SceneReplicationModule* enable();
+		static SceneReplicationModule* instance() { return mysInstance; }
+		//! Returns true if scene changes are being collected on this node.
+		static bool isCollecting() { return mysCollecting; }
+		//! @internal Called by SceneNode when it changes.
+		static void markDirty(SceneNode* node, uint flags);
+		//! @internal Called by SceneNode when it stops being replicated.
+		static void removeNode(SceneNode* node);
+		//! @internal Called by Engine before the scene update: makes changed
+		//! nodes show the values committed this frame.
+		static void applyCommittedState();
+		//! @internal Called on the master before processing frame events: 
+		//! gives changed nodes back their application values.
+		static void restoreLiveState();
+
+		SceneReplicationModule();
+
+		virtual void initialize();
+		virtual void dispose();
+		virtual void commitSharedData(SharedOStream& out);
+		virtual void updateSharedData(SharedIStream& in);
+
+	private:
+		struct NodeState
+		{
+			NodeState(): committed(false) {}
+
+			// Values sent at the last commit
+			bool committed;
+			Vector3f position;
+			Quaternion orientation;
+			Vector3f scale;
+			bool visible;
+
+			// Values set by the application, while the committed ones are
+			// displayed.
+			Vector3f livePosition;
+			Quaternion liveOrientation;
+			Vector3f liveScale;
+			bool liveVisible;
+		};
+
+		static Ref<SceneReplicationModule> mysInstance;
+		static bool mysCollecting;
+
+		List<SceneNode*> myDirtyNodes;
+		Dictionary<SceneNode*, NodeState> myNodeStates;
+
+		Ref<Stat> myReplicatedNodesStat;
+	};
+}; // namespace omega
+
+#endif
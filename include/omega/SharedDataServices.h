@@ -44,7 +44,7 @@ namespace omega
     class OMEGA_API SharedOStream
     {
     public:
-		SharedOStream(co::DataOStream* stream): myStream(stream) {}
+		SharedOStream(co::DataOStream* stream): myStream(stream), myHashEnabled(false), myHash(0) {}
 
         template< typename T > SharedOStream& operator << ( const T& value )
         { write( &value, sizeof( value )); return *this; }
@@ -54,9 +54,16 @@ namespace omega
 		void write( const void* data, uint64_t size );
 
 		co::DataOStream* getInternalStream() { return myStream; }
+
+		//! When hashing is enabled, the stream keeps a hash of the data 
+		//! written to it. Used to detect shared data changes.
+		void setHashEnabled(bool value);
+		uint64_t getHash() { return myHash; }
 	
 	private:
 		co::DataOStream* myStream;
+		bool myHashEnabled;
+		uint64_t myHash;
 	};
 
 	///////////////////////////////////////////////////////////////////////////////////////////////
@@ -96,6 +103,12 @@ namespace omega
 		static void unregisterObject(const String& id);
 		static void cleanup();
 
+		//! Serializes an object to a memory buffer and reads it back into the
+		//! same object, the way a slave node would apply it. Returns the size
+		//! of the serialized data. Used to profile shared data serialization
+		//! without a cluster (see obench).
+		static size_t loopbackObject(SharedObject* obj);
+
 	private:
 		static SharedData* mysSharedData;
 		static Dictionary<String, SharedObject*> mysRegistrationQueue;
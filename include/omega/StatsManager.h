@@ -52,12 +52,20 @@ namespace omega
         StatsManager();
 
         Stat* createStat(const String& name, StatType type);
+        //! Creates a stat, appending a counter to the name if a stat with 
+        //! the same name exists. Used for automatically named stats, like
+        //! the per-module and per-script callback timings.
+        Stat* createUniqueStat(const String& name, StatType type);
         Stat* findStat(const String& name);
         void removeStat(Stat* s);
         List<Stat*>::Range getStats();
         void printStats();
+        //! Returns a counter incremented each time a stat is created or 
+        //! removed. Lets users caching stat pointers know when to refresh them.
+        uint getVersion() { return myVersion; }
 
     private:
+        uint myVersion;
         Dictionary<String, Stat*> myStatDictionary;
         // List of stats. Stats are normal pointers, since we want to leave
         // stat ownership to user code. When a stat reference count goes to
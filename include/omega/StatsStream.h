@@ -0,0 +1,238 @@
+/******************************************************************************
+ * THE OMEGA LIB PROJECT
+ *-----------------------------------------------------------------------------
+ * Copyright 2010-2013		Electronic Visualization Laboratory, 
+ *							University of Illinois at Chicago
+ * Authors:										
+ *  Alessandro Febretti		febret@gmail.com
+ *-----------------------------------------------------------------------------
+ * Copyright (c) 2010-2013, Electronic Visualization Laboratory,  
+ * University of Illinois at Chicago
+ * All rights reserved.
+ * Redistribution and use in source and binary forms, with or without modification, 
+ * are permitted provided that the following conditions are met:
+ * 
+ * Redistributions of source code must retain the above copyright notice, this 
+ * list of conditions and the following disclaimer. Redistributions in binary 
+ * form must reproduce the above copyright notice, this list of conditions and 
+ * the following disclaimer in the documentation and/or other materials provided 
+ * with the distribution. 
+ * 
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" 
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO THE 
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE 
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE 
+ * LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL 
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE  GOODS OR 
+ * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER 
+ * CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, 
+ * OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE 
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ *-----------------------------------------------------------------------------
+ * What's in this file
+ *	Classes used to stream statistics from omegalib instances to mission 
+ *  control clients in a compact binary format, and to merge the streams of 
+ *  the nodes of a cluster.
+ ******************************************************************************/
+#ifndef __STATS_STREAM_H__
+#define __STATS_STREAM_H__
+
+#include "omega/osystem.h"
+#include "omega/StatsManager.h"
+
+namespace omega
+{
+    ///////////////////////////////////////////////////////////////////////////
+    //! Samples a set of stats and encodes them as stat stream messages
+    //! (see MissionControlMessageIds::StatStream).
+    //! Stat values are quantized to thousandths and sent as differences from
+    //! the previously sent value, so stats that did not change take no space.
+    //! Samples are accumulated and sent in batches. Every few seconds the
+    //! encoder sends a keyframe containing all stat names and absolute values,
+    //! so listeners connecting late can start decoding the stream.
+    class OMEGA_API StatsStreamEncoder
+    {
+    public:
+        static const int Version = 1;
+        //! Seconds between keyframes.
+        static const int KeyframeInterval = 2;
+
+    public:
+        StatsStreamEncoder();
+
+        //! Sets the name of the source of this stream (usually, the node name)
+        void setSourceName(const String& name) { mySourceName = name; }
+        const String& getSourceName() { return mySourceName; }
+
+        //! Adds a set of stat name patterns to the streamed stats. Patterns 
+        //! can contain * wildcards. A rate of zero means every frame.
+        void subscribe(const Vector<String>& patterns, float sampleRate, float sendRate);
+        //! Stops streaming all stats.
+        void clear();
+        bool isActive() { return myPatterns.size() > 0; }
+
+        //! Samples subscribed stats for this frame if a sample is due. When
+        //! it is time to send a message, encodes it into the message buffer
+        //! and returns true.
+        bool update(StatsManager* sm, uint64 frame, float time, Vector<char>& message);
+
+    private:
+        void refreshStats(StatsManager* sm);
+        void beginBatch(float time);
+        void sample(uint64 frame);
+
+    private:
+        struct StreamStat
+        {
+            String name;
+            Stat* stat;
+            int64 lastValue;
+            bool defined;
+        };
+
+        String mySourceName;
+        Vector<String> myPatterns;
+        float mySampleInterval;
+        float mySendInterval;
+        float myLastSampleTime;
+        float myLastSendTime;
+        float myLastKeyframeTime;
+
+        // Stat ids are indices in this vector, and never change during 
+        // the lifetime of the stream.
+        Vector<StreamStat> myStats;
+        uint myStatsVersion;
+        bool myStatsDirty;
+
+        // Current batch
+        bool myKeyframe;
+        uint64 myLastFrame;
+        int myNumDefinitions;
+        Vector<char> myDefinitions;
+        int myNumFrames;
+        Vector<char> myFrames;
+    };
+
+    ///////////////////////////////////////////////////////////////////////////
+    //! Decodes stat stream messages generated by StatsStreamEncoder.
+    class OMEGA_API StatsStreamDecoder
+    {
+    public:
+        //! Receives stat values for each frame in a decoded message
+        class IListener
+        {
+        public:
+            virtual void onStatsFrame(StatsStreamDecoder* decoder, uint64 frame) = 0;
+        };
+
+    public:
+        StatsStreamDecoder(): mySynchronized(false), myFrame(0) {}
+
+        //! Decodes a stream message. Messages received before the first
+        //! keyframe are ignored. Returns false if the message is malformed.
+        bool decode(const char* data, int size, IListener* listener);
+        //! Reads the source name from a stream message, without decoding it.
+        static String peekSourceName(const char* data, int size);
+
+        bool isSynchronized() { return mySynchronized; }
+        const String& getSourceName() { return mySourceName; }
+        uint64 getFrame() { return myFrame; }
+
+        int getNumStats() { return myNames.size(); }
+        //! Returns the id of a stat, or -1 if the stream contains no stat 
+        //! with that name.
+        int findStat(const String& name);
+        const String& getStatName(int id) { return myNames[id]; }
+        double getStatValue(int id) { return (double)myValues[id] / 1000.0; }
+
+    private:
+        bool mySynchronized;
+        String mySourceName;
+        uint64 myFrame;
+        Vector<String> myNames;
+        Vector<int64> myValues;
+    };
+
+    ///////////////////////////////////////////////////////////////////////////
+    //! Merges the stat streams of the nodes of a cluster. For each frame, 
+    //! finds the slowest node according to a ranking stat (by default, the 
+    //! frame time of the first rendering context), and periodically prints a 
+    //! report on the slowest nodes.
+    class OMEGA_API StatsAggregator: public ReferenceType, StatsStreamDecoder::IListener
+    {
+    public:
+        //! Frames older than this many frames from the newest frame received
+        //! are considered complete even if some nodes did not report them.
+        static const int MaxPendingFrames = 120;
+
+    public:
+        StatsAggregator(const String& rankingStat = "ctx0 frame");
+        virtual ~StatsAggregator();
+
+        const String& getRankingStat() { return myRankingStat; }
+        //! Sets the interval between reports, in seconds. Zero disables reports.
+        void setReportInterval(float seconds) { myReportInterval = seconds; }
+        float getReportInterval() { return myReportInterval; }
+
+        //! Returns the payload of the stat subscription message sources 
+        //! should receive for this aggregator to work.
+        String getSubscription();
+
+        //! Handles a stream message from a source. Sources are identified by
+        //! an id (i.e. their connection id), and named in reports by sourceName.
+        void handleStream(int sourceId, const String& sourceName, const char* data, int size);
+        //! Forgets about a source that disconnected.
+        void removeSource(int sourceId);
+
+        //! Prints a report if the report interval elapsed.
+        void update();
+
+        //! Data about the last completed frame
+        //@{
+        uint64 getLastFrame() { return myLastFrame; }
+        const String& getLastSlowestSource() { return myLastSlowestSource; }
+        double getLastSlowestValue() { return myLastSlowestValue; }
+        //@}
+
+        // StatsStreamDecoder::IListener override
+        virtual void onStatsFrame(StatsStreamDecoder* decoder, uint64 frame);
+
+    private:
+        void completeFrames(bool all);
+        void report();
+
+    private:
+        struct Source
+        {
+            Source(): slowestCount(0) {}
+            String name;
+            StatsStreamDecoder decoder;
+            int slowestCount;
+        };
+        struct FrameRecord
+        {
+            FrameRecord(): reports(0), slowestValue(0), slowestSourceId(-1) {}
+            int reports;
+            double slowestValue;
+            int slowestSourceId;
+            String slowestSource;
+        };
+
+        String myRankingStat;
+        float myReportInterval;
+        Timer myReportTimer;
+
+        Dictionary<int, Source*> mySources;
+        // Source of the stream being decoded
+        int myDecodingSourceId;
+        Dictionary<uint64, FrameRecord> myPendingFrames;
+        uint64 myNewestFrame;
+
+        uint64 myLastFrame;
+        String myLastSlowestSource;
+        double myLastSlowestValue;
+        int myCompletedFrames;
+    };
+}; // namespace omega
+
+#endif
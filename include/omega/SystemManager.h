@@ -97,7 +97,10 @@ namespace omega
 
 		//! Initializes the system manager
 		void setup(Config* cfg);
-		void setupRemote(Config* cfg, const String& masterHostname);
+		//! Sets up a remote (slave) node. If a launcher address 
+		//! (<hostname>:<port>) is specified, the node notifies the master 
+		//! launcher when it is ready to accept display system connections.
+		void setupRemote(Config* cfg, const String& masterHostname, const String& launcherAddress = "");
 
 		void initialize();
 
@@ -154,6 +157,9 @@ namespace omega
 
 		String getHostname();
 		const String& getHostnameAndPort();
+		//! Returns the address of the master node launcher, or an empty 
+		//! string if this node has not been started by a launcher.
+		const String& getLauncherAddress() { return myLauncherAddress; }
 
 		PythonInterpreter* getScriptInterpreter(); 
 
@@ -170,9 +176,37 @@ namespace omega
 		//! Returns a mission control client instance. Returns NULL if no 
 		//! mission control client is runnning.
 		MissionControlClient* getMissionControlClient();
+		//! Returns the port of the mission control server cluster nodes 
+		//! should report to, or 0 if there is none. This is the server
+		//! running on this node, or the server this node connects to as a 
+		//! client.
+		int getMissionControlPort() { return myMissionControlPort; }
+		//! Returns the host of the mission control server cluster nodes 
+		//! should report to. An empty string means the server runs on this
+		//! node.
+		const String& getMissionControlHost() { return myMissionControlHost; }
+		//! Sets up mission control. Cluster nodes only support the 
+		//! '@host:port' mode, used by the master to have them connect to its
+		//! server under their hostname:port name.
 		void setupMissionControl(const String& mode);
 		//@}
 
+		//! Startup profiling
+		//@{
+		//! Marks the start of a startup phase. Phases can overlap and can run
+		//! on different threads (i.e. per-context renderer initialization).
+		void beginStartupPhase(const String& name);
+		//! Marks the end of a startup phase. The phase duration is logged and
+		//! stored in a 'startup <name>' time stat.
+		void endStartupPhase(const String& name);
+		//! Called by renderers when they finish drawing a frame. The first 
+		//! call records the time to first frame in the 'startup first frame' 
+		//! stat.
+		void notifyFrameFinished();
+		//! Returns true until the first frame has been drawn.
+		bool isStartingUp() { return !myFirstFrameFinished; }
+		//@}
+
 	private:
 		SystemManager();
 		~SystemManager();
@@ -180,6 +214,9 @@ namespace omega
 		//! Utility function, offsets the netservice port using the system 
 		//! manager application instance id, to avoid port conflicts.
 		void adjustNetServicePort(Setting& stnetsvc);
+		//! Stores the mission control server the master connects to as a
+		//! client, so cluster nodes can report to the same server.
+		void setMissionControlTarget(const String& host, int port);
 
 	private:
 		// Singleton instance.
@@ -203,6 +240,7 @@ namespace omega
 
 		String myHostname;
 		String myProgramName;
+		String myLauncherAddress;
 
 		//! The application instance id.
 		MultiInstanceConfig myMultiInstanceConfig;
@@ -210,9 +248,18 @@ namespace omega
 		// Stats manager.
 		Ref<StatsManager> myStatsManager;
 
+		// Startup profiling. The timer starts when the system manager is
+		// created.
+		Timer myStartupTimer;
+		Lock myStartupLock;
+		Dictionary<String, double> myStartupPhases;
+		bool myFirstFrameFinished;
+
 		// Mission Contol
 		MissionControlServer* myMissionControlServer;
 		MissionControlClient* myMissionControlClient;
+		int myMissionControlPort;
+		String myMissionControlHost;
 	};
 
 	///////////////////////////////////////////////////////////////////////////
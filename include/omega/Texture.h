@@ -43,9 +43,14 @@ namespace omega
 		static void enablePboTransfers(bool value) { sUsePbo = value; }
 
 	public:
-		//! Initializes this texture object
-		void initialize(int width, int height, uint format = 0); 
+		//! Initializes this texture object. If internalFormat is specified, it
+		//! is used as the texture storage format (i.e. to let the driver 
+		//! transcode pixels to a compressed format).
+		void initialize(int width, int height, uint format = 0, uint internalFormat = 0); 
+		//! Initializes this texture with block-compressed data.
+		void initializeCompressed(int width, int height, uint internalFormat, const byte* data, size_t size);
 		bool isInitialized() { return myInitialized; }
+		bool isCompressed();
 
 		void writePixels(PixelData* data);
 		void readPixels(PixelData* data);
@@ -63,10 +68,29 @@ namespace omega
 		GpuContext::TextureUnit getTextureUnit();
 		//@}
 
+		//! Memory management
+		//@{
+		//! Releases the GL texture and PBO owned by this object. The texture
+		//! becomes uninitialized and can be initialized again.
+		virtual void dispose();
+		//! Returns the number of GPU bytes used by this texture.
+		size_t getMemorySize() { return myMemorySize; }
+		//! Evictable textures can be disposed by the renderer when the GPU 
+		//! context goes over its memory budget. Textures created by 
+		//! TextureSource are evictable, since their source can refresh them.
+		void setEvictable(bool value) { myEvictable = value; }
+		bool isEvictable() { return myEvictable; }
+		void setLastUsedFrame(uint64 frame) { myLastUsedFrame = frame; }
+		uint64 getLastUsedFrame() { return myLastUsedFrame; }
+		//@}
+
 	protected:
 		// Only renderer can allocate textures.
 		Texture(GpuContext* context);
 
+	private:
+		void updateMemorySize();
+
 	private:
 		static bool sUsePbo;
 
@@ -75,10 +99,15 @@ namespace omega
 		int myWidth;
 		int myHeight;
 		uint myGlFormat;
+		uint myGlInternalFormat;
 
 		GLuint myPboId;
 
 		GpuContext::TextureUnit myTextureUnit;
+
+		size_t myMemorySize;
+		bool myEvictable;
+		uint64 myLastUsedFrame;
 	};
 
 	///////////////////////////////////////////////////////////////////////////////////////////////
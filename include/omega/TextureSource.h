@@ -39,6 +39,7 @@ namespace omega {
 	public:
 		TextureSource(): 
 			myTextureUpdateFlags(0), 
+			myQueuedUploadFlags(0),
 			myDirty(false), myRequireExplicitClean(false) {}
 		virtual ~TextureSource() {}
 
@@ -53,12 +54,22 @@ namespace omega {
 		//! clean only Through an explicit setDirty(false) call.
 		void requireExplicitClean(bool value) { myRequireExplicitClean = value; }
 
+		//! Refreshes the texture for the passed context if it has been queued 
+		//! for a staged upload. Called by GpuContext::processTextureUploads.
+		//! Returns the refreshed texture, or NULL if nothing was uploaded.
+		Texture* stageUpload(const DrawContext& context);
+
 	protected:
 		virtual void refreshTexture(Texture* texture, const DrawContext& context) = 0;
 
 	private:
+		// Protects the texture array and update flags: setDirty is called on
+		// the main thread while pipe threads refresh textures.
+		Lock myLock;
 		Ref<Texture> myTextures[GpuContext::MaxContexts];
 		uint64_t myTextureUpdateFlags;
+		// Contexts this source has been queued on for a staged upload.
+		uint64_t myQueuedUploadFlags;
 		bool myRequireExplicitClean;
 		bool myDirty;
 	};
@@ -0,0 +1,114 @@
+/******************************************************************************
+ * THE OMEGA LIB PROJECT
+ *-----------------------------------------------------------------------------
+ * Copyright 2010-2013		Electronic Visualization Laboratory, 
+ *							University of Illinois at Chicago
+ * Authors:										
+ *  Alessandro Febretti		febret@gmail.com
+ *-----------------------------------------------------------------------------
+ * Copyright (c) 2010-2013, Electronic Visualization Laboratory,  
+ * University of Illinois at Chicago
+ * All rights reserved.
+ * Redistribution and use in source and binary forms, with or without modification, 
+ * are permitted provided that the following conditions are met:
+ * 
+ * Redistributions of source code must retain the above copyright notice, this 
+ * list of conditions and the following disclaimer. Redistributions in binary 
+ * form must reproduce the above copyright notice, this list of conditions and 
+ * the following disclaimer in the documentation and/or other materials provided 
+ * with the distribution. 
+ * 
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" 
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO THE 
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE 
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE 
+ * LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL 
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE  GOODS OR 
+ * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER 
+ * CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, 
+ * OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE 
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ *-----------------------------------------------------------------------------
+ * What's in this file
+ *	A policy that lowers the rendering quality of display tiles outside the
+ *	field of view of a tracked user.
+ ******************************************************************************/
+#ifndef __TILE_QUALITY_POLICY_H__
+#define __TILE_QUALITY_POLICY_H__
+
+#include "osystem.h"
+#include "omega/DisplayConfig.h"
+
+namespace omega {
+	///////////////////////////////////////////////////////////////////////////
+	//! Classifies display tiles based on their angle from the head direction
+	//! of the tracked user, and assigns each tile a rendering quality. 
+	//! Designed for cylindrical displays, where tiles to the side and behind
+	//! the user can be rendered at lower quality without being noticed.
+	//! Angles are measured on the horizontal plane. Tiles closer to the head
+	//! direction than the first class angle are drawn at full quality.
+	//! Configuration (in the system config section):
+	//! @code
+	//! tileQuality: {
+	//!     enabled = true;
+	//!     hysteresis = 10;            // degrees
+	//!     classes: {
+	//!         peripheral: { angle = 60; resolutionScale = 0.75; };
+	//!         rear: { angle = 110; resolutionScale = 0.5; mono = true; frameInterval = 2; };
+	//!     };
+	//! };
+	//! @endcode
+	class OMEGA_API TileQualityPolicy: public ReferenceType
+	{
+	public:
+		struct QualityClass
+		{
+			String name;
+			//! Minimum angle (in degrees) from the head direction.
+			float angle;
+			//! Scene resolution scale.
+			float resolutionScale;
+			//! When true, the tile is drawn in mono. Not applied to side-by-side
+			//! stereo tiles.
+			bool mono;
+			//! The tile scene is redrawn every frameInterval frames.
+			int frameInterval;
+		};
+
+	public:
+		TileQualityPolicy();
+
+		void setup(const Setting& s);
+
+		//! Returns the index of the quality class for a tile, or -1 if the
+		//! tile should be drawn at full quality. currentClass is the class 
+		//! assigned to the tile in the previous frame, used to apply 
+		//! hysteresis.
+		int classifyTile(const DisplayTileConfig* tile, 
+			const Vector3f& headPosition, const Quaternion& headOrientation, 
+			int currentClass);
+		const QualityClass& getClass(int index);
+		int getNumClasses();
+
+		bool isEnabled() { return myEnabled; }
+		void setEnabled(bool value) { myEnabled = value; }
+		float getHysteresis() { return myHysteresis; }
+		void setHysteresis(float value) { myHysteresis = value; }
+
+	private:
+		bool myEnabled;
+		float myHysteresis;
+		// Quality classes, sorted by increasing angle.
+		Vector<QualityClass> myClasses;
+	};
+
+	///////////////////////////////////////////////////////////////////////////
+	inline const TileQualityPolicy::QualityClass& TileQualityPolicy::getClass(int index)
+	{ return myClasses[index]; }
+
+	///////////////////////////////////////////////////////////////////////////
+	inline int TileQualityPolicy::getNumClasses()
+	{ return myClasses.size(); }
+}; // namespace omega
+
+#endif
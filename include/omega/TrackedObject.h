@@ -37,6 +37,7 @@
 #define __TRACKED_OBJECT__
 
 #include "omega/Actor.h"
+#include "omega/PosePredictor.h"
 
 namespace omega {
     ///////////////////////////////////////////////////////////////////////////
@@ -76,6 +77,14 @@ namespace omega {
         void setAutoHideEnabled(bool value);
         bool isAutoHideEnabled();
 
+        //! Sets a pose predictor for this object. When a predictor is set, the
+        //! object pose is extrapolated to the expected display time at every
+        //! update. A predictor is created automatically when setting a 
+        //! trackable source id that has a posePrediction/source<id> section 
+        //! in the system configuration.
+        void setPosePredictor(PosePredictor* value);
+        PosePredictor* getPosePredictor();
+
     private:
         Vector3f myTrackedPosition;
         Quaternion myTrackedOrientation;
@@ -92,6 +101,8 @@ namespace omega {
         float myHideTimeout;
         bool myEventReceivedSinceLastUpdate;
         float myLastEventTime;
+
+        Ref<PosePredictor> myPosePredictor;
     };
 
     ///////////////////////////////////////////////////////////////////////////
@@ -135,8 +146,12 @@ namespace omega {
     { return myTrackableServiceType; }
 
     ///////////////////////////////////////////////////////////////////////////
-    inline void TrackedObject::setTrackableSourceId(int value) 
-    { myTrackableSourceId = value; }
+    inline void TrackedObject::setPosePredictor(PosePredictor* value) 
+    { myPosePredictor = value; }
+
+    ///////////////////////////////////////////////////////////////////////////
+    inline PosePredictor* TrackedObject::getPosePredictor() 
+    { return myPosePredictor; }
 
     ///////////////////////////////////////////////////////////////////////////
     inline int TrackedObject::getTrackableSourceId() 
@@ -46,6 +46,7 @@
 #include "omegaToolkit/ui/MenuManager.h"
 #include "omegaToolkit/ui/DefaultSkin.h"
 #include "omegaToolkit/ui/Slider.h"
+#include "omegaToolkit/ui/TiledImage.h"
 #include "omegaToolkit/ui/Widget.h"
 #include "omegaToolkit/ui/WidgetFactory.h"
 
@@ -0,0 +1,378 @@
+/******************************************************************************
+ * THE OMEGA LIB PROJECT
+ *-----------------------------------------------------------------------------
+ * Copyright 2010-2013		Electronic Visualization Laboratory, 
+ *							University of Illinois at Chicago
+ * Authors:										
+ *  Alessandro Febretti		febret@gmail.com
+ *-----------------------------------------------------------------------------
+ * Copyright (c) 2010-2013, Electronic Visualization Laboratory,  
+ * University of Illinois at Chicago
+ * All rights reserved.
+ * Redistribution and use in source and binary forms, with or without modification, 
+ * are permitted provided that the following conditions are met:
+ * 
+ * Redistributions of source code must retain the above copyright notice, this 
+ * list of conditions and the following disclaimer. Redistributions in binary 
+ * form must reproduce the above copyright notice, this list of conditions and 
+ * the following disclaimer in the documentation and/or other materials provided 
+ * with the distribution. 
+ * 
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" 
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO THE 
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE 
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE 
+ * LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL 
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE  GOODS OR 
+ * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER 
+ * CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, 
+ * OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE 
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ *-----------------------------------------------------------------------------
+ * What's in this file
+ *	A module running a Bullet dynamics world on the master node and 
+ *	replicating rigid body transforms to slave nodes.
+ ******************************************************************************/
+#ifndef __BULLET_PHYSICS_MODULE_H__
+#define __BULLET_PHYSICS_MODULE_H__
+
+#include "omega/Engine.h"
+#include "omega/ModuleServices.h"
+#include "omega/SharedDataServices.h"
+#include "omega/SystemManager.h"
+
+#include <btBulletDynamicsCommon.h>
+
+namespace omegaToolkit
+{
+	using namespace omega;
+
+	///////////////////////////////////////////////////////////////////////////
+	//! Runs a Bullet dynamics world on the master node and replicates rigid
+	//! body transforms to slave nodes.
+	//! @remarks
+	//!		The world is stepped in fixedUpdate, at the engine fixed update 
+	//!		rate, on the master node only. At each frame the master sends the
+	//!		transforms of the dynamic bodies that moved since the last frame,
+	//!		quantized to 16 bit integers. Slaves never step the world. 
+	//!		The master displays exactly what it sends: steps run during a 
+	//!		frame are shown from the next frame on all nodes, interpolated 
+	//!		between the last two simulation states using the fixed update 
+	//!		alpha of the frame that ran them.
+	//!		Bodies are identified by their index in the world collision object
+	//!		array, so all nodes must build the world in the same order. 
+	//!		Static and kinematic bodies are not replicated, since application
+	//!		code drives them on all nodes.
+	//!		This module is header-only so that omegaToolkit does not depend on
+	//!		Bullet: applications including it need to link the Bullet libraries.
+	class BulletPhysicsModule: public EngineModule
+	{
+	public:
+		BulletPhysicsModule(btDynamicsWorld* world);
+
+		btDynamicsWorld* getWorld() { return myWorld; }
+
+		//! Sets the number of Bullet substeps run at each fixed update.
+		void setSubsteps(int value) { mySubsteps = value; }
+		int getSubsteps() { return mySubsteps; }
+
+		//! Sets the position quantization step in world units. Bodies farther
+		//! than 32767 steps from the origin have their position sent as floats.
+		void setPositionPrecision(float value) { myPositionPrecision = value; }
+		float getPositionPrecision() { return myPositionPrecision; }
+
+		virtual void update(const UpdateContext& context);
+		virtual void fixedUpdate(const UpdateContext& context);
+		virtual void commitSharedData(SharedOStream& out);
+		virtual void updateSharedData(SharedIStream& in);
+
+	private:
+		// A body transform as sent over the network.
+		struct PackedTransform
+		{
+			enum Flags { 
+				//! Bits 0-1 store the index of the omitted quaternion component.
+				LargestComponentMask = 3, 
+				//! Position is stored in floatPosition.
+				FloatPosition = 4 };
+			byte flags;
+			short position[3];
+			float floatPosition[3];
+			short orientation[3];
+
+			bool operator==(const PackedTransform& p) const;
+		};
+
+		struct BodyState
+		{
+			btTransform previous;
+			btTransform current;
+			PackedTransform sent;
+			bool hasSent;
+			bool displayed;
+		};
+
+		bool isReplicated(int index);
+		void updateBodyList();
+		//! Starts displaying a new committed simulation state.
+		void beginState(float alpha, int steps);
+		//! Sets the body motion states to their displayed transforms. When
+		//! force is false, bodies at rest that have been displayed are skipped.
+		void applyDisplayTransforms(bool force);
+		void pack(const btTransform& t, PackedTransform* p);
+		void unpack(const PackedTransform& p, btTransform* t);
+
+	private:
+		btDynamicsWorld* myWorld;
+		int mySubsteps;
+		float myPositionPrecision;
+
+		std::vector<BodyState> myBodies;
+		// Number of simulation steps run since the last commit (master only)
+		int myStepsSinceCommit;
+		// Interpolation alpha of the displayed state
+		float myAlpha;
+	};
+
+	///////////////////////////////////////////////////////////////////////////
+	inline bool BulletPhysicsModule::PackedTransform::operator==(const PackedTransform& p) const
+	{
+		if(flags != p.flags) return false;
+		for(int i = 0; i < 3; i++)
+		{
+			if(orientation[i] != p.orientation[i]) return false;
+			if(flags & FloatPosition)
+			{
+				if(floatPosition[i] != p.floatPosition[i]) return false;
+			}
+			else if(position[i] != p.position[i]) return false;
+		}
+		return true;
+	}
+
+	///////////////////////////////////////////////////////////////////////////
+	inline BulletPhysicsModule::BulletPhysicsModule(btDynamicsWorld* world):
+		EngineModule("BulletPhysicsModule"),
+		myWorld(world),
+		mySubsteps(1),
+		myPositionPrecision(0.001f),
+		myStepsSinceCommit(0),
+		myAlpha(1)
+	{
+		enableSharedData();
+	}
+
+	///////////////////////////////////////////////////////////////////////////
+	inline bool BulletPhysicsModule::isReplicated(int index)
+	{
+		btRigidBody* body = btRigidBody::upcast(myWorld->getCollisionObjectArray()[index]);
+		return body != NULL && !body->isStaticOrKinematicObject();
+	}
+
+	///////////////////////////////////////////////////////////////////////////
+	inline void BulletPhysicsModule::updateBodyList()
+	{
+		int n = myWorld->getNumCollisionObjects();
+		for(int i = myBodies.size(); i < n; i++)
+		{
+			BodyState bs;
+			bs.current = myWorld->getCollisionObjectArray()[i]->getWorldTransform();
+			bs.previous = bs.current;
+			bs.hasSent = false;
+			bs.displayed = false;
+			myBodies.push_back(bs);
+		}
+	}
+
+	///////////////////////////////////////////////////////////////////////////
+	inline void BulletPhysicsModule::fixedUpdate(const UpdateContext& context)
+	{
+		if(!SystemManager::instance()->isMaster()) return;
+
+		myWorld->stepSimulation(context.dt, mySubsteps, context.dt / mySubsteps);
+		myStepsSinceCommit++;
+
+		// Stepping writes the new transforms to the body motion states. They
+		// are displayed from the next frame, so put back the current ones.
+		applyDisplayTransforms(true);
+	}
+
+	///////////////////////////////////////////////////////////////////////////
+	inline void BulletPhysicsModule::update(const UpdateContext& context)
+	{
+		applyDisplayTransforms(false);
+	}
+
+	///////////////////////////////////////////////////////////////////////////
+	inline void BulletPhysicsModule::beginState(float alpha, int steps)
+	{
+		updateBodyList();
+		myAlpha = alpha;
+
+		// A new simulation state: the one we had becomes the interpolation 
+		// start for all bodies, including the ones that did not move.
+		if(steps > 0)
+		{
+			for(int i = 0; i < myBodies.size(); i++)
+			{
+				myBodies[i].previous = myBodies[i].current;
+			}
+		}
+	}
+
+	///////////////////////////////////////////////////////////////////////////
+	inline void BulletPhysicsModule::applyDisplayTransforms(bool force)
+	{
+		bool master = SystemManager::instance()->isMaster();
+
+		for(int i = 0; i < myBodies.size(); i++)
+		{
+			if(!isReplicated(i)) continue;
+
+			BodyState& bs = myBodies[i];
+			// Bodies at rest have already been displayed at their position.
+			if(!force && bs.displayed && bs.previous == bs.current) continue;
+
+			btTransform t(
+				bs.previous.getRotation().slerp(bs.current.getRotation(), myAlpha),
+				bs.previous.getOrigin().lerp(bs.current.getOrigin(), myAlpha));
+
+			btRigidBody* body = btRigidBody::upcast(myWorld->getCollisionObjectArray()[i]);
+			// Slaves keep the body in sync too, so collision queries work.
+			if(!master) body->setWorldTransform(bs.current);
+			if(body->getMotionState() != NULL) body->getMotionState()->setWorldTransform(t);
+			bs.displayed = true;
+		}
+	}
+
+	///////////////////////////////////////////////////////////////////////////
+	inline void BulletPhysicsModule::commitSharedData(SharedOStream& out)
+	{
+		// The steps run during the last frame and its fixed update alpha 
+		// become the displayed state, on the master as on the slaves.
+		float alpha = getEngine()->getFixedUpdateAlpha();
+		beginState(alpha, myStepsSinceCommit);
+
+		std::vector<unsigned short> changed;
+		for(int i = 0; i < myBodies.size(); i++)
+		{
+			if(!isReplicated(i)) continue;
+
+			PackedTransform p;
+			pack(myWorld->getCollisionObjectArray()[i]->getWorldTransform(), &p);
+			if(!myBodies[i].hasSent || !(p == myBodies[i].sent))
+			{
+				myBodies[i].sent = p;
+				myBodies[i].hasSent = true;
+				changed.push_back(i);
+				// Display the quantized transform slaves receive.
+				unpack(p, &myBodies[i].current);
+			}
+		}
+
+		out << alpha << myStepsSinceCommit;
+		out << (unsigned short)changed.size();
+		foreach(unsigned short i, changed)
+		{
+			const PackedTransform& p = myBodies[i].sent;
+			out << i << p.flags;
+			if(p.flags & PackedTransform::FloatPosition) out.write(p.floatPosition, sizeof(p.floatPosition));
+			else out.write(p.position, sizeof(p.position));
+			out.write(p.orientation, sizeof(p.orientation));
+		}
+		myStepsSinceCommit = 0;
+	}
+
+	///////////////////////////////////////////////////////////////////////////
+	inline void BulletPhysicsModule::updateSharedData(SharedIStream& in)
+	{
+		float alpha;
+		int steps;
+		unsigned short numChanged;
+		in >> alpha >> steps >> numChanged;
+
+		beginState(alpha, steps);
+
+		for(int j = 0; j < numChanged; j++)
+		{
+			unsigned short i;
+			PackedTransform p;
+			in >> i >> p.flags;
+			if(p.flags & PackedTransform::FloatPosition) in.read(p.floatPosition, sizeof(p.floatPosition));
+			else in.read(p.position, sizeof(p.position));
+			in.read(p.orientation, sizeof(p.orientation));
+
+			if(i < myBodies.size()) unpack(p, &myBodies[i].current);
+			else ofwarn("BulletPhysicsModule: unknown body %1%. Is the world built the same way on all nodes?", %i);
+		}
+	}
+
+	///////////////////////////////////////////////////////////////////////////
+	inline void BulletPhysicsModule::pack(const btTransform& t, PackedTransform* p)
+	{
+		const btVector3& pos = t.getOrigin();
+		p->flags = 0;
+		for(int i = 0; i < 3; i++)
+		{
+			float q = pos[i] / myPositionPrecision;
+			if(q < -32767 || q > 32767)
+			{
+				p->flags |= PackedTransform::FloatPosition;
+				q = 0;
+			}
+			p->position[i] = (short)btFloor(q + 0.5f);
+			p->floatPosition[i] = pos[i];
+		}
+
+		// Smallest three encoding: drop the largest component (made positive)
+		// and store the other three, which are within +-1/sqrt(2).
+		btQuaternion q = t.getRotation();
+		int largest = 0;
+		for(int i = 1; i < 4; i++)
+		{
+			if(btFabs(q[i]) > btFabs(q[largest])) largest = i;
+		}
+		if(q[largest] < 0) q = -q;
+		p->flags |= largest;
+
+		const float scale = 32767.0f * SIMD_SQRT12 * 2;
+		int j = 0;
+		for(int i = 0; i < 4; i++)
+		{
+			if(i != largest) p->orientation[j++] = (short)btFloor(q[i] * scale + 0.5f);
+		}
+	}
+
+	///////////////////////////////////////////////////////////////////////////
+	inline void BulletPhysicsModule::unpack(const PackedTransform& p, btTransform* t)
+	{
+		if(p.flags & PackedTransform::FloatPosition)
+		{
+			t->setOrigin(btVector3(p.floatPosition[0], p.floatPosition[1], p.floatPosition[2]));
+		}
+		else
+		{
+			t->setOrigin(btVector3(p.position[0], p.position[1], p.position[2]) * myPositionPrecision);
+		}
+
+		int largest = p.flags & PackedTransform::LargestComponentMask;
+		const float scale = 32767.0f * SIMD_SQRT12 * 2;
+		btScalar c[4];
+		btScalar sum = 0;
+		int j = 0;
+		for(int i = 0; i < 4; i++)
+		{
+			if(i != largest)
+			{
+				c[i] = p.orientation[j++] / scale;
+				sum += c[i] * c[i];
+			}
+		}
+		c[largest] = btSqrt(btMax(btScalar(0), btScalar(1) - sum));
+		btQuaternion q(c[0], c[1], c[2], c[3]);
+		q.normalize();
+		t->setRotation(q);
+	}
+}; // namespace omegaToolkit
+
+#endif
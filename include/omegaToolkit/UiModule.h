@@ -76,6 +76,13 @@ namespace omegaToolkit
 		void setCullingEnabled(bool value) { myCullingEnabled = value; }
 		bool isCullingEnabled() { return myCullingEnabled; }
 
+		//! Sets the minimum number of children a container needs to have to 
+		//! dispatch pointer events through a spatial index, instead of 
+		//! forwarding them to all its children. 0 disables the index.
+		//! Defaults to 16.
+		void setHitTestIndexThreshold(int value) { myHitTestIndexThreshold = value; }
+		int getHitTestIndexThreshold() { return myHitTestIndexThreshold; }
+
 		void activateWidget(ui::Widget* w);
 
 		//! Extended ui
@@ -102,6 +109,7 @@ namespace omegaToolkit
 		bool myLocalEventsEnabled;
 
 		bool myCullingEnabled;
+		int myHitTestIndexThreshold;
 
 		Ref<ui::Widget> myActiveWidget;
 		Ref<ui::Container> myUi;
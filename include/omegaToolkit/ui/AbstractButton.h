@@ -46,7 +46,7 @@ namespace omegaToolkit { namespace ui {
 		void setRadio(bool value)  { myRadio = value; }
 
 		bool isChecked() { return myChecked; }
-		void setChecked(bool value) { myChecked = value; }
+		void setChecked(bool value) { myChecked = value; invalidate(); }
 
 		bool isPressed() { return myPressed; }
 
@@ -54,13 +54,13 @@ namespace omegaToolkit { namespace ui {
 		virtual void update(const omega::UpdateContext& context);
 
 		omega::String getText() { return myLabel.getText(); }
-		void setText(omega::String value) { myLabel.setText(value); requestLayoutRefresh(); }
+		void setText(omega::String value) { myLabel.setText(value); requestAutosize(); }
 
 		void setIcon(PixelData* icon) { myImage.setData(icon); setImageEnabled(true); }
 		PixelData* getIcon() { return myImage.getData(); }
 
 		Image* getImage() { return &myImage; }
-		void setImageEnabled(bool value) { myImageEnabled = true; }
+		void setImageEnabled(bool value) { myImageEnabled = true; invalidate(); }
 		bool isImageEnabled() { return myImageEnabled; }
 
 		// Gets the label subobject used by the button.
@@ -89,6 +89,7 @@ namespace omegaToolkit { namespace ui {
 	inline void Button::setColor(Color value)
 	{
 		myColor = value;
+		invalidate();
 	}
 
 };};
@@ -71,12 +71,46 @@ namespace omegaToolkit { namespace ui {
         SceneNode* node;
     };
 
+    ////////////////////////////////////////////////////////////////////////////
+    //! A uniform grid over the bounds of the children of a container. Used to
+    //! find the children under a pointer without hit-testing all of them.
+    class OTK_API ContainerHitTestIndex
+    {
+    public:
+        ContainerHitTestIndex(): myColumns(0), myRows(0) {}
+
+        //! Rebuilds the index from the current children bounds.
+        void build(const List< Ref<Widget> >& children);
+        //! Returns the children that may contain the specified point (in 
+        //! container coordinates), plus the ones in the extra list, in 
+        //! container order. Children that can't be bounded (rotated widgets,
+        //! 3D containers) are always returned.
+        void query(const Vector2f& point, const List<Widget*>& extra, Vector< Ref<Widget> >& result);
+
+        //! Computes the bounds of a widget and all its children, in the 
+        //! coordinate space of its container. Returns false if the widget
+        //! can't be bounded.
+        static bool getBounds(Widget* w, Vector2f& min, Vector2f& max);
+
+    private:
+        Vector<Widget*> myChildren;
+        Dictionary<Widget*, int> myChildIndices;
+        Vector<int> myUnbounded;
+        Vector< Vector<int> > myCells;
+        Vector2f myMin;
+        Vector2f myCellSize;
+        int myColumns;
+        int myRows;
+    };
+
     ////////////////////////////////////////////////////////////////////////////
     class OTK_API Container: public Widget
     {
     //friend class Engine;
     friend class ContainerRenderable;
+    friend class ContainerHitTestIndex;
     friend class UiRenderPass;
+    friend class Widget;
     public:
         enum Layout {LayoutFree, LayoutHorizontal, LayoutVertical, LayoutGridHorizontal, LayoutGridVertical};
         enum HorizontalAlign { AlignRight, AlignLeft, AlignCenter};
@@ -138,6 +172,9 @@ namespace omegaToolkit { namespace ui {
         //! For 3D mode containers: converts a ray event to a pointer event with 2D coordintes in the container coordinate space.
         //! Returns true if the event happens within the container boundaries, and could be converted to a pointer event successfully.
         bool rayToPointerEvent(const Event& inEvt, Event& outEvt);
+        //! Clears the per-event cache of view rays used by 3D containers. 
+        //! UiModule calls this before dispatching each event.
+        static void resetEventCache();
 
         virtual void layout();
 
@@ -165,6 +202,9 @@ namespace omegaToolkit { namespace ui {
         virtual void activate();
 
     private:
+        //! Forwards a pointer event to the children under it.
+        void dispatchPointerEvent(const Event& evt);
+
         int expandStep(int childSpace, Orientation orientation);
         void updateChildrenLayoutPosition(Orientation orientation);
         void updateChildrenFreeBounds(Orientation orientation);
@@ -187,16 +227,34 @@ namespace omegaToolkit { namespace ui {
 
         Ref<PixelData> myPixels;
         bool myPixelOutputEnabled;
+
+        // Pointer event dispatch: hit-testing index (rebuilt when the content
+        // version changes) and children holding a pointer capture.
+        ContainerHitTestIndex myHitTestIndex;
+        bool myHitTestIndexValid;
+        uint myHitTestIndexVersion;
+        List<Widget*> myCapturingChildren;
+
+        // 3D containers: result of the last ray / plane intersection, and
+        // the serial of the event that generated it.
+        uint myPlaneHitSerial;
+        bool myPlaneHit;
+        Vector3f myPlaneHitPosition;
     };
 
     ////////////////////////////////////////////////////////////////////////////
     class OTK_API ContainerRenderable: public WidgetRenderable
     {
     public:
-        ContainerRenderable(Container* owner): WidgetRenderable(owner), myOwner(owner), myRenderTarget(NULL), myTexture(NULL) {}
+        ContainerRenderable(Container* owner): WidgetRenderable(owner), myOwner(owner), myRenderTarget(NULL), myTexture(NULL),
+            myRenderedVersion(0), myRenderedFrame(0), myRenderedTile(NULL) {}
         virtual void draw(const DrawContext& context);
 
     protected:
+        //! For 3D and pixel output containers: returns true if the container
+        //! content changed since it was last rendered to its texture / pixel
+        //! buffer. 
+        bool needsRedraw(const DrawContext& context);
         void draw3d(const DrawContext& context);
         void drawChildren(const DrawContext& context, bool containerOnly);
         void beginDraw(const DrawContext& context);
@@ -209,6 +267,14 @@ namespace omegaToolkit { namespace ui {
         // Stuff used for 3d ui rendering.
         Ref<RenderTarget> myRenderTarget;
         Ref<Texture> myTexture;
+
+        // Retained rendering: owner content version last rendered to the 
+        // texture, and the frame / tile of that render. All the eye passes
+        // of the same frame and tile keep drawing, since they composite 
+        // into the same texture.
+        uint myRenderedVersion;
+        uint64 myRenderedFrame;
+        const DisplayTileConfig* myRenderedTile;
     };
 
     ////////////////////////////////////////////////////////////////////////////
@@ -217,7 +283,7 @@ namespace omegaToolkit { namespace ui {
 
     ////////////////////////////////////////////////////////////////////////////
     inline void Container::setLayout(Layout layout) 
-    { myLayout = layout; }
+    { myLayout = layout; requestLayoutRefresh(); }
 
     ////////////////////////////////////////////////////////////////////////////
     inline Container::Layout Container::getLayout() 
@@ -265,11 +331,11 @@ namespace omegaToolkit { namespace ui {
 
     ////////////////////////////////////////////////////////////////////////////
     inline void Container::setGridRows(int value)
-    { myGridRows = value; }
+    { myGridRows = value; requestLayoutRefresh(); }
 
     ////////////////////////////////////////////////////////////////////////////
     inline void Container::setGridColumns(int value)
-    { myGridColumns = value; }
+    { myGridColumns = value; requestLayoutRefresh(); }
 
     ///////////////////////////////////////////////////////////////////////////
     inline bool Container::isIn3DContainer()
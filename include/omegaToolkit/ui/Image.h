@@ -52,6 +52,7 @@ namespace omegaToolkit { namespace ui {
 		virtual ~Image();
 
 		Renderable* createRenderable();
+		virtual void update(const omega::UpdateContext& context);
 
 		PixelData* getData();
 		void setData(PixelData* data);
@@ -123,8 +123,13 @@ namespace omegaToolkit { namespace ui {
 	///////////////////////////////////////////////////////////////////////////////////////////////
 	inline void Label::setText(const String& value) 
 	{ 
-		myText = value; 
-		requestLayoutRefresh();
+		// Labels are often updated every frame with the same text: avoid 
+		// invalidating the layout in that case.
+		if(myText != value)
+		{
+			myText = value; 
+			requestAutosize();
+		}
 	}
 
 	///////////////////////////////////////////////////////////////////////////////////////////////
@@ -133,7 +138,7 @@ namespace omegaToolkit { namespace ui {
 
 	///////////////////////////////////////////////////////////////////////////////////////////////
 	inline void Label::setFont(const String& value)
-	{ myFont = value; refresh(); requestLayoutRefresh(); }
+	{ myFont = value; refresh(); requestAutosize(); }
 
 	///////////////////////////////////////////////////////////////////////////////////////////////
 	inline Color Label::getColor()
@@ -141,7 +146,7 @@ namespace omegaToolkit { namespace ui {
 
 	///////////////////////////////////////////////////////////////////////////////////////////////
 	inline void Label::setColor(const Color& value)
-	{ myColor = value; }
+	{ myColor = value; invalidate(); }
 
 	///////////////////////////////////////////////////////////////////////////////////////////////
 	inline Label::HorizontalAlign Label::getHorizontalAlign()
@@ -149,7 +154,7 @@ namespace omegaToolkit { namespace ui {
 
 	///////////////////////////////////////////////////////////////////////////////////////////////
 	inline void Label::setHorizontalAlign(HorizontalAlign value) 
-	{ myHorizontalAlign = value; }
+	{ myHorizontalAlign = value; invalidate(); }
 
 	///////////////////////////////////////////////////////////////////////////////////////////////
 	inline Label::VerticalAlign Label::getVerticalAlign() 
@@ -157,7 +162,7 @@ namespace omegaToolkit { namespace ui {
 
 	///////////////////////////////////////////////////////////////////////////////////////////////
 	inline void Label::setVerticalAlign(VerticalAlign value) 
-	{ myVerticalAlign = value; }
+	{ myVerticalAlign = value; invalidate(); }
 
 	///////////////////////////////////////////////////////////////////////////////////////////////
 	inline void Label::setAutosizeVerticalPadding(int value) 
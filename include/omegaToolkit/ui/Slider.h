@@ -88,7 +88,7 @@ namespace omegaToolkit { namespace ui {
 
 	///////////////////////////////////////////////////////////////////////////
 	inline void Slider::setValue(int value) 
-	{ myValue = value; }
+	{ myValue = value; invalidate(); }
 
 	///////////////////////////////////////////////////////////////////////////
 	inline int Slider::getTicks() 
@@ -96,7 +96,7 @@ namespace omegaToolkit { namespace ui {
 
 	///////////////////////////////////////////////////////////////////////////
 	inline void Slider::setTicks(int value) 
-	{ myTicks = value; }
+	{ myTicks = value; invalidate(); }
 
 	///////////////////////////////////////////////////////////////////////////
 	inline void Slider::setDeferUpdate(bool value)
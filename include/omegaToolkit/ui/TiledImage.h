@@ -0,0 +1,151 @@
+/******************************************************************************
+ * THE OMEGA LIB PROJECT
+ *-----------------------------------------------------------------------------
+ * Copyright 2010-2013		Electronic Visualization Laboratory, 
+ *							University of Illinois at Chicago
+ * Authors:										
+ *  Alessandro Febretti		febret@gmail.com
+ *-----------------------------------------------------------------------------
+ * Copyright (c) 2010-2013, Electronic Visualization Laboratory,  
+ * University of Illinois at Chicago
+ * All rights reserved.
+ * Redistribution and use in source and binary forms, with or without modification, 
+ * are permitted provided that the following conditions are met:
+ * 
+ * Redistributions of source code must retain the above copyright notice, this 
+ * list of conditions and the following disclaimer. Redistributions in binary 
+ * form must reproduce the above copyright notice, this list of conditions and 
+ * the following disclaimer in the documentation and/or other materials provided 
+ * with the distribution. 
+ * 
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" 
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO THE 
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE 
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE 
+ * LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL 
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE  GOODS OR 
+ * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER 
+ * CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, 
+ * OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE 
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ *-----------------------------------------------------------------------------
+ * What's in this file:
+ *	A widget displaying very large images stored as tiled multiresolution
+ *	pyramids. Only the tiles visible on each display tile are loaded.
+ ******************************************************************************/
+#ifndef __TILED_IMAGE_H__
+#define __TILED_IMAGE_H__
+
+#include "omegaToolkit/omegaToolkitConfig.h"
+#include "omega/ImageUtils.h"
+#include "omegaToolkit/ui/Widget.h"
+
+namespace omegaToolkit { namespace ui {
+	///////////////////////////////////////////////////////////////////////////
+	//! A widget displaying a tiled image pyramid. 
+	//! The pyramid is described by a config file like the following:
+	//!		pyramid: { width = 120000; height = 40000; tileSize = 256; levels = 10; tileFormat = "jpg"; };
+	//! Tiles are stored next to the descriptor as <level>/<column>_<row>.<tileFormat>.
+	//! Level 0 is the full resolution image, every following level halves 
+	//! the resolution of the previous one. Rows are counted from the image top.
+	//! Each renderer streams in (through the ImageUtils async loader) only the
+	//! tiles visible on its own display tiles, at the level of detail matching
+	//! the on-screen image resolution.
+	class OTK_API TiledImage: public Widget
+	{
+	friend class TiledImageRenderable;
+	public:
+		static TiledImage* create(Container* container);
+
+	public:
+		TiledImage(Engine* srv);
+		virtual ~TiledImage();
+
+		Renderable* createRenderable();
+		virtual void update(const omega::UpdateContext& context);
+
+		//! Loads a pyramid descriptor. Returns false if the descriptor could
+		//! not be found or is invalid.
+		bool load(const String& descriptorFile);
+
+		int getImageWidth() { return myImageWidth; }
+		int getImageHeight() { return myImageHeight; }
+		int getTileSize() { return myTileSize; }
+		int getNumLevels() { return myNumLevels; }
+
+		//! Maximum number of tiles each renderer keeps in memory.
+		void setMaxCachedTiles(int value) { myMaxCachedTiles = value; }
+		int getMaxCachedTiles() { return myMaxCachedTiles; }
+		//! Maximum number of tile loads each renderer keeps in flight.
+		void setMaxPendingTiles(int value) { myMaxPendingTiles = value; }
+		int getMaxPendingTiles() { return myMaxPendingTiles; }
+
+		//! Returns the full path of the specified tile.
+		String getTilePath(int level, int col, int row);
+
+	private:
+		//! Called by renderables (from render threads) when tiles are 
+		//! requested or still loading. The widget is invalidated during 
+		//! the next update.
+		void requestTileRedraw();
+
+	protected:
+		String myTilePath;
+		String myTileFormat;
+		int myImageWidth;
+		int myImageHeight;
+		int myTileSize;
+		int myNumLevels;
+		int myMaxCachedTiles;
+		int myMaxPendingTiles;
+		// Incremented every time a new pyramid is loaded, so renderables can
+		// flush their tile caches.
+		uint myVersion;
+
+		// Set by renderables when tiles are loading, cleared by update.
+		Lock myTileRedrawLock;
+		bool myTileRedrawRequested;
+	};
+
+	///////////////////////////////////////////////////////////////////////////
+	class OTK_API TiledImageRenderable: public WidgetRenderable
+	{
+	public:
+		TiledImageRenderable(TiledImage* owner): 
+		  WidgetRenderable(owner), 
+		  myOwner(owner),
+		  myTextureUniform(0),
+		  myVersion(0),
+		  myNumPending(0) {}
+
+		virtual ~TiledImageRenderable();
+		virtual void refresh();
+		virtual void drawContent(const DrawContext& context);
+
+	private:
+		struct Tile
+		{
+			Tile(): lastUsedFrame(0), failed(false) {}
+			Ref<PixelData> pixels;
+			Ref<ImageUtils::LoadImageAsyncTask> task;
+			uint64 lastUsedFrame;
+			bool failed;
+		};
+
+		static uint64 getTileKey(int level, int col, int row)
+		{ return ((uint64)level << 48) | ((uint64)row << 24) | (uint64)col; }
+
+		Tile* requestTile(int level, int col, int row, const DrawContext& context);
+		void drawTile(int level, int col, int row, const DrawContext& context);
+		void updatePendingTiles();
+		void trimCache(const DrawContext& context);
+
+	private:
+		TiledImage* myOwner;
+		GLuint myTextureUniform;
+		uint myVersion;
+		int myNumPending;
+		Dictionary<uint64, Tile> myTiles;
+	};
+}; }; // namespace omegaToolkit
+#endif
@@ -90,7 +90,7 @@ namespace omegaToolkit {
         Vector2f getCenter();
         //! Sets the widget rotation
         //! @param value - the widget rotation in degrees
-        void setRotation(float value) { myRotation = value; }
+        void setRotation(float value) { myRotation = value; invalidate(); }
         //! Gets the widget position.
         float getRotation() { return myRotation; }
         //@}
@@ -129,7 +129,7 @@ namespace omegaToolkit {
         void setVisible(bool value);
         //! When true, the widget is enabled, i.e. it can receive input events and takes part in navigation (can become active)
         bool isEnabled() { return myEnabled; }
-        void setEnabled(bool value) { myEnabled = value; }
+        void setEnabled(bool value) { myEnabled = value; invalidate(); }
         bool isActive() { return myActive; }
         void setActive(bool value);
         //! Returns true if this widget is part of a container that will be drawn
@@ -141,7 +141,7 @@ namespace omegaToolkit {
         int getId();
         virtual void layout();
 
-        void setStereo(bool value) { myStereo = value; }
+        void setStereo(bool value) { myStereo = value; invalidate(); }
         bool isStereo() { return myStereo; }
 
         //! Navigation
@@ -162,30 +162,54 @@ namespace omegaToolkit {
 
         virtual void autosize() {}
         virtual void updateSize();
+        //! Layout invalidation
+        //@{
+        //! Call when the widget size constraints change: this widget and its 
+        //! container will recompute their layout. Containers further up only
+        //! revisit this branch, and recompute their own layout only if the 
+        //! size of one of their children changes as a result.
         void requestLayoutRefresh();
+        //! Call when the widget content changes in a way that may change its
+        //! autosize result (i.e. label text): the widget autosizes again, but
+        //! its container layout is recomputed only if the widget size changes.
+        void requestAutosize();
+        //@}
+
+        //! Content tracking
+        //@{
+        //! Marks the widget appearance as changed. Containers that render 
+        //! their content to a texture (3D and pixel output containers) redraw
+        //! it only after one of their children has been invalidated. Widget 
+        //! setters call this already: call it explicitly when a widget 
+        //! appearance changes in some other way.
+        void invalidate();
+        //! Returns a counter incremented every time this widget or any of its
+        //! children is invalidated.
+        uint getContentVersion() { return myContentVersion; }
+        //@}
 
         //! Appearance
         //@{
         void setStyle(const String& style);
         String getStyleValue(const String& key, const String& defaultValue = "");
         void setStyleValue(const String& key, const String& value);
-        void setScale(float value) { myScale = value; }
+        void setScale(float value) { myScale = value; invalidate(); }
         //! Sets the widget scale. Scale controls the visual appearance of a 
         //! widget without changing its actual size or forcing a layout refresh 
         //! of the widget container. Scale is indicated as a proportion of the
         //! current widget size.
         float getScale() { return myScale; }
-        void setAlpha(float value) { myAlpha = value; }
+        void setAlpha(float value) { myAlpha = value; invalidate(); }
         float getAlpha();
-        void setBlendMode(BlendMode value) { myBlendMode = value; }
+        void setBlendMode(BlendMode value) { myBlendMode = value; invalidate(); }
         BlendMode getBlendMode() { return myBlendMode; }
-        void setFillColor(const Color& c) { myFillColor = c; }
-        void setFillEnabled(bool value) { myFillEnabled = value; }
+        void setFillColor(const Color& c) { myFillColor = c; invalidate(); }
+        void setFillEnabled(bool value) { myFillEnabled = value; invalidate(); }
         //! Enables or disables shaders for this widget. Shaders are enabled
         //! by default and are required to correctly render some widget features
         //! like correct transparency. The shader used by the widget can be 
         //! replaced using the setShaderName method.
-        void setShaderEnabled(bool value) { myShaderEnabled = value; }
+        void setShaderEnabled(bool value) { myShaderEnabled = value; invalidate(); }
         bool isShaderEnabled() { return myShaderEnabled; }
         //! Sets the name of the shader used by this widget. The widget will look
         //! for a vertex and a fragment shader with this name. By default, widgets
@@ -197,7 +221,7 @@ namespace omegaToolkit {
         //@}
 
         Layer getLayer() { return myLayer; }
-        void setLayer(Layer layer) { myLayer = layer; }
+        void setLayer(Layer layer) { myLayer = layer; invalidate(); }
 
         //! Returns true if the point is within this widget's bounding box.
         bool hitTest(const Vector2f& point);
@@ -225,12 +249,12 @@ namespace omegaToolkit {
         //! Gets the color used when widget debug mode is enabled.
         Color getDebugColor() { return myDebugModeColor; }
         //! Sets the color used when widget debug mode is enabled.
-        void setDebugColor( omega::Color value ) { myDebugModeColor = value; }
+        void setDebugColor( omega::Color value ) { myDebugModeColor = value; invalidate(); }
         //! Returns true if debug mode is enabled for this widget.
         bool isDebugModeEnabled() { return myDebugModeEnabled; }
         //! Enabled or disabled debug mode for this widget.
         //! When debug mode is enabled, the widget bounding box will be displayed.
-        void setDebugModeEnabled(bool value) { myDebugModeEnabled = value; }
+        void setDebugModeEnabled(bool value) { myDebugModeEnabled = value; invalidate(); }
 
         //@}
     protected:
@@ -250,9 +274,23 @@ namespace omegaToolkit {
         void setContainer(Container* value);
         void dispatchUIEvent(const Event& evt);
 
+        //! Pointer capture
+        //@{
+        //! Widgets call these when they start / stop tracking the pointer 
+        //! outside of their area (i.e. while being dragged). Containers always
+        //! forward pointer events to children that capture the pointer (or
+        //! contain widgets that do), bypassing their hit-testing index.
+        void beginPointerCapture();
+        void endPointerCapture();
+        bool hasPointerCapture() { return myPointerCaptureCount > 0; }
+        //@}
+
         // Menu Widget Sounds
         void playMenuScrollSound();
 
+    private:
+        void updatePointerCapture(int delta);
+
     protected:
         omega::Vector2f myPosition;
         omega::Vector2f mySize;
@@ -287,7 +325,12 @@ namespace omegaToolkit {
         IEventListener* myEventHandler;
         Ref<UiScriptCommand> myUiEventCommand;
 
+        // Layout flags: myNeedLayoutRefresh is set when this widget size or 
+        // layout needs to be recomputed, mySubtreeNeedLayoutRefresh when 
+        // some widget under this one does.
         bool myNeedLayoutRefresh;
+        bool mySubtreeNeedLayoutRefresh;
+        uint myContentVersion;
 
         // Debug mode.
         bool myDebugModeEnabled;
@@ -296,6 +339,8 @@ namespace omegaToolkit {
         bool myPinned;
         bool myDraggable;
         bool myDragging;
+        // Number of pointer captures held by this widget and its children.
+        int myPointerCaptureCount;
         omega::Vector2f myUserMovePosition;
 
         // When true, the widget is visible.
@@ -519,11 +564,18 @@ namespace omegaToolkit {
 
     ///////////////////////////////////////////////////////////////////////////
     inline void Widget::setVisible(bool value) 
-    { myVisible = value; }
+    { 
+        if(myVisible != value)
+        {
+            myVisible = value; 
+            invalidate();
+        }
+    }
 
     ///////////////////////////////////////////////////////////////////////////
     inline void Widget::setActive(bool value) 
     {
+        if(myActive != value) invalidate();
         myActive = value; 
         //if(myActive != value)
         {
@@ -545,9 +597,10 @@ namespace omegaToolkit {
                     value - myPosition);
             }
         }
-        else 
+        else if(myPosition != value)
         {
             myPosition = value; 
+            invalidate();
         }
     }
 
@@ -566,9 +619,10 @@ namespace omegaToolkit {
                 }
             }
         }
-        else
+        else if(myPosition[dimension] != value)
         {
             myPosition[dimension] = value; 
+            invalidate();
         }
     }
 
@@ -578,6 +632,7 @@ namespace omegaToolkit {
         myShaderName = name;
         // Refresh the widget, so its renderables will load the new shader.
         refresh();
+        invalidate();
     }
 
     ///////////////////////////////////////////////////////////////////////////
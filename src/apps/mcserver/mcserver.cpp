@@ -40,13 +40,21 @@ using namespace omega;
 int main(int argc, char** argv)
 {
 	int defaultPort = MissionControlServer::DefaultPort;
+	String aggregateStat;
 
 	libconfig::ArgumentHelper ah;
 	ah.newOptionalInt("port", "port", defaultPort);
+	ah.newNamedString('a', "aggregate", "stat", 
+		"merge the stat streams of connected clients, and report the slowest client according to the specified stat (i.e. 'ctx0 frame')", 
+		aggregateStat);
 	ah.process(argc, argv);
 
 	Ref<MissionControlServer> server = new MissionControlServer();
 	server->setPort(defaultPort);
+	if(!aggregateStat.empty())
+	{
+		server->setStatsAggregator(new StatsAggregator(aggregateStat));
+	}
 	server->initialize();
 	server->start();
 	while(true)
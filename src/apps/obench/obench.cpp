@@ -0,0 +1,639 @@
+/******************************************************************************
+ * THE OMEGA LIB PROJECT
+ *-----------------------------------------------------------------------------
+ * Copyright 2010-2013		Electronic Visualization Laboratory, 
+ *							University of Illinois at Chicago
+ * Authors:										
+ *  Alessandro Febretti		febret@gmail.com
+ *-----------------------------------------------------------------------------
+ * Copyright (c) 2010-2013, Electronic Visualization Laboratory,  
+ * University of Illinois at Chicago
+ * All rights reserved.
+ * Redistribution and use in source and binary forms, with or without modification, 
+ * are permitted provided that the following conditions are met:
+ * 
+ * Redistributions of source code must retain the above copyright notice, this 
+ * list of conditions and the following disclaimer. Redistributions in binary 
+ * form must reproduce the above copyright notice, this list of conditions and 
+ * the following disclaimer in the documentation and/or other materials provided 
+ * with the distribution. 
+ * 
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" 
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO THE 
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE 
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE 
+ * LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL 
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE  GOODS OR 
+ * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER 
+ * CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, 
+ * OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE 
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ *-----------------------------------------------------------------------------
+ *	obench
+ *		Runs repeatable microbenchmarks on the core engine paths (scene
+ *		transforms, ray queries, event dispatch, shared data, image coding,
+ *		ui layout) and prints one machine-readable result per scenario.
+ ******************************************************************************/
+#include <omega.h>
+#include <omegaToolkit.h>
+#include <fstream>
+#include <iostream>
+
+using namespace omega;
+using namespace omegaToolkit;
+using namespace omegaToolkit::ui;
+
+///////////////////////////////////////////////////////////////////////////////
+//! Minimal application used to create a headless engine: benchmarks do not
+//! open a display system or load a configuration.
+class BenchApplication: public ApplicationBase
+{
+public:
+	virtual const char* getName() { return "obench"; }
+	virtual const char* getExecutableName() { return "obench"; }
+	virtual void setExecutableName(const String& name) {}
+};
+
+///////////////////////////////////////////////////////////////////////////////
+//! Base class for benchmark scenarios. setup and teardown are not timed, run
+//! is called once per iteration.
+class Benchmark: public ReferenceType
+{
+public:
+	struct Param { String name; String value; };
+
+public:
+	Benchmark(const String& name, const String& unit): 
+		myItems(0), myName(name), myUnit(unit) {}
+
+	const String& getName() { return myName; }
+	const Vector<Param>& getParams() { return myParams; }
+	//! The number of items (nodes, events, bytes...) processed by a 
+	//! single iteration, and their unit. Used to compute throughput.
+	int getItems() { return myItems; }
+	const String& getUnit() { return myUnit; }
+
+	virtual void setup(Engine* engine) {}
+	virtual void run(int iteration) = 0;
+	virtual void teardown() {}
+
+protected:
+	void addParam(const String& name, int value) 
+	{ addParam(name, boost::lexical_cast<String>(value)); }
+	void addParam(const String& name, const String& value)
+	{ 
+		Param p; p.name = name; p.value = value; 
+		myParams.push_back(p); 
+	}
+
+protected:
+	int myItems;
+
+private:
+	String myName;
+	String myUnit;
+	Vector<Param> myParams;
+};
+
+///////////////////////////////////////////////////////////////////////////////
+//! Updates transforms in a forest of node chains. Deep hierarchies use one
+//! long chain, wide hierarchies use many single nodes under the root.
+class TransformBenchmark: public Benchmark
+{
+public:
+	TransformBenchmark(const String& name, int depth, int width):
+		Benchmark(name, "nodes"), myDepth(depth), myWidth(width)
+	{
+		addParam("depth", depth);
+		addParam("width", width);
+		myItems = depth * width;
+	}
+
+	virtual void setup(Engine* engine)
+	{
+		myRoot = new SceneNode(engine, "benchRoot");
+		for(int i = 0; i < myWidth; i++)
+		{
+			SceneNode* parent = myRoot;
+			for(int j = 0; j < myDepth; j++)
+			{
+				SceneNode* n = new SceneNode(engine);
+				n->setPosition(0.1f, 0.1f, 0);
+				n->yaw(0.01f);
+				parent->addChild(n);
+				parent = n;
+			}
+		}
+		myContext.frameNum = 0;
+		myContext.time = 0;
+		myContext.dt = 0.016f;
+	}
+
+	virtual void run(int iteration)
+	{
+		// Touch the root so the whole hierarchy needs a transform update.
+		myRoot->yaw(0.01f);
+		myContext.frameNum++;
+		myContext.time += myContext.dt;
+		myRoot->update(myContext);
+	}
+
+	virtual void teardown() { myRoot = NULL; }
+
+private:
+	int myDepth;
+	int myWidth;
+	Ref<SceneNode> myRoot;
+	UpdateContext myContext;
+};
+
+///////////////////////////////////////////////////////////////////////////////
+//! A fixed size box, used to give benchmark nodes a bounding volume.
+class BenchBox: public NodeComponent
+{
+public:
+	BenchBox(): myBox(Vector3f(-0.4f, -0.4f, -0.4f), Vector3f(0.4f, 0.4f, 0.4f)) {}
+
+	virtual void update(const UpdateContext& context) {}
+	virtual bool isInitialized() { return true; }
+	virtual void initialize(Engine* server) {}
+	virtual bool hasBoundingBox() { return true; }
+	virtual const AlignedBox3* getBoundingBox() { return &myBox; }
+
+private:
+	AlignedBox3 myBox;
+};
+
+///////////////////////////////////////////////////////////////////////////////
+//! Runs sorted ray queries against a grid of selectable nodes. Each ray runs
+//! along one grid row, and hits all the nodes in it.
+class RayQueryBenchmark: public Benchmark
+{
+public:
+	RayQueryBenchmark(int nodes): Benchmark("ray-query", "nodes"), myNodes(nodes)
+	{
+		addParam("nodes", nodes);
+		myItems = nodes;
+		mySide = (int)ceil(sqrt((float)nodes));
+	}
+
+	virtual void setup(Engine* engine)
+	{
+		myRoot = new SceneNode(engine, "benchRoot");
+		int n = 0;
+		for(int y = 0; y < mySide && n < myNodes; y++)
+		{
+			SceneNode* row = new SceneNode(engine);
+			myRoot->addChild(row);
+			for(int x = 0; x < mySide && n < myNodes; x++, n++)
+			{
+				SceneNode* node = new SceneNode(engine);
+				node->setPosition(x, y, -5);
+				node->setSelectable(true);
+				node->addComponent(new BenchBox());
+				row->addChild(node);
+			}
+		}
+		UpdateContext uc;
+		uc.frameNum = 0; uc.time = 0; uc.dt = 0;
+		myRoot->update(uc);
+		myQuery.setSceneNode(myRoot);
+	}
+
+	virtual void run(int iteration)
+	{
+		float y = iteration % mySide;
+		myQuery.setRay(Ray(Vector3f(-1, y, -5), Vector3f::UnitX()));
+		myQuery.clearResults();
+		myQuery.execute(SceneQuery::QuerySort);
+	}
+
+	virtual void teardown() { myRoot = NULL; }
+
+private:
+	int myNodes;
+	int mySide;
+	Ref<SceneNode> myRoot;
+	RaySceneQuery myQuery;
+};
+
+///////////////////////////////////////////////////////////////////////////////
+class BenchModule: public EngineModule
+{
+public:
+	BenchModule(): myHandled(0) {}
+	virtual void handleEvent(const Event& evt)
+	{
+		if(evt.getServiceType() == Service::Pointer) myHandled++;
+	}
+
+private:
+	int myHandled;
+};
+
+///////////////////////////////////////////////////////////////////////////////
+//! Dispatches pointer events to a set of modules through ModuleServices, 
+//! visiting priorities in the same order the engine does.
+class EventDispatchBenchmark: public Benchmark
+{
+public:
+	EventDispatchBenchmark(int modules, int events): 
+		Benchmark("event-dispatch", "events"), myModules(modules), myEvents(events)
+	{
+		addParam("modules", modules);
+		addParam("events", events);
+		myItems = events;
+	}
+
+	virtual void setup(Engine* engine)
+	{
+		for(int i = 0; i < myModules; i++)
+		{
+			BenchModule* m = new BenchModule();
+			m->setPriority((EngineModule::Priority)(i % (EngineModule::PriorityHighest + 1)));
+			ModuleServices::addModule(m);
+		}
+		// The first update initializes the modules. Only initialized modules
+		// receive events.
+		UpdateContext uc;
+		uc.frameNum = 0; uc.time = 0; uc.dt = 0;
+		ModuleServices::update(engine, uc);
+	}
+
+	virtual void run(int iteration)
+	{
+		Event evt;
+		for(int i = 0; i < myEvents; i++)
+		{
+			evt.reset(Event::Move, Service::Pointer);
+			evt.setPosition(i, iteration);
+			for(int p = EngineModule::PriorityHighest; p >= EngineModule::PriorityLowest; p--)
+			{
+				if(!evt.isProcessed()) ModuleServices::handleEvent(evt, (EngineModule::Priority)p);
+			}
+		}
+	}
+
+	virtual void teardown() { ModuleServices::disposeAll(); }
+
+private:
+	int myModules;
+	int myEvents;
+};
+
+///////////////////////////////////////////////////////////////////////////////
+//! A shared object holding a set of named transforms, similar to what a 
+//! scene replication module sends every frame.
+class BenchSharedObject: public SharedObject
+{
+public:
+	BenchSharedObject(int count)
+	{
+		for(int i = 0; i < count; i++)
+		{
+			myPositions.push_back(Vector3f(i, i * 0.5f, -i));
+			myOrientations.push_back(Quaternion::Identity());
+			myNames.push_back(ostr("node%1%", %i));
+		}
+	}
+
+	virtual void commitSharedData(SharedOStream& out)
+	{
+		int count = myPositions.size();
+		out << count;
+		for(int i = 0; i < count; i++)
+		{
+			out << myPositions[i] << myOrientations[i] << myNames[i];
+		}
+	}
+
+	virtual void updateSharedData(SharedIStream& in)
+	{
+		int count;
+		in >> count;
+		myPositions.resize(count);
+		myOrientations.resize(count);
+		myNames.resize(count);
+		for(int i = 0; i < count; i++)
+		{
+			in >> myPositions[i] >> myOrientations[i] >> myNames[i];
+		}
+	}
+
+private:
+	Vector<Vector3f> myPositions;
+	Vector<Quaternion> myOrientations;
+	Vector<String> myNames;
+};
+
+///////////////////////////////////////////////////////////////////////////////
+//! Serializes a shared object and applies it back, like a master and slave
+//! node pair would do in a cluster frame.
+class SharedDataBenchmark: public Benchmark
+{
+public:
+	SharedDataBenchmark(int objects): Benchmark("shared-data", "bytes"), myObjects(objects)
+	{
+		addParam("objects", objects);
+	}
+
+	virtual void setup(Engine* engine)
+	{
+		myObject = new BenchSharedObject(myObjects);
+		myItems = SharedDataServices::loopbackObject(myObject);
+	}
+
+	virtual void run(int iteration) 
+	{ 
+		SharedDataServices::loopbackObject(myObject); 
+	}
+
+	virtual void teardown() { myObject = NULL; }
+
+private:
+	int myObjects;
+	Ref<BenchSharedObject> myObject;
+};
+
+///////////////////////////////////////////////////////////////////////////////
+//! Encodes or decodes a square rgba image.
+class ImageBenchmark: public Benchmark
+{
+public:
+	ImageBenchmark(const String& name, bool encode, int size, ImageUtils::ImageFormat format):
+		Benchmark(name, "pixels"), myEncode(encode), mySize(size), myFormat(format)
+	{
+		addParam("size", size);
+		addParam("format", format == ImageUtils::FormatPng ? "png" : "jpeg");
+		myItems = size * size;
+	}
+
+	virtual void setup(Engine* engine)
+	{
+		// Fill the image with a gradient and some high frequency detail, so
+		// the encoders do not hit a degenerate case.
+		myPixels = new PixelData(PixelData::FormatRgba, mySize, mySize);
+		byte* p = myPixels->map();
+		for(int y = 0; y < mySize; y++)
+		{
+			for(int x = 0; x < mySize; x++)
+			{
+				*p++ = x * 255 / mySize;
+				*p++ = y * 255 / mySize;
+				*p++ = (x * y) & 0xff;
+				*p++ = 255;
+			}
+		}
+		myPixels->unmap();
+		myEncoded = ImageUtils::encode(myPixels, myFormat);
+	}
+
+	virtual void run(int iteration)
+	{
+		if(myEncode)
+		{
+			Ref<ByteArray> data = ImageUtils::encode(myPixels, myFormat);
+		}
+		else
+		{
+			Ref<PixelData> pixels = ImageUtils::decode(myEncoded->getData(), myEncoded->getSize());
+		}
+	}
+
+	virtual void teardown() { myPixels = NULL; myEncoded = NULL; }
+
+private:
+	bool myEncode;
+	int mySize;
+	ImageUtils::ImageFormat myFormat;
+	Ref<PixelData> myPixels;
+	Ref<ByteArray> myEncoded;
+};
+
+///////////////////////////////////////////////////////////////////////////////
+//! Lays out a vertical container of horizontal rows of widgets. Every 
+//! iteration resizes some widgets and runs a layout pass, touching a single
+//! widget exercises the incremental layout path.
+class UiLayoutBenchmark: public Benchmark
+{
+public:
+	UiLayoutBenchmark(const String& name, int rows, int columns, bool touchAll):
+		Benchmark(name, "widgets"), myRows(rows), myColumns(columns), myTouchAll(touchAll)
+	{
+		addParam("rows", rows);
+		addParam("columns", columns);
+		myItems = rows * columns;
+	}
+
+	virtual void setup(Engine* engine)
+	{
+		myRoot = new Container(engine);
+		myRoot->setLayout(Container::LayoutVertical);
+		for(int i = 0; i < myRows; i++)
+		{
+			Container* row = new Container(engine);
+			row->setLayout(Container::LayoutHorizontal);
+			myRoot->addChild(row);
+			for(int j = 0; j < myColumns; j++)
+			{
+				Widget* w = new Widget(engine);
+				w->setSize(Vector2f(20, 20));
+				row->addChild(w);
+				myWidgets.push_back(w);
+			}
+		}
+		myRoot->updateSize();
+		myRoot->layout();
+	}
+
+	virtual void run(int iteration)
+	{
+		float width = 20 + (iteration % 2) * 10;
+		if(myTouchAll)
+		{
+			foreach(Widget* w, myWidgets) w->setSize(Vector2f(width, 20));
+		}
+		else
+		{
+			myWidgets[iteration % myWidgets.size()]->setSize(Vector2f(width, 20));
+		}
+		myRoot->updateSize();
+		myRoot->layout();
+	}
+
+	virtual void teardown() 
+	{ 
+		myWidgets.clear(); 
+		myRoot = NULL; 
+	}
+
+private:
+	int myRows;
+	int myColumns;
+	bool myTouchAll;
+	Ref<Container> myRoot;
+	Vector< Ref<Widget> > myWidgets;
+};
+
+///////////////////////////////////////////////////////////////////////////////
+struct BenchmarkResult
+{
+	double total;
+	double mean;
+	double min;
+	double median;
+	double max;
+};
+
+///////////////////////////////////////////////////////////////////////////////
+BenchmarkResult runBenchmark(Benchmark* b, Engine* engine, int warmup, int iterations)
+{
+	b->setup(engine);
+	for(int i = 0; i < warmup; i++) b->run(i);
+
+	Vector<double> samples;
+	samples.reserve(iterations);
+	Timer t;
+	t.start();
+	for(int i = 0; i < iterations; i++)
+	{
+		double start = t.getElapsedTimeInMicroSec();
+		b->run(warmup + i);
+		samples.push_back(t.getElapsedTimeInMicroSec() - start);
+	}
+	t.stop();
+	b->teardown();
+
+	BenchmarkResult r;
+	r.total = 0;
+	foreach(double s, samples) r.total += s;
+	std::sort(samples.begin(), samples.end());
+	r.mean = r.total / iterations;
+	r.min = samples.front();
+	r.median = samples[iterations / 2];
+	r.max = samples.back();
+	return r;
+}
+
+///////////////////////////////////////////////////////////////////////////////
+void printResult(std::ostream& out, const String& format, Benchmark* b, int iterations, const BenchmarkResult& r)
+{
+	double throughput = r.median > 0 ? b->getItems() * 1000000.0 / r.median : 0;
+	if(format == "csv")
+	{
+		String params;
+		foreach(const Benchmark::Param& p, b->getParams())
+		{
+			if(!params.empty()) params += " ";
+			params += p.name + "=" + p.value;
+		}
+		out << ostr("%1%,%2%,%3%,%4%,%5%,%6%,%7%,%8%,%9%,%10%",
+			%b->getName() %params %iterations %r.mean %r.min %r.median %r.max
+			%b->getItems() %b->getUnit() %throughput) << std::endl;
+	}
+	else
+	{
+		String params;
+		foreach(const Benchmark::Param& p, b->getParams())
+		{
+			if(!params.empty()) params += ", ";
+			params += ostr("\"%1%\": \"%2%\"", %p.name %p.value);
+		}
+		out << ostr("{\"scenario\": \"%1%\", \"params\": {%2%}, \"iterations\": %3%, "
+			"\"mean_us\": %4%, \"min_us\": %5%, \"median_us\": %6%, \"max_us\": %7%, "
+			"\"items\": %8%, \"unit\": \"%9%\", \"items_per_sec\": %10%}",
+			%b->getName() %params %iterations %r.mean %r.min %r.median %r.max
+			%b->getItems() %b->getUnit() %throughput) << std::endl;
+	}
+}
+
+///////////////////////////////////////////////////////////////////////////////
+int main(int argc, char** argv)
+{
+	String scenarios = "all";
+	String format = "json";
+	String outputFile;
+	String imageFormat = "png";
+	int iterations = 200;
+	int warmup = 20;
+	int depth = 1000;
+	int width = 10000;
+	int nodes = 1024;
+	int modules = 32;
+	int events = 100;
+	int objects = 1000;
+	int imageSize = 512;
+	int widgets = 32;
+	bool list = false;
+	bool verbose = false;
+
+	libconfig::ArgumentHelper ah;
+	ah.newNamedString('s', "scenarios", "names", "comma separated list of scenarios to run (default: all)", scenarios);
+	ah.newNamedInt('n', "iterations", "count", "timed iterations per scenario (default: 200)", iterations);
+	ah.newNamedInt('w', "warmup", "count", "untimed iterations run before timing (default: 20)", warmup);
+	ah.newNamedInt('d', "depth", "count", "node chain length for transform-deep (default: 1000)", depth);
+	ah.newNamedInt('W', "width", "count", "number of root children for transform-wide (default: 10000)", width);
+	ah.newNamedInt('r', "nodes", "count", "selectable nodes for ray-query (default: 1024)", nodes);
+	ah.newNamedInt('m', "modules", "count", "modules for event-dispatch (default: 32)", modules);
+	ah.newNamedInt('e', "events", "count", "events per iteration for event-dispatch (default: 100)", events);
+	ah.newNamedInt('o', "objects", "count", "transforms in the shared-data object (default: 1000)", objects);
+	ah.newNamedInt('i', "image-size", "pixels", "image side for image-encode and image-decode (default: 512)", imageSize);
+	ah.newNamedString('I', "image-format", "format", "image format for image-encode and image-decode: png or jpeg (default: png)", imageFormat);
+	ah.newNamedInt('u', "widgets", "count", "rows and columns of widgets for ui-layout (default: 32)", widgets);
+	ah.newNamedString('f', "format", "format", "result format: json (one object per line) or csv (default: json)", format);
+	ah.newNamedString('O', "output", "file", "write results to a file instead of the standard output", outputFile);
+	ah.newFlag('l', "list", "list the available scenarios and exit", list);
+	ah.newFlag('v', "verbose", "keep the omegalib log enabled", verbose);
+	ah.process(argc, argv);
+
+	if(iterations < 1) iterations = 1;
+
+	ImageUtils::ImageFormat imgfmt = imageFormat == "jpeg" ? ImageUtils::FormatJpeg : ImageUtils::FormatPng;
+
+	List< Ref<Benchmark> > benchmarks;
+	benchmarks.push_back(new TransformBenchmark("transform-deep", depth, 1));
+	benchmarks.push_back(new TransformBenchmark("transform-wide", 1, width));
+	benchmarks.push_back(new RayQueryBenchmark(nodes));
+	benchmarks.push_back(new EventDispatchBenchmark(modules, events));
+	benchmarks.push_back(new SharedDataBenchmark(objects));
+	benchmarks.push_back(new ImageBenchmark("image-encode", true, imageSize, imgfmt));
+	benchmarks.push_back(new ImageBenchmark("image-decode", false, imageSize, imgfmt));
+	benchmarks.push_back(new UiLayoutBenchmark("ui-layout", widgets, widgets, false));
+	benchmarks.push_back(new UiLayoutBenchmark("ui-layout-full", widgets, widgets, true));
+
+	if(list)
+	{
+		foreach(Benchmark* b, benchmarks) std::cout << b->getName() << std::endl;
+		return 0;
+	}
+
+	Vector<String> selected = StringUtils::split(scenarios, ",");
+	bool runAll = (scenarios == "all");
+
+	if(!verbose) ologdisable();
+
+	BenchApplication app;
+	Ref<Engine> engine = new Engine(&app);
+	ImageUtils::internalInitialize();
+
+	std::ofstream file;
+	if(!outputFile.empty()) file.open(outputFile.c_str());
+	std::ostream& out = outputFile.empty() ? std::cout : file;
+
+	if(format == "csv")
+	{
+		out << "scenario,params,iterations,mean_us,min_us,median_us,max_us,items,unit,items_per_sec" << std::endl;
+	}
+
+	foreach(Benchmark* b, benchmarks)
+	{
+		if(runAll || std::find(selected.begin(), selected.end(), b->getName()) != selected.end())
+		{
+			BenchmarkResult r = runBenchmark(b, engine, warmup, iterations);
+			printResult(out, format, b, iterations, r);
+		}
+	}
+
+	ImageUtils::internalDispose();
+	return 0;
+}
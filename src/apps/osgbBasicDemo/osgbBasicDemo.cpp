@@ -26,6 +26,7 @@
 #include <osgbCollision/Utils.h>
 
 #include <btBulletDynamicsCommon.h>
+#include <omegaToolkit/BulletPhysicsModule.h>
 
 #include <string>
 
@@ -167,6 +168,12 @@ public:
 		myOsg = new OsgModule();
 		ModuleServices::addModule(myOsg);
 		myWorld = initBtPhysicsWorld();
+		// Step the world on the master only and replicate it to slaves.
+		// Keep the original demo step: 1/30s per step, run as two 1/60s 
+		// Bullet substeps (the fixed update rate is set in initialize).
+		myPhysics = new BulletPhysicsModule(myWorld);
+		myPhysics->setSubsteps(2);
+		ModuleServices::addModule(myPhysics);
 	}
 
 	virtual void initialize();
@@ -184,6 +191,7 @@ private:
 
 	Ref<OsgModule> myOsg;
 	btDynamicsWorld* myWorld;
+	Ref<BulletPhysicsModule> myPhysics;
 	Ref<SceneNode> mySceneNode;
 	Actor* myInteractor;
 	OsgSceneObject* myOsgSceneObj;
@@ -221,6 +229,8 @@ btDynamicsWorld* OsgbBasicDemo::initBtPhysicsWorld()
 
 void OsgbBasicDemo::initialize()
 {
+	getEngine()->setFixedUpdateRate(30);
+
 	osg::Group* root = new osg::Group;
 
 	//create a few basic rigid bodies
@@ -407,9 +417,6 @@ void OsgbBasicDemo::initialize()
 
 void OsgbBasicDemo::update(const UpdateContext& context)
 {
-	double elapsed = 1./30.;
-	myWorld->stepSimulation( elapsed, 4, elapsed/2. );
-
 	omicron::Vector3f dv (getEngine()->getDefaultCamera()->getDerivedPosition());
 	printf("camera position: %f, %f, %f derived\n", dv.x(), dv.y(), dv.z() );
 	omicron::Vector3f v (getEngine()->getDefaultCamera()->getPosition());
@@ -45,6 +45,7 @@
 #include <osgbCollision/Utils.h>
 
 #include <btBulletDynamicsCommon.h>
+#include <omegaToolkit/BulletPhysicsModule.h>
 
 
 #include <string>
@@ -106,6 +107,10 @@ public:
 		myOsg = new OsgModule();
 		ModuleServices::addModule(myOsg);
 		myWorld = initBtPhysicsWorld();
+		// Step the world on the master only and replicate it to slaves.
+		myPhysics = new BulletPhysicsModule(myWorld);
+		myPhysics->setSubsteps(4);
+		ModuleServices::addModule(myPhysics);
 	}
 
 	virtual btDynamicsWorld* initBtPhysicsWorld();
@@ -116,6 +121,7 @@ public:
 
 private:
 	btDynamicsWorld* myWorld;
+	Ref<BulletPhysicsModule> myPhysics;
 	Ref<OsgModule> myOsg;
 	Ref<SceneNode> mySceneNode;
 	Actor* myInteractor;
@@ -381,10 +387,6 @@ void OsgbDice::update(const UpdateContext& context)
 		die2->getMatrix().getTrans().z());
 	//*/
 
-	double elapsed = 1./60.;
-	myWorld->stepSimulation( elapsed, 4, elapsed/4. );
-	//myWorld->stepSimulation( 1./60., 1, 1./60. );
-	//prevSimTime = currSimTime;
 }
 
 /** \page diceexample The Mandatory Dice Example
@@ -0,0 +1,271 @@
+/******************************************************************************
+ * THE OMEGA LIB PROJECT
+ *-----------------------------------------------------------------------------
+ * Copyright 2010-2013		Electronic Visualization Laboratory, 
+ *							University of Illinois at Chicago
+ * Authors:										
+ *  Alessandro Febretti		febret@gmail.com
+ *-----------------------------------------------------------------------------
+ * Copyright (c) 2010-2013, Electronic Visualization Laboratory,  
+ * University of Illinois at Chicago
+ * All rights reserved.
+ * Redistribution and use in source and binary forms, with or without modification, 
+ * are permitted provided that the following conditions are met:
+ * 
+ * Redistributions of source code must retain the above copyright notice, this 
+ * list of conditions and the following disclaimer. Redistributions in binary 
+ * form must reproduce the above copyright notice, this list of conditions and 
+ * the following disclaimer in the documentation and/or other materials provided 
+ * with the distribution. 
+ * 
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" 
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO THE 
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE 
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE 
+ * LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL 
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE  GOODS OR 
+ * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER 
+ * CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, 
+ * OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE 
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ *-----------------------------------------------------------------------------
+ * What's in this file
+ *	A log listener that moves the cost of log output off the threads that 
+ *  generate it.
+ ******************************************************************************/
+#include "omega/AsyncLogSink.h"
+
+#ifdef OMEGA_OS_WIN
+    #include <windows.h>
+    #define LOG_BARRIER() MemoryBarrier()
+    #define LOG_THREAD_LOCAL __declspec(thread)
+#else
+    #define LOG_BARRIER() __sync_synchronize()
+    #define LOG_THREAD_LOCAL __thread
+#endif
+
+using namespace omega;
+
+AsyncLogSink* AsyncLogSink::mysInstance = NULL;
+
+#ifdef OMEGA_OS_LINUX
+const int AsyncLogSink::RingSize;
+const int AsyncLogSink::WriterInterval;
+#endif
+
+namespace omega {
+///////////////////////////////////////////////////////////////////////////////
+// Single producer / single consumer line buffer. The producer is the thread
+// owning the ring and only writes head and dropped. The consumer is the 
+// writer thread and only writes tail.
+struct LogRing
+{
+    LogRing(): head(0), tail(0), dropped(0), reportedDropped(0) {}
+
+    String lines[AsyncLogSink::RingSize];
+    volatile uint head;
+    volatile uint tail;
+    volatile uint dropped;
+    uint reportedDropped;
+};
+
+///////////////////////////////////////////////////////////////////////////////
+class LogWriterThread: public Thread
+{
+public:
+    LogWriterThread(AsyncLogSink* sink): mySink(sink), myStopRequested(false) {}
+
+    void requestStop() { myStopRequested = true; }
+
+    virtual void threadProc()
+    {
+        while(!myStopRequested)
+        {
+            if(mySink->drain() == 0) osleep(AsyncLogSink::WriterInterval);
+        }
+        // Deliver whatever was left.
+        mySink->drain();
+    }
+
+private:
+    AsyncLogSink* mySink;
+    volatile bool myStopRequested;
+};
+};
+
+// Rings are never deallocated: the threads owning them keep a pointer to
+// them in thread-local storage, and may outlive the sink.
+static LOG_THREAD_LOCAL LogRing* sThreadRing = NULL;
+static Lock sRingsLock;
+static List<LogRing*> sRings;
+
+///////////////////////////////////////////////////////////////////////////////
+void AsyncLogSink::enable()
+{
+    if(mysInstance != NULL) return;
+    mysInstance = new AsyncLogSink();
+    ologaddlistener(mysInstance);
+    mysInstance->myWriter->start();
+}
+
+///////////////////////////////////////////////////////////////////////////////
+void AsyncLogSink::disable()
+{
+    if(mysInstance == NULL) return;
+    AsyncLogSink* sink = mysInstance;
+    ologremlistener(sink);
+
+    // The writer delivers all pending lines before exiting.
+    sink->myWriter->requestStop();
+    sink->myWriter->stop();
+
+    // Listeners still registered go back to synchronous logging.
+    mysInstance = NULL;
+    foreach(ILogListener* l, sink->myListeners) ologaddlistener(l);
+    delete sink;
+}
+
+///////////////////////////////////////////////////////////////////////////////
+void AsyncLogSink::addListener(ILogListener* listener)
+{
+    if(mysInstance == NULL)
+    {
+        ologaddlistener(listener);
+        return;
+    }
+    mysInstance->myListenersLock.lock();
+    mysInstance->myListeners.push_back(listener);
+    mysInstance->myListenersLock.unlock();
+}
+
+///////////////////////////////////////////////////////////////////////////////
+void AsyncLogSink::removeListener(ILogListener* listener)
+{
+    if(mysInstance == NULL)
+    {
+        ologremlistener(listener);
+        return;
+    }
+    // The writer holds the lock while delivering lines, so once we get it
+    // the listener is not in use.
+    mysInstance->myListenersLock.lock();
+    mysInstance->myListeners.remove(listener);
+    mysInstance->myListenersLock.unlock();
+}
+
+///////////////////////////////////////////////////////////////////////////////
+uint AsyncLogSink::getDroppedLines()
+{
+    uint dropped = 0;
+    sRingsLock.lock();
+    foreach(LogRing* ring, sRings) dropped += ring->dropped;
+    sRingsLock.unlock();
+    return dropped;
+}
+
+///////////////////////////////////////////////////////////////////////////////
+AsyncLogSink::AsyncLogSink()
+{
+    myWriter = new LogWriterThread(this);
+}
+
+///////////////////////////////////////////////////////////////////////////////
+AsyncLogSink::~AsyncLogSink()
+{
+    delete myWriter;
+}
+
+///////////////////////////////////////////////////////////////////////////////
+void AsyncLogSink::addLine(const String& line)
+{
+    LogRing* ring = sThreadRing;
+    if(ring == NULL)
+    {
+        // First line logged by this thread: register a ring for it. This is
+        // the only time the producer side takes a lock.
+        ring = new LogRing();
+        sRingsLock.lock();
+        sRings.push_back(ring);
+        sRingsLock.unlock();
+        sThreadRing = ring;
+    }
+
+    uint head = ring->head;
+    if(head - ring->tail >= RingSize)
+    {
+        // The writer is not keeping up: drop the line. The writer will 
+        // report how many lines were lost.
+        ring->dropped++;
+        return;
+    }
+    ring->lines[head % RingSize] = line;
+    // Make sure the line is written before the writer can see it.
+    LOG_BARRIER();
+    ring->head = head + 1;
+}
+
+///////////////////////////////////////////////////////////////////////////////
+int AsyncLogSink::drain()
+{
+    sRingsLock.lock();
+    List<LogRing*> rings = sRings;
+    sRingsLock.unlock();
+
+    myLines.clear();
+    foreach(LogRing* ring, rings)
+    {
+        uint dropped = ring->dropped;
+        if(dropped != ring->reportedDropped)
+        {
+            myLines.push_back(ostr("!AsyncLogSink: %1% log lines dropped", 
+                %(dropped - ring->reportedDropped)));
+            ring->reportedDropped = dropped;
+        }
+
+        uint head = ring->head;
+        // Make sure we read lines after reading the head index.
+        LOG_BARRIER();
+        uint tail = ring->tail;
+        while(tail != head)
+        {
+            String& line = ring->lines[tail % RingSize];
+            myLines.push_back(String());
+            myLines.back().swap(line);
+            tail++;
+        }
+        // Make sure we are done with the slots before the producer reuses 
+        // them.
+        LOG_BARRIER();
+        ring->tail = tail;
+    }
+
+    if(myLines.size() == 0) return 0;
+
+    // Merge runs of identical lines.
+    myListenersLock.lock();
+    int repeats = 0;
+    for(int i = 0; i < myLines.size(); i++)
+    {
+        if(i > 0 && myLines[i] == myLines[i - 1])
+        {
+            repeats++;
+            continue;
+        }
+        if(repeats > 0)
+        {
+            deliver(ostr("(last message repeated %1% times)", %repeats));
+            repeats = 0;
+        }
+        deliver(myLines[i]);
+    }
+    if(repeats > 0) deliver(ostr("(last message repeated %1% times)", %repeats));
+    myListenersLock.unlock();
+
+    return myLines.size();
+}
+
+///////////////////////////////////////////////////////////////////////////////
+void AsyncLogSink::deliver(const String& line)
+{
+    foreach(ILogListener* l, myListeners) l->addLine(line);
+}
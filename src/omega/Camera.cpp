@@ -40,14 +40,76 @@
 #include "omega/Camera.h"
 #include "omega/CameraOutput.h"
 #include "omega/DisplaySystem.h"
+#include "omega/SystemManager.h"
 #include "omega/ModuleServices.h"
 #include "omega/WandCameraController.h"
 #include "omega/GamepadCameraController.h"
 #include "omega/MouseCameraController.h"
 #include "omega/KeyboardMouseCameraController.h"
 
+#ifdef OMEGA_OS_WIN
+    #include <windows.h>
+    #define HEAD_POSE_BARRIER() MemoryBarrier()
+#else
+    #define HEAD_POSE_BARRIER() __sync_synchronize()
+#endif
+
 using namespace omega;
 
+///////////////////////////////////////////////////////////////////////////////
+HeadPoseLatch::HeadPoseLatch()
+{
+    memset(mySlots, 0, sizeof(mySlots));
+}
+
+///////////////////////////////////////////////////////////////////////////////
+void HeadPoseLatch::write(uint64 frameNum, const Vector3f& position, const Quaternion& orientation)
+{
+    Slot& slot = mySlots[frameNum % Size];
+
+    // Mark the slot as being written
+    slot.sequence++;
+    HEAD_POSE_BARRIER();
+
+    slot.frameNum = frameNum;
+    slot.position[0] = position[0];
+    slot.position[1] = position[1];
+    slot.position[2] = position[2];
+    slot.orientation[0] = orientation.w();
+    slot.orientation[1] = orientation.x();
+    slot.orientation[2] = orientation.y();
+    slot.orientation[3] = orientation.z();
+
+    HEAD_POSE_BARRIER();
+    slot.sequence++;
+}
+
+///////////////////////////////////////////////////////////////////////////////
+bool HeadPoseLatch::read(uint64 targetFrame, Vector3f* position, Quaternion* orientation)
+{
+    Slot& slot = mySlots[targetFrame % Size];
+    uint seq;
+    uint64 fn;
+    float p[3];
+    float o[4];
+    do
+    {
+        seq = slot.sequence;
+        HEAD_POSE_BARRIER();
+        fn = slot.frameNum;
+        memcpy(p, slot.position, sizeof(p));
+        memcpy(o, slot.orientation, sizeof(o));
+        HEAD_POSE_BARRIER();
+    } while((seq & 1) || seq != slot.sequence);
+
+    // The slot may be empty, or stamped with an older or newer frame.
+    if(seq == 0 || fn != targetFrame) return false;
+
+    *position = Vector3f(p[0], p[1], p[2]);
+    *orientation = Quaternion(o[0], o[1], o[2], o[3]);
+    return true;
+}
+
 
 ///////////////////////////////////////////////////////////////////////////////
 Camera::Camera(Engine* e, uint flags):
@@ -60,6 +122,9 @@ Camera::Camera(Engine* e, uint flags):
     myTrackerSourceId(-1),
     myHeadOrientation(Quaternion::Identity()),
     myHeadOffset(Vector3f::Zero()),
+    myLateLatchEnabled(false),
+    myLateSampleValid(false),
+    myHeadPosePredictorExternal(false),
     myMask(0),
     myEyeSeparation(0.06f),
     myListener(NULL),
@@ -96,6 +161,21 @@ void Camera::setup(Setting& s)
     
     myTrackerSourceId = Config::getIntValue("trackerSourceId", s, -1);
     if(myTrackerSourceId != -1) myTrackingEnabled = true;
+    myLateLatchEnabled = Config::getBoolValue("lateLatch", s, false);
+
+    // Head pose prediction can be configured in the camera section, or for 
+    // the camera tracker source in the system posePrediction section.
+    String predictorSetting = ostr("config/posePrediction/source%1%", %myTrackerSourceId);
+    if(s.exists("posePrediction"))
+    {
+        myHeadPosePredictor = new PosePredictor();
+        myHeadPosePredictor->setup(s["posePrediction"]);
+    }
+    else if(myTrackerSourceId != -1 && SystemManager::settingExists(predictorSetting))
+    {
+        myHeadPosePredictor = new PosePredictor();
+        myHeadPosePredictor->setup(SystemManager::settingLookup(predictorSetting));
+    }
 
     //setup camera controller.  The camera needs to be setup before this otherwise its values will be rewritten
 
@@ -139,15 +219,66 @@ void Camera::handleEvent(const Event& evt)
         {
             myHeadOffset = evt.getPosition();
             myHeadOrientation = evt.getOrientation();
+            // NOTE: on the master, samples added as late samples in the 
+            // previous frame are skipped by the predictor as duplicates.
+            if(myHeadPosePredictor != NULL && !myHeadPosePredictorExternal)
+            {
+                // Event timestamps are in milliseconds.
+                myHeadPosePredictor->addSample(evt.getTimestamp() / 1000.0, 
+                    myHeadOffset, myHeadOrientation);
+            }
             
             Vector3f dir = myHeadOrientation * -Vector3f::UnitZ();
         }
     }
 }
 
+///////////////////////////////////////////////////////////////////////////////
+void Camera::addLateSample(const Event& evt)
+{
+    if(myTrackingEnabled && myLateLatchEnabled &&
+        evt.getServiceType() == Event::ServiceTypeMocap && evt.getSourceId() == myTrackerSourceId)
+    {
+        myLateSamplePosition = evt.getPosition();
+        myLateSampleOrientation = evt.getOrientation();
+        myLateSampleValid = true;
+        if(myHeadPosePredictor != NULL && !myHeadPosePredictorExternal)
+        {
+            myHeadPosePredictor->addSample(evt.getTimestamp() / 1000.0, 
+                myLateSamplePosition, myLateSampleOrientation);
+        }
+    }
+}
+
+///////////////////////////////////////////////////////////////////////////////
+void Camera::computeLateHeadPose(const UpdateContext& context, Vector3f* position, Quaternion* orientation)
+{
+    if(myHeadPosePredictor == NULL || 
+        !myHeadPosePredictor->predictLate(context, position, orientation))
+    {
+        // Without a predictor, use the newest late sample, or the pose of 
+        // the frame update if there is none.
+        *position = myLateSampleValid ? myLateSamplePosition : myHeadOffset;
+        *orientation = myLateSampleValid ? myLateSampleOrientation : myHeadOrientation;
+    }
+    // Late samples get dispatched to the camera at the next frame.
+    myLateSampleValid = false;
+}
+
+///////////////////////////////////////////////////////////////////////////////
+void Camera::setLatchedHeadPose(uint64 frameNum, const Vector3f& position, const Quaternion& orientation)
+{
+    myHeadPoseLatch.write(frameNum, position, orientation);
+}
+
 ///////////////////////////////////////////////////////////////////////////////
 void Camera::updateTraversal(const UpdateContext& context)
 {
+    if(myHeadPosePredictor != NULL)
+    {
+        myHeadPosePredictor->predict(context, &myHeadOffset, &myHeadOrientation);
+    }
+
     // Update the view transform
     myHeadTransform = AffineTransform3::Identity();
     myHeadTransform.translate(myHeadOffset);
@@ -254,8 +385,26 @@ void Camera::beginDraw(DrawContext& context)
     context.updateViewport();
     //context.updateViewBounds(myViewPosition, myViewSize, canvasSize);
     context.setupInterleaver();
+
+    AffineTransform3 headTransform = myHeadTransform;
+    if(myLateLatchEnabled)
+    {
+        // Use the head pose latched for the frame being drawn. On the 
+        // master, the update thread may already be some frames ahead and 
+        // the head transform may belong to a later frame: the latched pose
+        // is the same on all the nodes drawing this frame.
+        Vector3f headPos;
+        Quaternion headOri;
+        if(myHeadPoseLatch.read(context.frameNum, &headPos, &headOri))
+        {
+            headTransform = AffineTransform3::Identity();
+            headTransform.translate(headPos);
+            headTransform.rotate(headOri);
+        }
+    }
+
     context.updateTransforms(
-        myHeadTransform, myViewTransform, 
+        headTransform, myViewTransform, 
         myEyeSeparation, 
         myNearZ, myFarZ);
 
@@ -38,6 +38,7 @@
 #include "omega/DisplaySystem.h"
 #include "omega/glheaders.h"
 #include "omega/StatsManager.h"
+#include "omega/AsyncLogSink.h"
 
 using namespace omega;
 
@@ -68,14 +69,14 @@ Console::Console():
 	myHeadline = SystemManager::instance()->getApplication()->getName();
 
 	omsg("Console: adding log listener");
-	ologaddlistener(this);
+	AsyncLogSink::addListener(this);
 }
 
 ///////////////////////////////////////////////////////////////////////////////
 Console::~Console()
 {
 	omsg("~Console: removing log listener");
-	ologremlistener(this);
+	AsyncLogSink::removeListener(this);
 }
 
 ///////////////////////////////////////////////////////////////////////////////
@@ -260,6 +261,12 @@ void ConsoleRenderPass::drawLog(Vector2f pos, Vector2f size, const DrawContext&
 	}
 }
 
+///////////////////////////////////////////////////////////////////////////////
+static bool statCostCompare(Stat* a, Stat* b)
+{
+	return a->getAvg() > b->getAvg();
+}
+
 ///////////////////////////////////////////////////////////////////////////////
 void ConsoleRenderPass::drawStats(Vector2f pos, Vector2f size, const DrawContext& context)
 {
@@ -271,25 +278,33 @@ void ConsoleRenderPass::drawStats(Vector2f pos, Vector2f size, const DrawContext
 	float cy = tile->offset.y();
 	pos += Vector2f(cx, cy);
 
+	// Show timing stats sorted by cost, so the most expensive modules and 
+	// script callbacks come first.
+	Vector<Stat*> stats;
+	foreach(Stat* s, sm->getStats())
+	{
+		if(s->getType() == StatsManager::Time && s->isValid()) stats.push_back(s);
+	}
+	std::sort(stats.begin(), stats.end(), statCostCompare);
+	if((int)stats.size() > MaxStatLines) stats.resize(MaxStatLines);
+
+	size[1] = stats.size() * 20 + 20;
 	di->drawRect(pos, size, Color(0,0,0,0.8f));
 
 	pos[1] += 10;
 	
-	foreach(Stat* s, sm->getStats())
+	foreach(Stat* s, stats)
 	{
-		if(s->getType() == StatsManager::Time && s->isValid())
-		{
-			di->drawRect(
-				pos + Vector2f(5, 0),
-				Vector2f(s->getCur(), 16),
-				Color(0.6f, 0.1f, 0.1f));
-
-			di->drawText(s->getName(), 
-				myFont, 
-				pos + Vector2f(5, 0), 
-				Font::HALeft | Font::VAMiddle, Color::White);
-			
-			pos += Vector2f(0, 20);
-		}
+		di->drawRect(
+			pos + Vector2f(5, 0),
+			Vector2f(s->getCur(), 16),
+			Color(0.6f, 0.1f, 0.1f));
+
+		di->drawText(ostr("%1$6.2f %2$6.2f  %3%", %s->getCur() %s->getAvg() %s->getName()), 
+			myFont, 
+			pos + Vector2f(5, 0), 
+			Font::HALeft | Font::VAMiddle, Color::White);
+		
+		pos += Vector2f(0, 20);
 	}
 }
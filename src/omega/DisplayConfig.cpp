@@ -83,6 +83,7 @@ void DisplayConfig::LoadConfig(Setting& scfg, DisplayConfig& cfg)
 
 	cfg.fullscreen = Config::getBoolValue("fullscreen", scfg);
 	cfg.borderless = Config::getBoolValue("borderless", scfg, false);
+	cfg.groupTilesByDevice = Config::getBoolValue("groupTilesByDevice", scfg, false);
 
 	// deprecated
 	cfg.panopticStereoEnabled = Config::getBoolValue("panopticStereoEnabled", scfg);
@@ -97,6 +98,14 @@ void DisplayConfig::LoadConfig(Setting& scfg, DisplayConfig& cfg)
 	cfg.basePort = Config::getIntValue("basePort", scfg);
 
 	cfg.launcherInterval = Config::getIntValue("launcherInterval", scfg, 500);
+	cfg.launcherHandshake = Config::getBoolValue("launcherHandshake", scfg, false);
+	cfg.launcherTimeout = Config::getIntValue("launcherTimeout", scfg, 30000);
+	cfg.launcherHost = Config::getStringValue("launcherHost", scfg, "");
+	cfg.launcherPort = Config::getIntValue("launcherPort", scfg, cfg.basePort - 1);
+
+	cfg.idleMode = Config::getBoolValue("idleMode", scfg, false);
+	cfg.idleTimeout = Config::getFloatValue("idleTimeout", scfg, 5.0f);
+	cfg.idleFrameInterval = Config::getFloatValue("idleFrameInterval", scfg, 1.0f);
 
 	const Setting& sTiles = scfg["tiles"];
 	// Reset number of nodes and tiles. Will count them in the next loop.
@@ -0,0 +1,94 @@
+/******************************************************************************
+ * THE OMEGA LIB PROJECT
+ *-----------------------------------------------------------------------------
+ * Copyright 2010-2013		Electronic Visualization Laboratory, 
+ *							University of Illinois at Chicago
+ * Authors:										
+ *  Alessandro Febretti		febret@gmail.com
+ *-----------------------------------------------------------------------------
+ * Copyright (c) 2010-2013, Electronic Visualization Laboratory,  
+ * University of Illinois at Chicago
+ * All rights reserved.
+ * Redistribution and use in source and binary forms, with or without modification, 
+ * are permitted provided that the following conditions are met:
+ * 
+ * Redistributions of source code must retain the above copyright notice, this 
+ * list of conditions and the following disclaimer. Redistributions in binary 
+ * form must reproduce the above copyright notice, this list of conditions and 
+ * the following disclaimer in the documentation and/or other materials provided 
+ * with the distribution. 
+ * 
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" 
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO THE 
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE 
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE 
+ * LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL 
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE  GOODS OR 
+ * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER 
+ * CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, 
+ * OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE 
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ *-----------------------------------------------------------------------------
+ * What's in this file
+ *	The abstract base class used by display system implementations.
+ ******************************************************************************/
+#include "omega/DisplaySystem.h"
+#include "omega/SystemManager.h"
+
+using namespace omega;
+
+// Start awake: the first frames always draw.
+volatile bool DisplaySystem::mysRedrawRequested = true;
+
+// Time in milliseconds between input polls while the display is idle.
+static const int sIdlePollInterval = 5;
+
+///////////////////////////////////////////////////////////////////////////////
+void DisplaySystem::waitForRedraw()
+{
+    myIdleWaitTime = 0;
+    if(!myDisplayConfig.idleMode) return;
+
+    SystemManager* sys = SystemManager::instance();
+    float t = (float)myIdleTimer.getElapsedTimeInSec();
+    float waitStart = t;
+    if(mysRedrawRequested)
+    {
+        mysRedrawRequested = false;
+        myLastChangeTime = t;
+    }
+    if(t - myLastChangeTime < myDisplayConfig.idleTimeout) return;
+
+    if(!myIdle)
+    {
+        omsg("DisplaySystem: no changes detected, display is idle");
+        myIdle = true;
+    }
+
+    // Keep polling input services while idle: events are left in the
+    // service manager queue, and will be dispatched by the next frame.
+    ServiceManager* sm = sys->getServiceManager();
+    while(!sys->isExitRequested())
+    {
+        sm->poll();
+        t = (float)myIdleTimer.getElapsedTimeInSec();
+        if(mysRedrawRequested || sm->getAvailableEvents() > 0)
+        {
+            mysRedrawRequested = false;
+            myLastChangeTime = t;
+            myIdle = false;
+            // Idle frames advance the frame time normally. The time spent 
+            // waiting for this change does not.
+            myIdleWaitTime = t - waitStart;
+            omsg("DisplaySystem: display is active");
+            return;
+        }
+        if(myDisplayConfig.idleFrameInterval > 0 && 
+            t - myLastIdleFrameTime >= myDisplayConfig.idleFrameInterval)
+        {
+            myLastIdleFrameTime = t;
+            return;
+        }
+        osleep(sIdlePollInterval);
+    }
+}
@@ -35,6 +35,8 @@
 #include "omega/DrawContext.h"
 #include "omega/Renderer.h"
 #include "omega/DisplaySystem.h"
+#include "omega/Engine.h"
+#include "omega/Camera.h"
 #include "omega/glheaders.h"
 
 using namespace omega;
@@ -44,16 +46,28 @@ DrawContext::DrawContext():
     stencilInitialized(false),
     viewMin(0, 0),
     viewMax(1, 1),
+    resolutionScale(1.0f),
+    tileQualityClass(-1),
+    tileResolutionScale(1.0f),
+    tileForceMono(false),
+    tileFrameInterval(1),
+    lastScaledSceneFrame(0),
+    eye(EyeCyclop),
+    task(SceneDrawTask),
+    tile(NULL),
+    drawBuffer(NULL),
+    gpuContext(NULL),
+    renderer(NULL),
     camera(NULL)
 {
 }
 
 ///////////////////////////////////////////////////////////////////////////////
-DisplayTileConfig::StereoMode DrawContext::getCurrentStereoMode()
+DisplayTileConfig::StereoMode DrawContext::getCurrentStereoMode() const
 {
     DisplaySystem* ds = renderer->getDisplaySystem();
     DisplayConfig& dcfg = ds->getDisplayConfig();
-    if(dcfg.forceMono) return DisplayTileConfig::Mono;
+    if(dcfg.forceMono || tileForceMono) return DisplayTileConfig::Mono;
     if(tile->stereoMode == DisplayTileConfig::Default) return dcfg.stereoMode;
     return tile->stereoMode;
 }
@@ -74,16 +88,86 @@ void DrawContext::drawFrame(uint64 frameNum)
     // Clear the active main frame buffer.
     clear();
 
-    if(getCurrentStereoMode() == DisplayTileConfig::Mono)
+    updateTileQuality();
+
+    // With dynamic resolution or reduced tile quality, the scene is drawn 
+    // offscreen at a reduced resolution and upscaled before drawing overlays
+    // at native resolution. Tiles with a reduced update rate redraw their
+    // scene every few frames, and reuse the last scene in between.
+    // Interleaved stereo modes use a stencil mask on the main frame buffer,
+    // so they always draw at native resolution.
+    DisplayTileConfig::StereoMode stereoMode = getCurrentStereoMode();
+    float scale = renderer->getSceneResolutionScale(*this);
+    bool scaled = (scale < 1.0f || tileFrameInterval > 1) && 
+        (stereoMode == DisplayTileConfig::Mono || stereoMode == DisplayTileConfig::SideBySide);
+    bool drawScene = !scaled || lastScaledSceneFrame == 0 ||
+        frameNum - lastScaledSceneFrame >= tileFrameInterval;
+    if(!scaled) lastScaledSceneFrame = 0;
+    else if(drawScene) lastScaledSceneFrame = frameNum;
+
+    // Count the pixels saved with respect to drawing the scene at full 
+    // quality.
+    uint64 tilePixels = (uint64)tile->pixelSize[0] * tile->pixelSize[1];
+    int eyes = (stereoMode == DisplayTileConfig::Mono) ? 1 : 2;
+    // Tiles forced to mono would draw both eyes at full quality.
+    uint64 fullPixels = tilePixels * (tileForceMono ? 2 : eyes);
+    uint64 drawnPixels = tilePixels * eyes;
+    if(scaled) drawnPixels = drawScene ? (uint64)(drawnPixels * scale * scale) : 0;
+    renderer->addSavedPixels(fullPixels - drawnPixels);
+
+    if(stereoMode == DisplayTileConfig::Mono)
     {
         eye = DrawContext::EyeCyclop;
         // Draw scene
         task = DrawContext::SceneDrawTask;
-        renderer->draw(*this);
+        if(!scaled)
+        {
+            renderer->draw(*this);
+        }
+        else if(drawScene)
+        {
+            renderer->beginScaledSceneDraw(*this, scale);
+            renderer->draw(*this);
+            renderer->endScaledSceneDraw(*this);
+        }
+        else
+        {
+            renderer->drawScaledScene(*this);
+        }
         // Draw overlay
         task = DrawContext::OverlayDrawTask;
         renderer->draw(*this);
     }
+    else if(scaled)
+    {
+        // Draw both eye scenes to the scaled target first, then the eye 
+        // overlays on the main frame buffer.
+        task = DrawContext::SceneDrawTask;
+        if(drawScene)
+        {
+            renderer->beginScaledSceneDraw(*this, scale);
+            eye = DrawContext::EyeLeft;
+            renderer->draw(*this);
+            eye = DrawContext::EyeRight;
+            renderer->draw(*this);
+            renderer->endScaledSceneDraw(*this);
+        }
+        else
+        {
+            renderer->drawScaledScene(*this);
+        }
+
+        task = DrawContext::OverlayDrawTask;
+        eye = DrawContext::EyeLeft;
+        renderer->draw(*this);
+        eye = DrawContext::EyeRight;
+        renderer->draw(*this);
+
+        // Draw mono overlay
+        eye = DrawContext::EyeCyclop;
+        task = DrawContext::OverlayDrawTask;
+        renderer->draw(*this);
+    }
     else
     {
         // Draw left eye scene and overlay
@@ -119,6 +203,41 @@ void DrawContext::drawFrame(uint64 frameNum)
     renderer->finishFrame(curFrame);
 }
 
+///////////////////////////////////////////////////////////////////////////////
+void DrawContext::updateTileQuality()
+{
+    int previousClass = tileQualityClass;
+    TileQualityPolicy* tqp = renderer->getTileQualityPolicy();
+    if(tqp == NULL || !tqp->isEnabled())
+    {
+        tileQualityClass = -1;
+    }
+    else
+    {
+        Camera* cam = renderer->getEngine()->getDefaultCamera();
+        tileQualityClass = tqp->classifyTile(tile, 
+            cam->getHeadOffset(), cam->getHeadOrientation(), 
+            tileQualityClass);
+    }
+    // The last scaled scene is not valid anymore if the tile changed class.
+    if(tileQualityClass != previousClass) lastScaledSceneFrame = 0;
+
+    tileResolutionScale = 1.0f;
+    tileForceMono = false;
+    tileFrameInterval = 1;
+    if(tileQualityClass != -1)
+    {
+        const TileQualityPolicy::QualityClass& qc = tqp->getClass(tileQualityClass);
+        tileResolutionScale = qc.resolutionScale;
+        tileFrameInterval = qc.frameInterval;
+        // Mono only applies to stereo tiles. Side-by-side tiles always need 
+        // an image for each eye.
+        DisplayTileConfig::StereoMode mode = getCurrentStereoMode();
+        tileForceMono = qc.mono && 
+            mode != DisplayTileConfig::Mono && mode != DisplayTileConfig::SideBySide;
+    }
+}
+
 ///////////////////////////////////////////////////////////////////////////////
 void DrawContext::clear()
 {
@@ -188,6 +307,17 @@ void DrawContext::updateViewport()
     {
         viewport = Rect(pvpx, pvpy, pvpw, pvph);
     }
+
+    // Scenes drawn at reduced resolution use a scaled viewport on the 
+    // renderer offscreen scene target.
+    if(task == DrawContext::SceneDrawTask && resolutionScale != 1.0f)
+    {
+        viewport = Rect(
+            (int)(viewport.x() * resolutionScale), 
+            (int)(viewport.y() * resolutionScale), 
+            (int)(viewport.width() * resolutionScale), 
+            (int)(viewport.height() * resolutionScale));
+    }
 }
 
 ///////////////////////////////////////////////////////////////////////////////
@@ -37,6 +37,7 @@
 #include "omega/Texture.h"
 #include "omega/glheaders.h"
 #include "omega/SystemManager.h"
+#include "omega/ResourceCache.h"
 
 #include "FTGL/ftgl.h"
 
@@ -400,20 +401,24 @@ void DrawInterface::drawWireSphere(const Color& color, int segments, int slices)
 ///////////////////////////////////////////////////////////////////////////////
 Font* DrawInterface::createFont(omega::String fontName, omega::String filename, int size)
 {
-	Font::lock();
-	String fontPath;
-	if(!DataManager::findFile(filename, fontPath))
+	// Font files are shared by all renderers through the resource cache, so 
+	// each file is read from disk only once.
+	const byte* fontData;
+	size_t fontDataSize;
+	if(!ResourceCache::getFileData(filename, &fontData, &fontDataSize))
 	{
 		ofwarn("DrawInterface::createFont: could not find font file %1%", %filename);
 		return NULL;
 	}
 
-	FTFont* fontImpl = new FTTextureFont(fontPath.c_str());
+	Font::lock();
+	FTFont* fontImpl = new FTTextureFont(fontData, fontDataSize);
 
 	if(fontImpl->Error())
 	{
 		ofwarn("Font %1% failed to open", %filename);
 		delete fontImpl;
+		Font::unlock();
 		return NULL;
 	}
 
@@ -421,6 +426,8 @@ Font* DrawInterface::createFont(omega::String fontName, omega::String filename,
 	{
 		ofwarn("Font %1% failed to set size %2%", %filename %size);
 		delete fontImpl;
+		Font::unlock();
+		return NULL;
 	}
 
 	Font* font = new Font(fontImpl);
@@ -555,14 +562,15 @@ GLuint DrawInterface::getOrCreateProgram(
 	// If the program is already in the cache, return it.
 	if(myPrograms.find(name) != myPrograms.end()) return myPrograms[name];
 
-	//! Program is not in the cache. Let's create it now.
-	String vertexShaderSource = DataManager::readTextFile(vertexShaderFile);
+	//! Program is not in the cache. Let's create it now. Shader sources are
+	//! shared by all renderers through the resource cache.
+	String vertexShaderSource = ResourceCache::getTextFile(vertexShaderFile);
 	if(vertexShaderSource.empty())
 	{
 		ofwarn("DrawInterface::getOrCreateProgram: source file %1% not found or empty", %vertexShaderFile);
 		return 0;
 	}
-	String fragmentShaderSource = DataManager::readTextFile(fragmentShaderFile);
+	String fragmentShaderSource = ResourceCache::getTextFile(fragmentShaderFile);
 	if(fragmentShaderSource.empty())
 	{
 		ofwarn("DrawInterface::getOrCreateProgram: source file %1% not found or empty", %fragmentShaderFile);
@@ -40,10 +40,13 @@
 #include "omega/SystemManager.h"
 #include "omega/DisplaySystem.h"
 #include "omega/ImageUtils.h"
+#include "omega/ResourceCache.h"
 #include "omega/SystemManager.h"
 #include "omega/PythonInterpreter.h"
 #include "omega/CameraController.h"
 #include "omega/Console.h"
+#include "omega/SceneReplicationModule.h"
+#include "omega/FrameArena.h"
 
 using namespace omega;
 
@@ -85,7 +88,13 @@ Engine::Engine(ApplicationBase* app):
     myDrawPointers(false),
     myPrimaryButton(Event::Button3),
     myEventDispatchEnabled(true),
-    soundEnv(NULL)
+    soundEnv(NULL),
+    myFixedUpdateRate(60),
+    myMaxFixedUpdatesPerFrame(4),
+    myFixedTimeAccumulator(0),
+    myFixedUpdateAlpha(1),
+    myFixedTime(0),
+    myFixedUpdateCount(0)
 {
     mysInstance = this;
 }
@@ -100,6 +109,7 @@ Engine::~Engine()
 void Engine::initialize()
 {
     myLock.lock();
+    getSystemManager()->beginStartupPhase("engine initialize");
     ImageUtils::internalInitialize();
 
     ModuleServices::addModule(new EventSharingModule());
@@ -135,6 +145,30 @@ void Engine::initialize()
         }
     }
 
+    // Start preloading shared resources. Files are loaded on background 
+    // threads while the rest of the engine and the renderers get initialized. 
+    // Renderers then pick the default font and shader sources from the 
+    // resource cache instead of reading them from disk each.
+    if(myDefaultFont.filename != "") ResourceCache::preloadFile(myDefaultFont.filename);
+    if(syscfg->exists("config/preload"))
+    {
+        ResourceCache::preload(syscfg->lookup("config/preload"));
+    }
+    if(cfg != syscfg && cfg->exists("config/preload"))
+    {
+        ResourceCache::preload(cfg->lookup("config/preload"));
+    }
+
+    // Setup the compressed texture cache
+    if(syscfg->exists("config/textureCache"))
+    {
+        Setting& s = syscfg->lookup("config/textureCache");
+        if(Config::getBoolValue("enabled", s, true))
+        {
+            ImageUtils::enableTextureCache(Config::getStringValue("path", s, "texcache"));
+        }
+    }
+
     // Read draw pointers option.
     myDrawPointers = syscfg->getBoolValue("config/drawPointers", myDrawPointers);
     myPointerSize = Config::getIntValue("pointerSize", syscfgroot, 32);
@@ -177,6 +211,8 @@ void Engine::initialize()
     // Load sound config from system config file
     // On distributed systems, this is executed only on the master node
     soundEnabled = false;
+    soundReady = false;
+    soundServerState = SoundServerDisabled;
     if(SystemManager::instance()->isMaster())
     {
         if(syscfg->exists("config/sound"))
@@ -190,42 +226,19 @@ void Engine::initialize()
             float volumeScale = Config::getFloatValue("volumeScale", s, 0.5);
             bool soundDebug = Config::getBoolValue("debug", s, false);
 
-            // Config in seconds, function below in milliseconds
-            soundServerCheckDelay = Config::getFloatValue("soundServerReconnectDelay", s, 5) * 1000;
+            // Interval between sound server connection attempts, in seconds.
+            soundServerCheckDelay = Config::getFloatValue("soundServerReconnectDelay", s, 5);
 
             soundManager = new SoundManager(soundServerIP,soundServerPort);
             soundEnv = soundManager->getSoundEnvironment();
             soundManager->startSoundServer();
             soundManager->showDebugInfo(soundDebug);
 
-            ofmsg("Engine: Checking if sound server is ready at %1% on port %2%... (Waiting for %3% seconds)", %soundServerIP %soundServerPort %(soundServerCheckDelay/1000));
-
-            bool serverReady = true;
-            timeb tb;
-            ftime( &tb );
-            int curTime = tb.millitm + (tb.time & 0xfffff) * 1000;
-            lastSoundServerCheck = curTime;
-
-            while( !soundManager->isSoundServerRunning() )
-            {
-                timeb tb;
-                ftime( &tb );
-                curTime = tb.millitm + (tb.time & 0xfffff) * 1000;
-                int timeSinceLastCheck = curTime-lastSoundServerCheck;
-
-                //soundManager->startSoundServer();
-                if( timeSinceLastCheck > soundServerCheckDelay )
-                {
-                    omsg("Engine: Failed to start sound server. Sound disabled.");
-                    serverReady = false;
-                    break;
-                }
-            }
-
-            if( serverReady )
-            {
-                initializeSound();
-            }
+            // Do not wait for the sound server here: Engine::update checks for 
+            // it and finishes sound initialization whenever the server answers.
+            ofmsg("Engine: Waiting for sound server at %1% on port %2% (retry every %3% seconds)", %soundServerIP %soundServerPort %soundServerCheckDelay);
+            lastSoundServerCheck = 0;
+            soundServerState = SoundServerConnecting;
         }
         else
         {
@@ -253,6 +266,14 @@ void Engine::initialize()
         }
     }
 
+    // Load fixed timestep simulation settings
+    if(syscfg->exists("config/fixedTimestep"))
+    {
+        Setting& s = syscfg->lookup("config/fixedTimestep");
+        setFixedUpdateRate(Config::getFloatValue("rate", s, myFixedUpdateRate));
+        myMaxFixedUpdatesPerFrame = Config::getIntValue("maxUpdatesPerFrame", s, myMaxFixedUpdatesPerFrame);
+    }
+
     // Load input mapping
     if(syscfg->exists("config/inputMap"))
     {
@@ -271,6 +292,13 @@ void Engine::initialize()
 
     Setting& scfg = cfg->lookup("config");
     myEventSharingEnabled = Config::getBoolValue("enableEventSharing", scfg, true);
+
+    // Scene replication lets master-only code move scene nodes.
+    if(Config::getBoolValue("sceneReplication", syscfgroot, false) ||
+        Config::getBoolValue("sceneReplication", scfg, false))
+    {
+        SceneReplicationModule::enable();
+    }
     
     sDeathSwitchTimeout = Config::getIntValue("deathSwitchTimeout", syscfgroot, sDeathSwitchTimeout);
     ofmsg("Death switch timeout: %1% seconds", %sDeathSwitchTimeout);
@@ -291,7 +319,10 @@ void Engine::initialize()
     myUpdateTimeStat = sm->createStat("Engine update", StatsManager::Time);
     mySceneUpdateTimeStat = sm->createStat("Scene transform update", StatsManager::Time);
     myModuleUpdateTimeStat = sm->createStat("Modules update", StatsManager::Time);
+    myFixedUpdateTimeStat = sm->createStat("Modules fixed update", StatsManager::Time);
+    myFixedUpdateCountStat = sm->createStat("Fixed updates per frame", StatsManager::Count1);
 
+    getSystemManager()->endStartupPhase("engine initialize");
     myLock.unlock();
 }
 
@@ -306,6 +337,7 @@ void Engine::dispose()
         sDeathSwitchThread = NULL;
     }
 
+    ResourceCache::internalDispose();
     ImageUtils::internalDispose();
     ModuleServices::disposeAll();
 
@@ -315,11 +347,21 @@ void Engine::dispose()
     // Clear renderer list.
     myClients.clear();
 
+    // Nodes still alive after this point (i.e. referenced from scripts) must
+    // not unregister from a disposed engine.
+    foreach(SceneNode* node, myInterpolatedNodes)
+    {
+        node->myTransformInterpolationEnabled = false;
+    }
+    myInterpolatedNodes.clear();
+
     // Clear root scene node.
     myScene = NULL;
 
     ofmsg("Engine::dispose: cleaning up %1% cameras", %myCameras.size());
+    myCamerasLock.lock();
     myCameras.clear();
+    myCamerasLock.unlock();
     myDefaultCamera = NULL;
 }
 
@@ -458,6 +500,11 @@ void Engine::update(const UpdateContext& context)
 {
     myUpdateTimeStat->startTiming();
 
+    // Start a new frame for the main thread transient allocations, and report
+    // the allocations made during the previous frame.
+    FrameArena::reset();
+    FrameArena::updateStats();
+
     // Create the death switch thread if it does not exist yet
     if(sDeathSwitchThread == NULL)
     {
@@ -476,15 +523,125 @@ void Engine::update(const UpdateContext& context)
     // Then run update on modules
     myModuleUpdateTimeStat->startTiming();
     ModuleServices::update(this, context);
-    myUpdateTimeStat->stopTiming();
+    myModuleUpdateTimeStat->stopTiming();
+
+    // Run simulation steps at the fixed update rate.
+    fixedUpdate(context);
+
+    // On the master, replicated scene nodes changed during this frame are
+    // displayed as sent to slaves, and show their changes from the next one.
+    SceneReplicationModule::applyCommittedState();
     
     // Run update on the scene graph.
     mySceneUpdateTimeStat->startTiming();
     myScene->update(context);
     mySceneUpdateTimeStat->stopTiming();
 
-    // Process sound / reconnect to sound server (if sound is enabled in config and failed on init)
-    if( soundEnv != NULL && soundManager->isSoundServerRunning() )
+    updateSound(context);
+
+    myUpdateTimeStat->stopTiming();
+}
+
+///////////////////////////////////////////////////////////////////////////////
+void Engine::fixedUpdate(const UpdateContext& context)
+{
+    myFixedUpdateTimeStat->startTiming();
+
+    float step = 1.0f / myFixedUpdateRate;
+    myFixedTimeAccumulator += context.dt;
+
+    UpdateContext fixedContext;
+    fixedContext.dt = step;
+
+    int updates = 0;
+    while(myFixedTimeAccumulator >= step && updates < myMaxFixedUpdatesPerFrame)
+    {
+        // Put interpolated nodes back to their last simulated transform, so
+        // fixed update code does not see the interpolated one.
+        foreach(SceneNode* node, myInterpolatedNodes) node->beginFixedUpdate();
+
+        myFixedTime += step;
+        fixedContext.time = myFixedTime;
+        fixedContext.frameNum = myFixedUpdateCount++;
+        ModuleServices::fixedUpdate(fixedContext);
+
+        foreach(SceneNode* node, myInterpolatedNodes) node->endFixedUpdate();
+
+        myFixedTimeAccumulator -= step;
+        updates++;
+    }
+
+    // We could not keep up: drop the simulation time we could not run, 
+    // instead of accumulating it and making the next frames even slower.
+    if(myFixedTimeAccumulator >= step) myFixedTimeAccumulator = fmod(myFixedTimeAccumulator, step);
+
+    myFixedUpdateAlpha = myFixedTimeAccumulator / step;
+    foreach(SceneNode* node, myInterpolatedNodes) 
+    {
+        node->interpolateTransform(myFixedUpdateAlpha);
+    }
+
+    myFixedUpdateCountStat->addSample(updates);
+    myFixedUpdateTimeStat->stopTiming();
+}
+
+///////////////////////////////////////////////////////////////////////////////
+void Engine::setFixedUpdateRate(float value)
+{
+    if(value <= 0)
+    {
+        ofwarn("Engine::setFixedUpdateRate: invalid rate %1%, ignoring", %value);
+        return;
+    }
+    myFixedUpdateRate = value;
+}
+
+///////////////////////////////////////////////////////////////////////////////
+void Engine::addInterpolatedNode(SceneNode* node)
+{
+    myInterpolatedNodes.push_back(node);
+}
+
+///////////////////////////////////////////////////////////////////////////////
+void Engine::removeInterpolatedNode(SceneNode* node)
+{
+    myInterpolatedNodes.remove(node);
+}
+
+///////////////////////////////////////////////////////////////////////////////
+void Engine::updateSound(const UpdateContext& context)
+{
+    // Sound server connection state machine. Startup never waits for the 
+    // sound server: sound becomes available whenever the server answers, and
+    // we go back to connecting if the server goes away.
+    if(soundServerState == SoundServerConnecting)
+    {
+        if(soundManager->isSoundServerRunning())
+        {
+            initializeSound();
+            soundServerState = SoundServerReady;
+        }
+        else if(context.time - lastSoundServerCheck > soundServerCheckDelay)
+        {
+            // Print a message only on the first retry, to avoid spamming the
+            // log when no sound server is running.
+            if(lastSoundServerCheck == 0)
+            {
+                omsg("Engine: Sound server not ready. Sound disabled until the server answers.");
+            }
+            soundManager->startSoundServer();
+            lastSoundServerCheck = context.time;
+        }
+    }
+    else if(soundServerState == SoundServerReady && !soundManager->isSoundServerRunning())
+    {
+        omsg("Engine: Lost connection to sound server. Reconnecting.");
+        soundReady = false;
+        soundServerState = SoundServerConnecting;
+        lastSoundServerCheck = context.time;
+    }
+
+    if(soundServerState == SoundServerReady)
     {
         // Processing messages from sound server
         soundManager->poll();
@@ -496,8 +653,6 @@ void Engine::update(const UpdateContext& context)
         // Update the user position with the head tracker's position
         soundEnv->setUserPosition( getDefaultCamera()->getHeadOffset() );
     }
-
-    myUpdateTimeStat->stopTiming();
 }
 
 ///////////////////////////////////////////////////////////////////////////////
@@ -524,7 +679,11 @@ void Engine::initializeSound()
         int assetCachePort = Config::getIntValue("assetCachePort", s, 22500);
 
         soundManager->setAssetCacheEnabled(assetCacheEnabled);
-        soundManager->getAssetCacheManager()->addCacheHost(soundServerIP);
+        if(soundCacheHost != soundServerIP)
+        {
+            soundManager->getAssetCacheManager()->addCacheHost(soundServerIP);
+            soundCacheHost = soundServerIP;
+        }
         soundManager->getAssetCacheManager()->setCachePort(assetCachePort);
 
         soundManager->setServerVolume( Config::getIntValue("soundServerVolume", s, -16) );
@@ -566,7 +725,9 @@ Camera* Engine::createCamera(uint flags)
     Camera* cam = new Camera(this, flags);
     // By default attach camera to scene root.
     myScene->addChild(cam);
+    myCamerasLock.lock();
     myCameras.push_back(cam);
+    myCamerasLock.unlock();
     return cam;
 }
 
@@ -574,7 +735,9 @@ Camera* Engine::createCamera(uint flags)
 void Engine::destroyCamera(Camera* cam)
 {
     oassert(cam != NULL);
+    myCamerasLock.lock();
     myCameras.remove(cam);
+    myCamerasLock.unlock();
     //delete cam;
 }
 
@@ -589,33 +752,61 @@ Camera* Engine::createCamera(const String& name, uint flags)
 ///////////////////////////////////////////////////////////////////////////////
 Camera* Engine::getCamera(const String& name)
 {
+    Camera* result = NULL;
+    myCamerasLock.lock();
     foreach(Camera* cam, myCameras)
     {
-        if(cam->getName() == name) return cam;
+        if(cam->getName() == name)
+        {
+            result = cam;
+            break;
+        }
     }
-    return NULL;
+    myCamerasLock.unlock();
+    return result;
 }
 
 ///////////////////////////////////////////////////////////////////////////////
 Camera* Engine::getCameraById(int id)
 {
+    Camera* result = NULL;
+    myCamerasLock.lock();
     foreach(Camera* cam, myCameras)
     {
-        if(cam->getCameraId() == id) return cam;
+        if(cam->getCameraId() == id)
+        {
+            result = cam;
+            break;
+        }
     }
-    return NULL;
+    myCamerasLock.unlock();
+    return result;
 }
 
 ///////////////////////////////////////////////////////////////////////////////
 Engine::CameraCollection Engine::getCameras()
 {
-    return myCameras;
+    myCamerasLock.lock();
+    CameraCollection cameras = myCameras;
+    myCamerasLock.unlock();
+    return cameras;
 }
 
 ///////////////////////////////////////////////////////////////////////////////
 Engine::CameraCollection Engine::getCameras() const
 {
-    return myCameras;
+    myCamerasLock.lock();
+    CameraCollection cameras = myCameras;
+    myCamerasLock.unlock();
+    return cameras;
+}
+
+///////////////////////////////////////////////////////////////////////////////
+void Engine::getCameras(FrameVector< Ref<Camera> >::Type& cameras) const
+{
+    myCamerasLock.lock();
+    cameras.assign(myCameras.begin(), myCameras.end());
+    myCamerasLock.unlock();
 }
 
 ///////////////////////////////////////////////////////////////////////////////
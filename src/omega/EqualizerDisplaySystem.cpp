@@ -42,6 +42,7 @@
 #include "omega/EqualizerDisplaySystem.h"
 #include "omega/SystemManager.h"
 #include "omega/MouseService.h"
+#include "omega/MissionControl.h"
 
 using namespace omega;
 using namespace co::base;
@@ -60,13 +61,99 @@ void exitConfig()
 	ds->exitConfig();
 }
 
+///////////////////////////////////////////////////////////////////////////////
+// Runs on the master node during cluster startup. Receives node ready 
+// messages from launched nodes and records their time to ready.
+class NodeLauncherServer: public TcpServer, public IMissionControlMessageHandler
+{
+public:
+	NodeLauncherServer()
+	{
+		myTimer.start();
+	}
+
+	virtual TcpConnection* createConnection(const ConnectionInfo& ci)
+	{
+		MissionControlConnection* conn = new MissionControlConnection(ci, this, NULL);
+		myConnections.push_back(conn);
+		return conn;
+	}
+
+	//! Closes all the node connections. Called when the handshake is over,
+	//! whether all the nodes reported ready or not.
+	void closeConnections()
+	{
+		foreach(MissionControlConnection* conn, myConnections)
+		{
+			if(conn->getState() == TcpConnection::ConnectionOpen) conn->close();
+		}
+		myConnections.clear();
+	}
+
+	virtual bool handleMessage(
+		MissionControlConnection* sender, 
+		const char* header, char* data, int size)
+	{
+		if(!strncmp(header, MissionControlMessageIds::NodeReady, 4))
+		{
+			// Node names are in the hostname:port format. Ignore malformed
+			// messages.
+			String name = data;
+			Vector<String> args = StringUtils::split(name, ":");
+			try
+			{
+				if(args.size() != 2) throw boost::bad_lexical_cast();
+				boost::lexical_cast<int>(args[1]);
+			}
+			catch(boost::bad_lexical_cast&)
+			{
+				ofwarn("NodeLauncherServer: invalid node ready message (%1%)", %name);
+				return true;
+			}
+			myReadyNodes[name] = myTimer.getElapsedTimeInMilliSec();
+			return true;
+		}
+		return false;
+	}
+
+	double getElapsedTime() { return myTimer.getElapsedTimeInMilliSec(); }
+	Dictionary<String, double>& getReadyNodes() { return myReadyNodes; }
+
+private:
+	Timer myTimer;
+	// Time to ready for each node, in milliseconds.
+	Dictionary<String, double> myReadyNodes;
+	List< Ref<MissionControlConnection> > myConnections;
+};
+
+///////////////////////////////////////////////////////////////////////////////
+// Equalizer client used on slave nodes. Render clients run their command loop
+// from initLocal, once the node listener is up: tell the master launcher the
+// node is ready right before entering the loop.
+class NodeClient: public eq::Client
+{
+public:
+	NodeClient(EqualizerDisplaySystem* ds): myDisplaySystem(ds) {}
+
+protected:
+	virtual void clientLoop()
+	{
+		myDisplaySystem->signalNodeReady();
+		eq::Client::clientLoop();
+	}
+
+private:
+	EqualizerDisplaySystem* myDisplaySystem;
+};
+
 ///////////////////////////////////////////////////////////////////////////////
 EqualizerDisplaySystem::EqualizerDisplaySystem():
 	mySys(NULL),
 	myConfig(NULL),
 	myNodeFactory(NULL),
 	mySetting(NULL),
-	myDebugMouse(false)
+	myDebugMouse(false),
+	myNumEqNodes(0)
 {
 }
 
@@ -110,6 +197,7 @@ void EqualizerDisplaySystem::generateEqConfig()
 	// multiple shared data messages sent to slave nodes before they initialize their local objects
 	result += L(ostr("latency %1%", %eqcfg.latency));
 
+	myNumEqNodes = 0;
 	for(int n = 0; n < eqcfg.numNodes; n++)
 	{
 		DisplayNodeConfig& nc = eqcfg.nodes[n];
@@ -117,6 +205,7 @@ void EqualizerDisplaySystem::generateEqConfig()
 		bool enabled = false;
 		for(int i = 0; i < nc.numTiles; i++) enabled |= nc.tiles[i]->enabled;
 		if(!enabled) continue;
+		myNumEqNodes++;
 
 		if(nc.isRemote)
 		{
@@ -144,23 +233,54 @@ void EqualizerDisplaySystem::generateEqConfig()
 
 		int curDevice = -1;
 
-		// Write pipes section
-		for(int i = 0; i < nc.numTiles; i++)
+		// Collect the enabled tiles in pipe order. A new pipe is opened every
+		// time the tile device changes. When groupTilesByDevice is set, all 
+		// tiles on the same device go in a single pipe, even when they are not
+		// listed consecutively: windows on a pipe share one gpu context, so 
+		// textures and other gpu resources are uploaded once per device.
+		Vector<DisplayTileConfig*> pipeTiles;
+		if(eqcfg.groupTilesByDevice)
 		{
-			DisplayTileConfig& tc = *nc.tiles[i];
-			if(tc.enabled)
+			Vector<int> devices;
+			for(int i = 0; i < nc.numTiles; i++)
 			{
-				winX = tc.position[0] + eqcfg.windowOffset[0];
-				winY = tc.position[1] + eqcfg.windowOffset[1];
-			
-				String tileName = tc.name;
-				String tileCfg = buildTileConfig(indent, tileName, winX, winY, tc.pixelSize[0], tc.pixelSize[1], tc.device, curDevice, eqcfg.fullscreen, tc.borderless);
-				result += tileCfg;
-
-				curDevice = tc.device;
+				DisplayTileConfig* tc = nc.tiles[i];
+				if(tc->enabled && std::find(devices.begin(), devices.end(), tc->device) == devices.end())
+				{
+					devices.push_back(tc->device);
+				}
+			}
+			foreach(int device, devices)
+			{
+				for(int i = 0; i < nc.numTiles; i++)
+				{
+					DisplayTileConfig* tc = nc.tiles[i];
+					if(tc->enabled && tc->device == device) pipeTiles.push_back(tc);
+				}
+			}
+		}
+		else
+		{
+			for(int i = 0; i < nc.numTiles; i++)
+			{
+				if(nc.tiles[i]->enabled) pipeTiles.push_back(nc.tiles[i]);
 			}
 		}
 
+		// Write pipes section
+		foreach(DisplayTileConfig* ptc, pipeTiles)
+		{
+			DisplayTileConfig& tc = *ptc;
+			winX = tc.position[0] + eqcfg.windowOffset[0];
+			winY = tc.position[1] + eqcfg.windowOffset[1];
+		
+			String tileName = tc.name;
+			String tileCfg = buildTileConfig(indent, tileName, winX, winY, tc.pixelSize[0], tc.pixelSize[1], tc.device, curDevice, eqcfg.fullscreen, tc.borderless);
+			result += tileCfg;
+
+			curDevice = tc.device;
+		}
+
 		if(curDevice != -1)
 		{		
 			END_BLOCK(result); // End last open pipe section
@@ -309,37 +429,160 @@ void EqualizerDisplaySystem::initialize(SystemManager* sys)
 	{
 		// Generate the equalizer configuration
 		generateEqConfig();
-		
-		for(int n = 0; n < myDisplayConfig.numNodes; n++)
-		{
-			DisplayNodeConfig& nc = myDisplayConfig.nodes[n];
+		launchNodes();
+	}
+}
 
-			if(nc.hostname != "local")
+///////////////////////////////////////////////////////////////////////////////
+void EqualizerDisplaySystem::launchNodes()
+{
+	// When using the launcher handshake, start listening for node ready 
+	// messages before launching the nodes.
+	Ref<NodeLauncherServer> launcher;
+	String launcherAddress;
+	if(myDisplayConfig.launcherHandshake)
+	{
+		String host = myDisplayConfig.launcherHost;
+		if(host == "") host = asio::ip::host_name();
+		launcherAddress = ostr("%1%:%2%", %host %myDisplayConfig.launcherPort);
+
+		launcher = new NodeLauncherServer();
+		launcher->setPort(myDisplayConfig.launcherPort);
+		launcher->initialize();
+		launcher->start();
+	}
+
+	// Nodes report to the mission control server we run or connect to. A 
+	// server running here is reached using the same host name as the launcher.
+	int mcPort = SystemManager::instance()->getMissionControlPort();
+	String mcHost = SystemManager::instance()->getMissionControlHost();
+	if(mcHost == "") mcHost = myDisplayConfig.launcherHost;
+	if(mcHost == "") mcHost = asio::ip::host_name();
+
+	// Launch all the nodes. olaunch does not wait for the launched process,
+	// so nodes start up in parallel.
+	List<String> launchedNodes;
+	for(int n = 0; n < myDisplayConfig.numNodes; n++)
+	{
+		DisplayNodeConfig& nc = myDisplayConfig.nodes[n];
+
+		if(nc.hostname != "local")
+		{
+			// Launch the node if at least one of the tiles on the node is enabled.
+			bool enabled = false;
+			for(int i = 0; i < nc.numTiles; i++) enabled |= nc.tiles[i]->enabled;
+			
+			if(enabled)
 			{
-				// Launch the node if at least one of the tiles on the node is enabled.
-				bool enabled = false;
-				for(int i = 0; i < nc.numTiles; i++) enabled |= nc.tiles[i]->enabled;
-				
-				if(enabled)
-				{
-					String executable = StringUtils::replaceAll(myDisplayConfig.nodeLauncher, "%c", SystemManager::instance()->getApplication()->getExecutableName());
-					executable = StringUtils::replaceAll(executable, "%h", nc.hostname);
-				
-					// Substitute %d with current working directory
-					String cCurrentPath = ogetcwd();
-					executable = StringUtils::replaceAll(executable, "%d", cCurrentPath);
-				
-					// Setup the executable call. Note: we pass a-D argument to tell all
-					// instances what the main data directory is. We use ogetdataprefix
-					// because omain sets the data prefix to the root data dir during
-					// startup.
-					int port = myDisplayConfig.basePort + nc.port;
-					String cmd = ostr("%1% -c %2%@%3%:%4% -D %5%", %executable %SystemManager::instance()->getAppConfig()->getFilename() %nc.hostname %port %ogetdataprefix());
-					olaunch(cmd);
-				}
+				String executable = StringUtils::replaceAll(myDisplayConfig.nodeLauncher, "%c", SystemManager::instance()->getApplication()->getExecutableName());
+				executable = StringUtils::replaceAll(executable, "%h", nc.hostname);
+			
+				// Substitute %d with current working directory
+				String cCurrentPath = ogetcwd();
+				executable = StringUtils::replaceAll(executable, "%d", cCurrentPath);
+			
+				// Setup the executable call. Note: we pass a-D argument to tell all
+				// instances what the main data directory is. We use ogetdataprefix
+				// because omain sets the data prefix to the root data dir during
+				// startup.
+				int port = myDisplayConfig.basePort + nc.port;
+				String cmd = ostr("%1% -c %2%@%3%:%4% -D %5%", %executable %SystemManager::instance()->getAppConfig()->getFilename() %nc.hostname %port %ogetdataprefix());
+				if(launcher != NULL) cmd += " --launcher " + launcherAddress;
+				// Have nodes report stats and logs to the master mission control server.
+				if(mcPort != 0) cmd += ostr(" --mc @%1%:%2%", %mcHost %mcPort);
+				olaunch(cmd);
+				launchedNodes.push_back(ostr("%1%:%2%", %nc.hostname %port));
 			}
 		}
+	}
+
+	if(launcher == NULL)
+	{
 		osleep(myDisplayConfig.launcherInterval);
+		return;
+	}
+
+	// Wait for all nodes to be ready, or for the launcher timeout to expire.
+	Dictionary<String, double>& readyNodes = launcher->getReadyNodes();
+	while(readyNodes.size() < launchedNodes.size() && 
+		launcher->getElapsedTime() < myDisplayConfig.launcherTimeout)
+	{
+		launcher->poll();
+		osleep(10);
+	}
+
+	// Report time to ready for each node, so slow nodes stand out.
+	StatsManager* sm = SystemManager::instance()->getStatsManager();
+	String slowestNode;
+	double slowestTime = 0;
+	foreach(String node, launchedNodes)
+	{
+		Dictionary<String, double>::iterator it = readyNodes.find(node);
+		if(it == readyNodes.end())
+		{
+			ofwarn("EqualizerDisplaySystem: node %1% not ready after %2% ms", 
+				%node %myDisplayConfig.launcherTimeout);
+		}
+		else
+		{
+			String statName = "launch " + node;
+			Stat* s = sm->findStat(statName);
+			if(s == NULL) s = sm->createStat(statName, StatsManager::Time);
+			s->addSample(it->second);
+			if(getDisplayConfig().verbose) ofmsg("Node %1% ready in %2% ms", %node %(int)it->second);
+			if(it->second > slowestTime)
+			{
+				slowestTime = it->second;
+				slowestNode = node;
+			}
+		}
+	}
+	ofmsg("EqualizerDisplaySystem: %1%/%2% nodes ready in %3% ms (slowest: %4%)", 
+		%readyNodes.size() %launchedNodes.size() %(int)launcher->getElapsedTime() %slowestNode);
+
+	launcher->closeConnections();
+	launcher->stop();
+	launcher->dispose();
+}
+
+///////////////////////////////////////////////////////////////////////////////
+void EqualizerDisplaySystem::signalNodeReady()
+{
+	const String& launcherAddress = mySys->getLauncherAddress();
+	if(launcherAddress == "") return;
+
+	Vector<String> args = StringUtils::split(launcherAddress, ":");
+	if(args.size() != 2)
+	{
+		ofwarn("EqualizerDisplaySystem::signalNodeReady: invalid launcher address %1%", %launcherAddress);
+		return;
+	}
+	int port = 0;
+	try
+	{
+		port = boost::lexical_cast<int>(args[1]);
+	}
+	catch(boost::bad_lexical_cast&)
+	{
+		ofwarn("EqualizerDisplaySystem::signalNodeReady: invalid launcher address %1%", %launcherAddress);
+		return;
+	}
+
+	// NOTE: the io service must be declared before the connection, so that
+	// the connection gets destroyed first.
+	asio::io_service ioService;
+	Ref<MissionControlConnection> conn = new MissionControlConnection(
+		ConnectionInfo(ioService), NULL, NULL);
+	conn->open(args[0], port);
+	if(conn->getState() == TcpConnection::ConnectionOpen)
+	{
+		String name = mySys->getHostnameAndPort();
+		conn->sendMessage(MissionControlMessageIds::NodeReady, (void*)name.c_str(), name.size());
+		conn->goodbyeServer();
+	}
+	else
+	{
+		ofwarn("EqualizerDisplaySystem::signalNodeReady: could not connect to launcher at %1%", %launcherAddress);
 	}
 }
 
@@ -407,11 +650,25 @@ void EqualizerDisplaySystem::run()
 	int numArgs = 0;
 	setupEqInitArgs(numArgs, (const char**)argv);
 	myNodeFactory = new EqualizerNodeFactory();
+
 	omsg(">>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>> DISPLAY INITIALIZATION");
 	if( !eq::init( numArgs, (char**)argv, myNodeFactory ))
 	{
 		oerror("Equalizer init failed");
 	}
+
+	// Slave nodes run the Equalizer client loop until the master node exits, 
+	// like eq::getConfig does for render clients. The node client tells the
+	// master launcher we are ready once we listen for the master node.
+	if(!mySys->isMaster())
+	{
+		RefPtr<NodeClient> client = new NodeClient(this);
+		if(!client->initLocal(numArgs, (char**)argv))
+		{
+			oerror("Cannot get config");
+		}
+		return;
+	}
 	
 	myConfig = static_cast<ConfigImpl*>(eq::getConfig( numArgs, (char**)argv ));
 	
@@ -428,6 +685,11 @@ void EqualizerDisplaySystem::run()
 			bool exitRequestProcessed = false;
 			while(!SystemManager::instance()->isExitRequested())
 			{
+				// In idle mode, skip frames while nothing changes. Slave 
+				// nodes follow the master frames, so this throttles 
+				// rendering on the whole cluster.
+				waitForRedraw();
+
 				myConfig->startFrame( spin );
 				myConfig->finishFrame();
 				spin++;
@@ -471,6 +733,20 @@ void EqualizerDisplaySystem::cleanup()
 	SharedDataServices::cleanup();
 }
 
+///////////////////////////////////////////////////////////////////////////////
+String EqualizerDisplaySystem::getSlowestNode()
+{
+	if(myConfig == NULL || myConfig->getFrameTimingMonitor() == NULL) return "";
+	return myConfig->getFrameTimingMonitor()->getSlowestNode();
+}
+
+///////////////////////////////////////////////////////////////////////////////
+String EqualizerDisplaySystem::getSlowestTile()
+{
+	if(myConfig == NULL || myConfig->getFrameTimingMonitor() == NULL) return "";
+	return myConfig->getFrameTimingMonitor()->getSlowestTile();
+}
+
 ///////////////////////////////////////////////////////////////////////////////
 void EqualizerDisplaySystem::refreshSettings() 
 {
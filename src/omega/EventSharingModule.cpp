@@ -106,8 +106,10 @@ void EventSharingModule::updateSharedData(SharedIStream& in)
 		//sm->lockEvents();
 		while(myQueuedEvents)
 		{
-			Event evt;
 			//Event* evtHead = sm->writeHead();
+			// Use a new event each time: deserializeEvent does not reset the
+			// processed state or the extra data mask.
+			Event evt;
 			EventUtils::deserializeEvent(evt, *in.getInternalStream());
 
 			if(evt.isProcessed())
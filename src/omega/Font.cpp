@@ -26,6 +26,7 @@
  *************************************************************************************************/
 #include "omega/Font.h"
 #include "omega/glheaders.h"
+#include "omega/ResourceCache.h"
 
 #include "FTGL/ftgl.h"
 
@@ -47,9 +48,21 @@ void Font::unlock()
 }
 
 ////////////////////////////////////////////////////////////////////////////////
+// Maximum number of text sizes cached per font. Labels showing changing 
+// values (counters, timers) would make the cache grow unbounded: when we hit
+// the limit, we just start over.
+#define MAX_CACHED_TEXT_SIZES 4096
+
 Dictionary<String, FTFont*> sFontCache;
+Dictionary<String, Dictionary<String, Vector2f> > sTextSizeCache;
 Vector2f Font::getTextSize(const String& text, const String& font)
 {
+    // Layout passes measure the same strings over and over: look the size up
+    // first.
+    Dictionary<String, Vector2f>& sizes = sTextSizeCache[font];
+    Dictionary<String, Vector2f>::iterator it = sizes.find(text);
+    if(it != sizes.end()) return it->second;
+
     // Add font to cache if needed.
     if(sFontCache.find(font) == sFontCache.end())
     {
@@ -61,14 +74,15 @@ Vector2f Font::getTextSize(const String& text, const String& font)
 	    }
 	    String fontFile = args[0];
 	    int fontSize = boost::lexical_cast<int>(args[1]);
-            String fontPath;
-	    if(!DataManager::findFile(fontFile, fontPath))
+	    const byte* fontData;
+	    size_t fontDataSize;
+	    if(!ResourceCache::getFileData(fontFile, &fontData, &fontDataSize))
 	    {
 		    ofwarn("Font::getTextSize: could not find font file %1%", %fontFile);
 		    return Vector2f::Zero();
 	    }
 
-	    FTFont* fontImpl = new FTBitmapFont(fontPath.c_str());
+	    FTFont* fontImpl = new FTBitmapFont(fontData, fontDataSize);
 
 	    if(fontImpl->Error())
 	    {
@@ -81,6 +95,7 @@ Vector2f Font::getTextSize(const String& text, const String& font)
 	    {
 		    ofwarn("Font %1% failed to set size %2%", %fontFile %fontSize);
 		    delete fontImpl;
+		    return Vector2f::Zero();
 	    }
 
         sFontCache[font] = fontImpl;
@@ -88,6 +103,9 @@ Vector2f Font::getTextSize(const String& text, const String& font)
     FTFont* fontImpl = sFontCache[font];
 	FTBBox bbox = fontImpl->BBox(text.c_str());
 	Vector2f size = Vector2f((int)bbox.Upper().Xf(), (int)bbox.Upper().Yf());
+
+    if(sizes.size() >= MAX_CACHED_TEXT_SIZES) sizes.clear();
+    sizes[text] = size;
     return size;
 }
 
@@ -95,8 +113,19 @@ Vector2f Font::getTextSize(const String& text, const String& font)
 Vector2f Font::computeSize(const omega::String& text) 
 { 
 	Font::lock();
-	FTBBox bbox = myFontImpl->BBox(text.c_str());
-	Vector2f size = Vector2f((int)bbox.Upper().Xf(), (int)bbox.Upper().Yf());
+	Vector2f size;
+	Dictionary<String, Vector2f>::iterator it = myTextSizeCache.find(text);
+	if(it != myTextSizeCache.end())
+	{
+		size = it->second;
+	}
+	else
+	{
+		FTBBox bbox = myFontImpl->BBox(text.c_str());
+		size = Vector2f((int)bbox.Upper().Xf(), (int)bbox.Upper().Yf());
+		if(myTextSizeCache.size() >= MAX_CACHED_TEXT_SIZES) myTextSizeCache.clear();
+		myTextSizeCache[text] = size;
+	}
 	Font::unlock();
 	return size;
 }
@@ -0,0 +1,185 @@
+/******************************************************************************
+ * THE OMEGA LIB PROJECT
+ *-----------------------------------------------------------------------------
+ * Copyright 2010-2013		Electronic Visualization Laboratory, 
+ *							University of Illinois at Chicago
+ * Authors:										
+ *  Alessandro Febretti		febret@gmail.com
+ *-----------------------------------------------------------------------------
+ * Copyright (c) 2010-2013, Electronic Visualization Laboratory,  
+ * University of Illinois at Chicago
+ * All rights reserved.
+ * Redistribution and use in source and binary forms, with or without modification, 
+ * are permitted provided that the following conditions are met:
+ * 
+ * Redistributions of source code must retain the above copyright notice, this 
+ * list of conditions and the following disclaimer. Redistributions in binary 
+ * form must reproduce the above copyright notice, this list of conditions and 
+ * the following disclaimer in the documentation and/or other materials provided 
+ * with the distribution. 
+ * 
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" 
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO THE 
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE 
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE 
+ * LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL 
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE  GOODS OR 
+ * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER 
+ * CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, 
+ * OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE 
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ *-----------------------------------------------------------------------------
+ * What's in this file
+ *	A per-thread linear allocator for objects that live for a single frame.
+ ******************************************************************************/
+#include "omega/FrameArena.h"
+#include "omega/SystemManager.h"
+#include "omega/StatsManager.h"
+
+#include <new>
+
+#ifdef OMEGA_OS_WIN
+    #define ARENA_THREAD_LOCAL __declspec(thread)
+#else
+    #define ARENA_THREAD_LOCAL __thread
+#endif
+
+using namespace omega;
+
+#ifdef OMEGA_OS_LINUX
+const int FrameArena::BlockSize;
+#endif
+
+// Allocations are aligned to this size, enough for any type used by the
+// frame loop containers (including SSE vector types).
+#define ARENA_ALIGNMENT 16
+#define ARENA_ALIGN(x) (((x) + ARENA_ALIGNMENT - 1) & ~(size_t)(ARENA_ALIGNMENT - 1))
+
+namespace omega {
+///////////////////////////////////////////////////////////////////////////////
+struct FrameArenaBlock
+{
+    FrameArenaBlock* next;
+    size_t size;
+    size_t used;
+
+    char* data() 
+    { return reinterpret_cast<char*>(this) + ARENA_ALIGN(sizeof(FrameArenaBlock)); }
+};
+
+///////////////////////////////////////////////////////////////////////////////
+struct ThreadArena
+{
+    ThreadArena(): first(NULL), current(NULL), allocations(0), heapBlocks(0) {}
+
+    FrameArenaBlock* first;
+    FrameArenaBlock* current;
+    uint allocations;
+    uint heapBlocks;
+};
+};
+
+// Arenas are never deallocated: the threads owning them keep a pointer to 
+// them in thread-local storage.
+static ARENA_THREAD_LOCAL ThreadArena* sThreadArena = NULL;
+
+// Allocation counters of all threads, folded in when each thread resets its
+// arena.
+static Lock sCountersLock;
+static uint sAllocations = 0;
+static uint sHeapBlocks = 0;
+static Ref<Stat> sAllocationsStat;
+static Ref<Stat> sHeapBlocksStat;
+
+///////////////////////////////////////////////////////////////////////////////
+void* FrameArena::allocate(size_t size)
+{
+    ThreadArena* arena = sThreadArena;
+    if(arena == NULL)
+    {
+        arena = new ThreadArena();
+        sThreadArena = arena;
+    }
+    arena->allocations++;
+
+    size = ARENA_ALIGN(size);
+
+    // Look for room in the current block, then in the blocks kept from 
+    // previous frames.
+    FrameArenaBlock* block = arena->current;
+    while(block != NULL && block->used + size > block->size)
+    {
+        block = block->next;
+    }
+
+    if(block == NULL)
+    {
+        // Out of blocks: get a new one from the heap and append it to the 
+        // chain, so later frames can reuse it.
+        size_t blockSize = size > (size_t)BlockSize ? size : (size_t)BlockSize;
+        block = (FrameArenaBlock*)malloc(ARENA_ALIGN(sizeof(FrameArenaBlock)) + blockSize);
+        // Fail like the standard allocators, which FrameArena backs.
+        if(block == NULL) throw std::bad_alloc();
+        block->next = NULL;
+        block->size = blockSize;
+        block->used = 0;
+        arena->heapBlocks++;
+
+        if(arena->first == NULL) 
+        {
+            arena->first = block;
+        }
+        else
+        {
+            FrameArenaBlock* last = arena->current != NULL ? arena->current : arena->first;
+            while(last->next != NULL) last = last->next;
+            last->next = block;
+        }
+    }
+
+    arena->current = block;
+    void* ptr = block->data() + block->used;
+    block->used += size;
+    return ptr;
+}
+
+///////////////////////////////////////////////////////////////////////////////
+void FrameArena::reset()
+{
+    ThreadArena* arena = sThreadArena;
+    if(arena == NULL) return;
+
+    for(FrameArenaBlock* b = arena->first; b != NULL; b = b->next) b->used = 0;
+    arena->current = arena->first;
+
+    if(arena->allocations != 0 || arena->heapBlocks != 0)
+    {
+        sCountersLock.lock();
+        sAllocations += arena->allocations;
+        sHeapBlocks += arena->heapBlocks;
+        sCountersLock.unlock();
+        arena->allocations = 0;
+        arena->heapBlocks = 0;
+    }
+}
+
+///////////////////////////////////////////////////////////////////////////////
+void FrameArena::updateStats()
+{
+    if(sAllocationsStat == NULL)
+    {
+        StatsManager* sm = SystemManager::instance()->getStatsManager();
+        sAllocationsStat = sm->createStat("Frame arena allocations", StatsManager::Count1);
+        sHeapBlocksStat = sm->createStat("Frame arena heap blocks", StatsManager::Count1);
+    }
+
+    sCountersLock.lock();
+    uint allocations = sAllocations;
+    uint heapBlocks = sHeapBlocks;
+    sAllocations = 0;
+    sHeapBlocks = 0;
+    sCountersLock.unlock();
+
+    sAllocationsStat->addSample(allocations);
+    sHeapBlocksStat->addSample(heapBlocks);
+}
@@ -25,14 +25,74 @@
  * ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
  *************************************************************************************************/
 #include "omega/GpuResource.h"
+#include "omega/TextureSource.h"
 using namespace omega;
 
 uint GpuContext::mysNumContexts = 0;
 Lock GpuContext::mysContextLock = Lock();
 
-GpuContext::GpuContext()
+GpuContext::GpuContext():
+	myResidentBytes(0),
+	myMemoryBudget(0),
+	myStatsSampleFrame(0)
 {
 	mysContextLock.lock();
 	myId = mysNumContexts++;
 	mysContextLock.unlock();
 }
+
+///////////////////////////////////////////////////////////////////////////////////////////////////
+GpuContext::~GpuContext()
+{
+}
+
+///////////////////////////////////////////////////////////////////////////////////////////////////
+bool GpuContext::beginStatsSample(uint64 frameNum)
+{
+	// Renderers sharing this context may finish their frame on different 
+	// threads.
+	myStatsSampleLock.lock();
+	bool first = (frameNum != myStatsSampleFrame);
+	myStatsSampleFrame = frameNum;
+	myStatsSampleLock.unlock();
+	return first;
+}
+
+///////////////////////////////////////////////////////////////////////////////////////////////////
+void GpuContext::removeResidentBytes(size_t bytes)
+{
+	if(bytes > myResidentBytes) myResidentBytes = 0;
+	else myResidentBytes -= bytes;
+}
+
+///////////////////////////////////////////////////////////////////////////////////////////////////
+void GpuContext::queueTextureUpload(TextureSource* source)
+{
+	myUploadLock.lock();
+	myUploadQueue.push_back(source);
+	myUploadLock.unlock();
+}
+
+///////////////////////////////////////////////////////////////////////////////////////////////////
+int GpuContext::processTextureUploads(const DrawContext& context, size_t maxBytes)
+{
+	int uploaded = 0;
+	size_t uploadedBytes = 0;
+	myUploadLock.lock();
+	while(!myUploadQueue.empty() && (maxBytes == 0 || uploadedBytes < maxBytes))
+	{
+		Ref<TextureSource> source = myUploadQueue.front();
+		myUploadQueue.pop_front();
+		// Do not keep the queue locked while uploading: other threads may
+		// mark texture sources dirty in the meantime.
+		myUploadLock.unlock();
+
+		Texture* tex = source->stageUpload(context);
+		if(tex != NULL) uploadedBytes += tex->getMemorySize();
+		uploaded++;
+
+		myUploadLock.lock();
+	}
+	myUploadLock.unlock();
+	return uploaded;
+}
@@ -25,7 +25,9 @@
  * ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
  *************************************************************************************************/
 #include "omega/ImageUtils.h"
+#include "omega/ResourceCache.h"
 #include "omega/SystemManager.h"
+#include "omega/glheaders.h"
 
 #define FREEIMAGE_BIGENDIAN
 #include "FreeImage.h"
@@ -53,6 +55,26 @@ int ImageUtils::sNumLoaderThreads = 4;
 
 List<Thread*> ImageUtils::sImageLoaderThread;
 
+bool ImageUtils::sTextureCacheEnabled = false;
+String ImageUtils::sTextureCacheDir;
+
+// Header of compressed texture cache files.
+struct CachedTextureHeader
+{
+    char magic[4];
+    int width;
+    int height;
+    int format;
+    uint glFormat;
+    uint size;
+};
+static const char* sCachedTextureMagic = "OTC1";
+
+// Images waiting to be compressed and stored in the texture cache.
+static Lock sTextureCacheQueueLock;
+static Queue< Ref<PixelData> > sTextureCacheQueue;
+static Thread* sTextureCacheWriter = NULL;
+
 ///////////////////////////////////////////////////////////////////////////////////////////////////
 class ImageLoaderThread: public Thread
 {
@@ -88,8 +110,10 @@ public:
             else
             {
                 sImageQueueLock.unlock();
+                // Only sleep when the queue is empty, so streaming clients
+                // (i.e. tiled images) can keep the loader threads busy.
+                osleep(100);
             }
-            osleep(100);
         }
 
         omsg("ImageLoaderThread: shutdown");
@@ -98,6 +122,206 @@ public:
 private:
 };
 
+///////////////////////////////////////////////////////////////////////////////////////////////////
+class TextureCacheWriterThread: public Thread
+{
+public:
+    virtual void threadProc()
+    {
+        while(!sShutdownLoaderThread)
+        {
+            Ref<PixelData> data;
+            sTextureCacheQueueLock.lock();
+            if(sTextureCacheQueue.size() > 0)
+            {
+                data = sTextureCacheQueue.front();
+                sTextureCacheQueue.pop();
+            }
+            sTextureCacheQueueLock.unlock();
+
+            if(!data.isNull()) ImageUtils::storeCachedTexture(data);
+            else osleep(100);
+        }
+    }
+};
+
+///////////////////////////////////////////////////////////////////////////////////////////////////
+// S3TC block encoding for the texture cache. Color endpoints are the corners
+// of the bounding box of each 4x4 block, inset by 1/16 of its size.
+static unsigned short packRgb565(const byte* c)
+{
+    return (unsigned short)(((c[0] >> 3) << 11) | ((c[1] >> 2) << 5) | (c[2] >> 3));
+}
+
+///////////////////////////////////////////////////////////////////////////////////////////////////
+static void unpackRgb565(unsigned short v, int* c)
+{
+    c[0] = ((v >> 11) & 0x1f) * 255 / 31;
+    c[1] = ((v >> 5) & 0x3f) * 255 / 63;
+    c[2] = (v & 0x1f) * 255 / 31;
+}
+
+///////////////////////////////////////////////////////////////////////////////////////////////////
+static void encodeColorBlock(byte block[16][4], byte* out)
+{
+    byte minc[3] = { 255, 255, 255 };
+    byte maxc[3] = { 0, 0, 0 };
+    for(int i = 0; i < 16; i++)
+    {
+        for(int c = 0; c < 3; c++)
+        {
+            if(block[i][c] < minc[c]) minc[c] = block[i][c];
+            if(block[i][c] > maxc[c]) maxc[c] = block[i][c];
+        }
+    }
+    for(int c = 0; c < 3; c++)
+    {
+        int inset = (maxc[c] - minc[c]) >> 4;
+        minc[c] += inset;
+        maxc[c] -= inset;
+    }
+
+    // c0 > c1 selects the four color block mode.
+    unsigned short c0 = packRgb565(maxc);
+    unsigned short c1 = packRgb565(minc);
+    if(c0 < c1)
+    {
+        unsigned short t = c0; c0 = c1; c1 = t;
+    }
+
+    int palette[4][3];
+    unpackRgb565(c0, palette[0]);
+    unpackRgb565(c1, palette[1]);
+    for(int c = 0; c < 3; c++)
+    {
+        palette[2][c] = (2 * palette[0][c] + palette[1][c]) / 3;
+        palette[3][c] = (palette[0][c] + 2 * palette[1][c]) / 3;
+    }
+
+    uint indices = 0;
+    if(c0 != c1)
+    {
+        for(int i = 0; i < 16; i++)
+        {
+            int best = 0;
+            int bestDist = 0x7fffffff;
+            for(int j = 0; j < 4; j++)
+            {
+                int dr = block[i][0] - palette[j][0];
+                int dg = block[i][1] - palette[j][1];
+                int db = block[i][2] - palette[j][2];
+                int dist = dr * dr + dg * dg + db * db;
+                if(dist < bestDist)
+                {
+                    best = j;
+                    bestDist = dist;
+                }
+            }
+            indices |= (uint)best << (i * 2);
+        }
+    }
+
+    out[0] = c0 & 0xff;
+    out[1] = c0 >> 8;
+    out[2] = c1 & 0xff;
+    out[3] = c1 >> 8;
+    for(int k = 0; k < 4; k++) out[4 + k] = (byte)(indices >> (8 * k));
+}
+
+///////////////////////////////////////////////////////////////////////////////////////////////////
+static void encodeAlphaBlock(byte block[16][4], byte* out)
+{
+    int a0 = 0;
+    int a1 = 255;
+    for(int i = 0; i < 16; i++)
+    {
+        if(block[i][3] > a0) a0 = block[i][3];
+        if(block[i][3] < a1) a1 = block[i][3];
+    }
+
+    // a0 > a1 selects the eight value block mode.
+    int palette[8];
+    palette[0] = a0;
+    palette[1] = a1;
+    for(int j = 2; j < 8; j++) palette[j] = ((8 - j) * a0 + (j - 1) * a1) / 7;
+
+    uint64 indices = 0;
+    if(a0 != a1)
+    {
+        for(int i = 0; i < 16; i++)
+        {
+            int best = 0;
+            int bestDist = 256;
+            for(int j = 0; j < 8; j++)
+            {
+                int dist = abs(block[i][3] - palette[j]);
+                if(dist < bestDist)
+                {
+                    best = j;
+                    bestDist = dist;
+                }
+            }
+            indices |= (uint64)best << (i * 3);
+        }
+    }
+
+    out[0] = a0;
+    out[1] = a1;
+    for(int k = 0; k < 6; k++) out[2 + k] = (byte)(indices >> (8 * k));
+}
+
+///////////////////////////////////////////////////////////////////////////////////////////////////
+// Compresses an image to DXT5 (images with alpha) or DXT1. Returns a buffer 
+// allocated with malloc.
+static byte* compressImage(const byte* pixels, int width, int height, int bytesPerPixel, uint& glFormat, size_t& size)
+{
+    bool alpha = (bytesPerPixel == 4);
+    int blocksX = (width + 3) / 4;
+    int blocksY = (height + 3) / 4;
+    size = (size_t)blocksX * blocksY * (alpha ? 16 : 8);
+    glFormat = alpha ? GL_COMPRESSED_RGBA_S3TC_DXT5_EXT : GL_COMPRESSED_RGB_S3TC_DXT1_EXT;
+
+    byte* out = (byte*)malloc(size);
+    if(out == NULL) return NULL;
+
+    byte* dst = out;
+    byte block[16][4];
+    for(int by = 0; by < blocksY; by++)
+    {
+        for(int bx = 0; bx < blocksX; bx++)
+        {
+            for(int i = 0; i < 16; i++)
+            {
+                // Blocks on the image border repeat the last row and column.
+                int x = bx * 4 + i % 4;
+                int y = by * 4 + i / 4;
+                if(x >= width) x = width - 1;
+                if(y >= height) y = height - 1;
+                const byte* p = pixels + ((size_t)y * width + x) * bytesPerPixel;
+                if(bytesPerPixel == 1)
+                {
+                    block[i][0] = block[i][1] = block[i][2] = p[0];
+                }
+                else
+                {
+                    block[i][0] = p[0];
+                    block[i][1] = p[1];
+                    block[i][2] = p[2];
+                }
+                block[i][3] = alpha ? p[3] : 255;
+            }
+            if(alpha)
+            {
+                encodeAlphaBlock(block, dst);
+                dst += 8;
+            }
+            encodeColorBlock(block, dst);
+            dst += 8;
+        }
+    }
+    return out;
+}
+
 ///////////////////////////////////////////////////////////////////////////////////////////////////
 bool ImageUtils::preallocateBlocks(size_t size, int numBlocks)
 {
@@ -149,6 +373,7 @@ void ImageUtils::internalDispose()
     sShutdownLoaderThread = true;
 
     foreach(Thread* t, sImageLoaderThread) t->stop();
+    if(sTextureCacheWriter != NULL) sTextureCacheWriter->stop();
 
     FreeImage_DeInitialise();
 
@@ -163,6 +388,9 @@ void ImageUtils::internalDispose()
 ///////////////////////////////////////////////////////////////////////////////////////////////////
 ImageUtils::LoadImageAsyncTask* ImageUtils::loadImageAsync(const String& filename, bool hasFullPath)
 {
+    // Multiple renderer threads may request images at the same time: start
+    // the loader threads under the queue lock.
+    sImageQueueLock.lock();
     if(sImageLoaderThread.size() == 0)
     {
         for(int i = 0; i < sNumLoaderThreads; i++)
@@ -173,7 +401,6 @@ ImageUtils::LoadImageAsyncTask* ImageUtils::loadImageAsync(const String& filenam
         }
     }
 
-    sImageQueueLock.lock();
     LoadImageAsyncTask* task = new LoadImageAsyncTask();
     task->setData( LoadImageAsyncTask::Data(filename, hasFullPath) );
     task->setTaskId(filename);
@@ -249,6 +476,10 @@ Ref<PixelData> ImageUtils::loadImage(const String& filename, bool hasFullPath)
     String path;
     if(!hasFullPath)
     {
+        // Images preloaded at startup are returned directly.
+        Ref<PixelData> preloaded = ResourceCache::takeImage(filename);
+        if(!preloaded.isNull()) return preloaded;
+
         if(!DataManager::findFile(filename, path))
         {
             //ofmsg("LOOKUP: %1%%2%", %ogetdataprefix() %filename);
@@ -265,6 +496,42 @@ Ref<PixelData> ImageUtils::loadImage(const String& filename, bool hasFullPath)
         path = filename;
     }
 
+    if(sTextureCacheEnabled)
+    {
+        // Read the image file and look for a compressed version of it in the 
+        // texture cache. On a cache miss, decode the image and queue it for
+        // compression on the texture cache writer thread.
+        FILE* f = fopen(path.c_str(), "rb");
+        if(f != NULL)
+        {
+            fseek(f, 0, SEEK_END);
+            size_t size = ftell(f);
+            fseek(f, 0, SEEK_SET);
+            byte* buffer = (byte*)malloc(size);
+            size_t read = fread(buffer, 1, size, f);
+            fclose(f);
+            if(read == size)
+            {
+                String key = getTextureCacheKey(buffer, size);
+                Ref<PixelData> pixelData = loadCachedTexture(key, path);
+                if(pixelData.isNull())
+                {
+                    pixelData = decode(buffer, size, filename);
+                    // Images decoded into preallocated blocks are overwritten
+                    // by the next load: do not cache them.
+                    if(!pixelData.isNull() && !pixelData->isDeleteDisabled())
+                    {
+                        pixelData->setTextureCacheKey(key);
+                        queueCachedTexture(pixelData);
+                    }
+                }
+                free(buffer);
+                return pixelData;
+            }
+            free(buffer);
+        }
+    }
+
     uint bpp = 0;
     int width = 0;
     int height = 0;
@@ -354,6 +621,141 @@ Ref<PixelData> ImageUtils::decode(void* data, size_t size, const String& bufName
     return pixelData;
 }
 
+///////////////////////////////////////////////////////////////////////////////////////////////////
+void ImageUtils::enableTextureCache(const String& cacheDir)
+{
+    sTextureCacheDir = cacheDir;
+    if(sTextureCacheDir.size() > 0 && 
+        sTextureCacheDir[sTextureCacheDir.size() - 1] != '/' &&
+        sTextureCacheDir[sTextureCacheDir.size() - 1] != '\\')
+    {
+        sTextureCacheDir += "/";
+    }
+    sTextureCacheEnabled = true;
+    ofmsg("ImageUtils: compressed texture cache enabled (%1%)", %sTextureCacheDir);
+}
+
+///////////////////////////////////////////////////////////////////////////////////////////////////
+String ImageUtils::getTextureCacheKey(const byte* data, size_t size)
+{
+    // 64 bit FNV-1a hash of the file contents.
+    uint64 hash = 14695981039346656037ULL;
+    for(size_t i = 0; i < size; i++)
+    {
+        hash ^= data[i];
+        hash *= 1099511628211ULL;
+    }
+    char key[32];
+    sprintf(key, "%08x%08x", (uint)(hash >> 32), (uint)(hash & 0xffffffff));
+    return ostr("%1%_%2%", %key %size);
+}
+
+///////////////////////////////////////////////////////////////////////////////////////////////////
+Ref<PixelData> ImageUtils::loadCachedTexture(const String& key, const String& sourcePath)
+{
+    String path = sTextureCacheDir + key + ".otc";
+    FILE* f = fopen(path.c_str(), "rb");
+    if(f == NULL) return NULL;
+
+    CachedTextureHeader header;
+    if(fread(&header, sizeof(CachedTextureHeader), 1, f) != 1 ||
+        strncmp(header.magic, sCachedTextureMagic, 4) != 0)
+    {
+        ofwarn("ImageUtils::loadCachedTexture: invalid cache file %1%", %path);
+        fclose(f);
+        return NULL;
+    }
+
+    byte* data = (byte*)malloc(header.size);
+    if(fread(data, 1, header.size, f) != header.size)
+    {
+        ofwarn("ImageUtils::loadCachedTexture: truncated cache file %1%", %path);
+        free(data);
+        fclose(f);
+        return NULL;
+    }
+    fclose(f);
+
+    Ref<PixelData> pixelData = new PixelData(
+        (PixelData::Format)header.format, header.width, header.height, NULL, 
+        PixelData::CompressedStorage);
+    pixelData->setCompressedData(header.glFormat, data, header.size);
+    pixelData->setSourceFile(sourcePath);
+
+    if(sVerbose) ofmsg("Image loaded from texture cache: %1%. Size: %2%x%3%", %key %header.width %header.height);
+    return pixelData;
+}
+
+///////////////////////////////////////////////////////////////////////////////////////////////////
+void ImageUtils::queueCachedTexture(PixelData* data)
+{
+    sTextureCacheQueueLock.lock();
+    if(sTextureCacheWriter == NULL)
+    {
+        sTextureCacheWriter = new TextureCacheWriterThread();
+        sTextureCacheWriter->start();
+    }
+    sTextureCacheQueue.push(data);
+    sTextureCacheQueueLock.unlock();
+}
+
+///////////////////////////////////////////////////////////////////////////////////////////////////
+void ImageUtils::storeCachedTexture(PixelData* data)
+{
+    // Pixel buffer objects can only be mapped on a gpu thread.
+    if(!sTextureCacheEnabled || data->checkUsage(PixelData::PixelBufferObject)) return;
+
+    // Compress the image while it is mapped. If its pixels were modified 
+    // after loading, the cache key has been cleared.
+    const byte* pixels = data->map(true);
+    String key = data->getTextureCacheKey();
+    uint glFormat = 0;
+    size_t size = 0;
+    byte* blocks = NULL;
+    if(!key.empty() && pixels != NULL)
+    {
+        blocks = compressImage(pixels, data->getWidth(), data->getHeight(), 
+            data->getBpp() / 8, glFormat, size);
+    }
+    data->unmap();
+    if(blocks == NULL) return;
+
+    String path = sTextureCacheDir + key + ".otc";
+
+    // Write to a file with a name unique to this node, then rename it: other
+    // nodes on this host never see partially written cache files.
+    String nodeName = SystemManager::instance()->getHostnameAndPort();
+    nodeName = StringUtils::replaceAll(nodeName, ":", "_");
+    String tmpPath = ostr("%1%.%2%.tmp", %path %nodeName);
+
+    FILE* f = fopen(tmpPath.c_str(), "wb");
+    if(f == NULL)
+    {
+        ofwarn("ImageUtils::storeCachedTexture: could not write %1%", %tmpPath);
+        free(blocks);
+        return;
+    }
+
+    CachedTextureHeader header;
+    memcpy(header.magic, sCachedTextureMagic, 4);
+    header.width = data->getWidth();
+    header.height = data->getHeight();
+    header.format = data->getFormat();
+    header.glFormat = glFormat;
+    header.size = size;
+
+    bool ok = fwrite(&header, sizeof(CachedTextureHeader), 1, f) == 1 &&
+        fwrite(blocks, 1, header.size, f) == header.size;
+    fclose(f);
+    free(blocks);
+
+    // If rename fails, another node stored the same texture first.
+    if(!ok || rename(tmpPath.c_str(), path.c_str()) != 0)
+    {
+        remove(tmpPath.c_str());
+    }
+}
+
 ///////////////////////////////////////////////////////////////////////////////////////////////////
 ByteArray* ImageUtils::encode(PixelData* data, ImageFormat format)
 {
@@ -366,7 +768,7 @@ ByteArray* ImageUtils::encode(PixelData* data, ImageFormat format)
             FIMEMORY* fmem = FreeImage_OpenMemory();
 
             // For some reason it looks like color masks are ignored right now. Maybe it is just when encoding to png.
-            byte* pdpixels = data->map();
+            byte* pdpixels = data->map(true);
             FIBITMAP* fibmp = FreeImage_ConvertFromRawBits(
                 pdpixels,
                 data->getWidth(),
@@ -403,7 +805,7 @@ ByteArray* ImageUtils::encode(PixelData* data, ImageFormat format)
             FIMEMORY* fmem = FreeImage_OpenMemory();
 
             // For some reason it looks like color masks are ignored right now. Maybe it is just when encoding to png.
-            byte* pdpixels = data->map();
+            byte* pdpixels = data->map(true);
             FIBITMAP* fibmp = FreeImage_ConvertFromRawBits(
                 pdpixels,
                 data->getWidth(),
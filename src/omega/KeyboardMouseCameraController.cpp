@@ -110,7 +110,12 @@ void KeyboardMouseCameraController::update(const UpdateContext& context)
         Quaternion no = Math::quaternionFromEuler(Vector3f(myPitch, myYaw, 0)); 
         c->setOrientation(myInitialOrientation * no);
     }
-    c->translate(speed * context.dt, Node::TransformLocal);
+    // Only move the camera when a movement key is pressed: translating by 
+    // zero would still mark the camera as changed.
+    if(!speed.isZero())
+    {
+        c->translate(speed * context.dt, Node::TransformLocal);
+    }
 }
 
 ///////////////////////////////////////////////////////////////////////////////
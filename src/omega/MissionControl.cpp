@@ -51,10 +51,15 @@ const char* MissionControlMessageIds::ScriptCommand = "scmd";
 const char* MissionControlMessageIds::StatRequest = "strq";
 const char* MissionControlMessageIds::StatEnable = "sten";
 const char* MissionControlMessageIds::StatUpdate = "stup";
+const char* MissionControlMessageIds::StatSubscribe = "stsb";
+const char* MissionControlMessageIds::StatStream = "stbn";
 const char* MissionControlMessageIds::LogMessage = "smsg";
 const char* MissionControlMessageIds::ClientConnected = "ccon";
 const char* MissionControlMessageIds::ClientDisconnected = "dcon";
 const char* MissionControlMessageIds::ClientList = "clls";
+const char* MissionControlMessageIds::NodeReady = "nrdy";
+const char* MissionControlMessageIds::Capabilities = "caps";
+const char* MissionControlMessageIds::Batch = "mbat";
 
 
 ///////////////////////////////////////////////////////////////////////////////
@@ -62,8 +67,17 @@ MissionControlConnection::MissionControlConnection(ConnectionInfo ci, IMissionCo
     TcpConnection(ci),
     myServer(server),
     myMessageHandler(msgHandler),
-    myRecipient(NULL)
+    myRecipient(NULL),
+    myAsyncSendEnabled(false),
+    myQueueSize(0),
+    myQueuedMessages(0),
+    myMaxQueueSize(4 * 1024 * 1024),
+    myDroppedMessages(0),
+    myBatchingEnabled(true),
+    myPeerBatchingSupported(false),
+    myStatStreamListener(false)
 {
+    myQueue.resize(BatchHeaderSize);
 }
         
 
@@ -78,17 +92,25 @@ void MissionControlConnection::handleData()
 {
     // Read message header.
     char header[4];
-    read(myBuffer, 4);
-    memcpy(header, myBuffer, 4);
+    read(header, 4);
 
     // Read data length.
     int dataSize;
-    read(myBuffer, 4);
-    memcpy(&dataSize, myBuffer, 4);
+    read((char*)&dataSize, 4);
+    if(dataSize < 0 || dataSize > MaxMessageSize)
+    {
+        ofwarn("Mission control connection %1%: invalid message size %2%, closing", 
+            %getConnectionInfo().id %dataSize);
+        close();
+        return;
+    }
 
-    // Read data.
-    read(myBuffer, dataSize);
-    myBuffer[dataSize] = '\0';
+    // Read data. The buffer grows to fit the largest message received so 
+    // far. Keep space for a string terminator.
+    if((int)myBuffer.size() < dataSize + 1) myBuffer.resize(dataSize + 1);
+    char* data = &myBuffer[0];
+    if(dataSize > 0) read(data, dataSize);
+    data[dataSize] = '\0';
 
     // 'bye!' message closes the connection
     if(!strncmp(header, MissionControlMessageIds::Bye, 4)) 
@@ -97,11 +119,85 @@ void MissionControlConnection::handleData()
         return;
     }
 
+    if(!strncmp(header, MissionControlMessageIds::Batch, 4)) 
+    {
+        // Unpack the batch and handle each message in it.
+        int pos = 0;
+        while(pos + 8 <= dataSize)
+        {
+            char* msgHeader = data + pos;
+            int msgSize;
+            memcpy(&msgSize, data + pos + 4, 4);
+            char* msgData = data + pos + 8;
+            if(msgSize < 0 || msgSize > dataSize - pos - 8)
+            {
+                ofwarn("Mission control connection %1%: malformed batch message", 
+                    %getConnectionInfo().id);
+                break;
+            }
+            pos += 8 + msgSize;
+
+            // Handlers expect null-terminated data: temporarily terminate 
+            // the message, overwriting the first byte of the next one.
+            char next = msgData[msgSize];
+            msgData[msgSize] = '\0';
+            char msgId[4];
+            memcpy(msgId, msgHeader, 4);
+            dispatchMessage(msgId, msgData, msgSize);
+            msgData[msgSize] = next;
+        }
+    }
+    else
+    {
+        dispatchMessage(header, data, dataSize);
+    }
+}
+
+///////////////////////////////////////////////////////////////////////////////
+void MissionControlConnection::dispatchMessage(const char* header, char* data, int size)
+{
+    // Capabilities are handled by the connection itself.
+    if(!strncmp(header, MissionControlMessageIds::Capabilities, 4)) 
+    {
+        handleCapabilities(data);
+        return;
+    }
+
     // Handle message locally, if a message handler is available.
-    if(myMessageHandler != NULL) myMessageHandler->handleMessage(this, header, myBuffer, dataSize);
+    if(myMessageHandler != NULL) myMessageHandler->handleMessage(this, header, data, size);
 
     // On a server, send the message to the server to be handled.
-    if(myServer != NULL) myServer->handleMessage(header, myBuffer, dataSize, this);
+    if(myServer != NULL) myServer->handleMessage(header, data, size, this);
+}
+
+///////////////////////////////////////////////////////////////////////////////
+void MissionControlConnection::handleCapabilities(char* data)
+{
+    Vector<String> caps = StringUtils::split(data, " ");
+    if(caps.size() == 0) return;
+
+    // Servers only listen to clients, and the other way around. This also 
+    // protects us from older servers, that relay capability messages from 
+    // clients to all other clients.
+    String role = caps[0];
+    if((myServer != NULL && role != "client") ||
+        (myServer == NULL && role != "server")) return;
+
+    myPeerBatchingSupported = false;
+    foreach(String cap, caps)
+    {
+        if(cap == "batch") myPeerBatchingSupported = true;
+    }
+
+    // On a server, reply with our own capabilities.
+    if(myServer != NULL) sendCapabilities();
+}
+
+///////////////////////////////////////////////////////////////////////////////
+void MissionControlConnection::sendCapabilities()
+{
+    String caps = myServer != NULL ? "server batch" : "client batch";
+    sendMessage(MissionControlMessageIds::Capabilities, (void*)caps.c_str(), caps.size());
 }
 
 ///////////////////////////////////////////////////////////////////////////////
@@ -126,17 +222,88 @@ void MissionControlConnection::handleError(const ConnectionError& err)
 }
 
 ///////////////////////////////////////////////////////////////////////////////
-void MissionControlConnection::sendMessage(const char* header, void* data, int size)
+void MissionControlConnection::appendFrame(Vector<char>& buffer, const char* header, const void* data, int size)
+{
+    size_t pos = buffer.size();
+    buffer.resize(pos + 8 + size);
+    memcpy(&buffer[pos], header, 4);
+    memcpy(&buffer[pos + 4], &size, 4);
+    if(size > 0) memcpy(&buffer[pos + 8], data, size);
+}
+
+///////////////////////////////////////////////////////////////////////////////
+bool MissionControlConnection::sendMessage(const char* header, void* data, int size)
+{
+    if(!myAsyncSendEnabled)
+    {
+        // Send the whole message with a single write.
+        Vector<char> frame;
+        appendFrame(frame, header, data, size);
+        write(&frame[0], frame.size());
+        return true;
+    }
+
+    myQueueLock.lock();
+    // When the queue is full, drop high-rate messages (logs, stats), so a 
+    // slow client can't make us buffer without limits.
+    if(myQueueSize + 8 + size > myMaxQueueSize && 
+        (!strncmp(header, MissionControlMessageIds::LogMessage, 4) ||
+        !strncmp(header, MissionControlMessageIds::StatUpdate, 4) ||
+        !strncmp(header, MissionControlMessageIds::StatStream, 4)))
+    {
+        myDroppedMessages++;
+        myQueueLock.unlock();
+        return false;
+    }
+    appendFrame(myQueue, header, data, size);
+    myQueueSize += 8 + size;
+    myQueuedMessages++;
+    myQueueLock.unlock();
+    return true;
+}
+
+///////////////////////////////////////////////////////////////////////////////
+void MissionControlConnection::flush()
 {
-    write((void*)header, 4);
-    write(&size, sizeof(int));
-    write(data, size);
+    if(myQueuedMessages == 0) return;
+
+    // Grab the queued messages, so other threads can keep queueing while
+    // we write.
+    Vector<char> queue;
+    myQueueLock.lock();
+    queue.swap(myQueue);
+    int numMessages = myQueuedMessages;
+    myQueue.resize(BatchHeaderSize);
+    myQueueSize = 0;
+    myQueuedMessages = 0;
+    myQueueLock.unlock();
+
+    if(getState() != TcpConnection::ConnectionOpen) return;
+
+    int size = queue.size() - BatchHeaderSize;
+    if(numMessages > 1 && myBatchingEnabled && myPeerBatchingSupported)
+    {
+        // Fill the reserved space with a batch message header
+        memcpy(&queue[0], MissionControlMessageIds::Batch, 4);
+        memcpy(&queue[4], &size, 4);
+        write(&queue[0], queue.size());
+    }
+    else
+    {
+        // Messages are still sent with a single write.
+        write(&queue[BatchHeaderSize], size);
+    }
 }
 
 ///////////////////////////////////////////////////////////////////////////////////////////
 void MissionControlConnection::goodbyeServer()
 {
+    // Send anything still queued before saying goodbye.
+    flush();
+    bool async = myAsyncSendEnabled;
+    myAsyncSendEnabled = false;
     sendMessage(MissionControlMessageIds::Bye, NULL, 0);
+    myAsyncSendEnabled = async;
     waitClose();
 }
 
@@ -158,10 +325,39 @@ void MissionControlServer::dispose()
     TcpServer::dispose();
 }
 
+///////////////////////////////////////////////////////////////////////////////////////////
+void MissionControlServer::poll()
+{
+    // Accept new connections and handle incoming messages.
+    TcpServer::poll();
+
+    if(myStatsAggregator != NULL) myStatsAggregator->update();
+
+    // Forward log lines queued since the last poll.
+    List<String> lines;
+    myLogLock.lock();
+    lines.swap(myPendingLogLines);
+    myLogLock.unlock();
+    foreach(String line, lines)
+    {
+        handleMessage(MissionControlMessageIds::LogMessage, (void*)line.c_str(), line.size());
+    }
+
+    // Send everything queued for each client. Iterate on a copy of the 
+    // connection list: write errors close connections, removing them.
+    List<MissionControlConnection*> conns = myConnections;
+    foreach(MissionControlConnection* conn, conns)
+    {
+        conn->flush();
+    }
+}
+
 ///////////////////////////////////////////////////////////////////////////////////////////
 TcpConnection* MissionControlServer::createConnection(const ConnectionInfo& ci)
 {
     MissionControlConnection* conn = new MissionControlConnection(ci, myMessageHandler, this);
+    // Messages to clients are queued, and sent at the end of each poll.
+    conn->setAsyncSendEnabled(true);
     myConnections.push_back(conn);
 
     // NOTE: the connection has no name (yet) so we wait notifying clients 
@@ -175,6 +371,7 @@ TcpConnection* MissionControlServer::createConnection(const ConnectionInfo& ci)
 void MissionControlServer::closeConnection(MissionControlConnection* conn)
 {
     myConnections.remove(conn);
+    if(myStatsAggregator != NULL) myStatsAggregator->removeSource(conn->getConnectionInfo().id);
 
     // Tell clients about the closed connection
     handleMessage(
@@ -233,6 +430,15 @@ void MissionControlServer::handleMessage(const char* header, void* data, int siz
             handleMessage(
                 MissionControlMessageIds::ClientConnected, 
                 (void*)name.c_str(), name.size());
+
+            // Subscribe the client to the stats the aggregator needs.
+            if(myStatsAggregator != NULL)
+            {
+                String sub = myStatsAggregator->getSubscription();
+                sender->sendMessage(
+                    MissionControlMessageIds::StatSubscribe,
+                    (void*)sub.c_str(), sub.size());
+            }
         }
 
 
@@ -241,8 +447,33 @@ void MissionControlServer::handleMessage(const char* header, void* data, int siz
             MissionControlMessageIds::ClientList, 
             (void*)namelist.c_str(), namelist.size());
     }
+    else if(!strncmp(header, MissionControlMessageIds::StatStream, 4))
+    {
+        if(myStatsAggregator != NULL && sender != NULL) 
+        {
+            myStatsAggregator->handleStream(
+                sender->getConnectionInfo().id, sender->getName(), (const char*)data, size);
+        }
+        // Stat streams are only sent to clients that asked for them.
+        foreach(MissionControlConnection* conn, myConnections)
+        {
+            if(conn->getState() == TcpConnection::ConnectionOpen && 
+                conn != sender && conn->isStatStreamListener())
+            {
+                conn->sendMessage(header, data, size);
+            }
+        }
+    }
     else
     {
+        if(!strncmp(header, MissionControlMessageIds::StatSubscribe, 4) && sender != NULL)
+        {
+            // A subscription with no stat patterns is an unsubscription.
+            String sub((char*)data);
+            Vector<String> args = StringUtils::split(sub, " ");
+            sender->setStatStreamListener(args.size() > 2);
+        }
+
         // If the message is a script command and the command begins with '@',
         // the message first word is a client id: send a message only to that
         // client.
@@ -286,7 +517,11 @@ void MissionControlServer::handleMessage(const char* header, void* data, int siz
 ///////////////////////////////////////////////////////////////////////////////
 void MissionControlServer::addLine(const String& line)
 {
-    handleMessage(MissionControlMessageIds::LogMessage, (void*)line.c_str(), line.size());
+    // NOTE: we can't log from here (we would end up calling ourselves).
+    myLogLock.lock();
+    if(myPendingLogLines.size() >= MaxPendingLogLines) myPendingLogLines.pop_front();
+    myPendingLogLines.push_back(line);
+    myLogLock.unlock();
 }
 
 ///////////////////////////////////////////////////////////////////////////////
@@ -304,6 +539,8 @@ void MissionControlClient::initialize()
     {
         myConnection = new MissionControlConnection(
             ConnectionInfo(myIoService), this, NULL);
+        // Messages are queued and sent once per frame (see update)
+        myConnection->setAsyncSendEnabled(true);
     }
 }
 
@@ -324,6 +561,19 @@ void MissionControlClient::dispose()
 void MissionControlClient::update(const UpdateContext& context)
 {
     myConnection->poll();
+
+    if(myStatsStream.isActive() && isConnected())
+    {
+        myStatsStream.setSourceName(myName);
+        StatsManager* sm = SystemManager::instance()->getStatsManager();
+        if(myStatsStream.update(sm, context.frameNum, context.time, myStatsMessage))
+        {
+            myConnection->sendMessage(MissionControlMessageIds::StatStream, 
+                &myStatsMessage[0], myStatsMessage.size());
+        }
+    }
+
+    myConnection->flush();
 }
 
 ///////////////////////////////////////////////////////////////////////////////
@@ -344,6 +594,7 @@ void MissionControlClient::connect(const String& host, int port)
         myConnection->sendMessage(
             MissionControlMessageIds::MyNameIs, 
             (void*)myName.c_str(), myName.size());
+        myConnection->sendCapabilities();
     }
 }
 
@@ -419,7 +670,9 @@ bool MissionControlClient::handleMessage(
     {
         //script command message
         String command(data);
-        if(interp != NULL)
+        // Cluster nodes connect to report stats and logs. Commands run on the
+        // master, which shares them with the other nodes.
+        if(interp != NULL && SystemManager::instance()->isMaster())
         {
             interp->queueCommand(command);
         }
@@ -525,5 +778,24 @@ bool MissionControlClient::handleMessage(
             sender->sendMessage(MissionControlMessageIds::StatUpdate, (void*)statIds.c_str(), statIds.size());
         }
     }
+    if(!strncmp(header, MissionControlMessageIds::StatSubscribe, 4)) 
+    {
+        float sampleRate = 0;
+        float sendRate = 0;
+        int patternStart = 0;
+        if(sscanf(data, "%f %f %n", &sampleRate, &sendRate, &patternStart) >= 2)
+        {
+            String patterns = data + patternStart;
+            if(patterns.empty())
+            {
+                myStatsStream.clear();
+            }
+            else
+            {
+                myStatsStream.subscribe(
+                    StringUtils::split(patterns, "|"), sampleRate, sendRate);
+            }
+        }
+    }
     return true;
 }
@@ -34,6 +34,8 @@
  *	the engine and receive update, event and command calls.
  ******************************************************************************/
 #include "omega/ModuleServices.h"
+#include "omega/SystemManager.h"
+#include "omega/StatsManager.h"
 
 using namespace omega;
 
@@ -70,6 +72,13 @@ void EngineModule::doInitialize(Engine* server)
 		}
 
 		if(mySharedDataEnabled) SharedDataServices::registerObject(this, myName);
+
+		// Per-module profiling stats
+		StatsManager* sm = SystemManager::instance()->getStatsManager();
+		myUpdateTimeStat = sm->createUniqueStat(ostr("Module %1% update", %myName), StatsManager::Time);
+		myEventTimeStat = sm->createUniqueStat(ostr("Module %1% events", %myName), StatsManager::Time);
+		myEventTime = 0;
+
 		myInitialized = true; 
 	}
 }
@@ -82,6 +91,8 @@ void EngineModule::doDispose()
 		myInitialized = false;
 		if(mySharedDataEnabled) SharedDataServices::unregisterObject(myName);
 		dispose();
+		myUpdateTimeStat = NULL;
+		myEventTimeStat = NULL;
 	}
 }
 
@@ -109,7 +120,14 @@ void ModuleServices::update(Engine* srv, const UpdateContext& context)
 	foreach(EngineModule* module, mysModules)
 	{
 		module->doInitialize(srv);
+
+		// Events for this frame have been dispatched: sample their total cost.
+		module->myEventTimeStat->addSample(module->myEventTime);
+		module->myEventTime = 0;
+
+		module->myUpdateTimeStat->startTiming();
 		module->update(context);
+		module->myUpdateTimeStat->stopTiming();
 	}
 
 	// Remove modules
@@ -121,9 +139,20 @@ void ModuleServices::update(Engine* srv, const UpdateContext& context)
 	mysModulesToRemove.clear();
 }
 
+///////////////////////////////////////////////////////////////////////////////
+void ModuleServices::fixedUpdate(const UpdateContext& context)
+{
+	foreach(EngineModule* module, mysModules)
+	{
+		if(module->isInitialized()) module->fixedUpdate(context);
+	}
+}
+
 ///////////////////////////////////////////////////////////////////////////////
 void ModuleServices::handleEvent(const Event& evt, EngineModule::Priority p)
 {
+	// Local timer: modules may dispatch events from their event handlers.
+	Timer t;
 	foreach(EngineModule* module, mysModules)
 	{
 		// Only send events to initialized modules.
@@ -131,7 +160,10 @@ void ModuleServices::handleEvent(const Event& evt, EngineModule::Priority p)
 		{
 			if(module->getPriority() == p)
 			{
+				t.start();
 				module->handleEvent(evt);
+				t.stop();
+				module->myEventTime += t.getElapsedTimeInMilliSec();
 			}
 		}
 	}
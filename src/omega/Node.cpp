@@ -37,6 +37,7 @@
  *	A generic node in a transformation hierarchy
  ******************************************************************************/
 #include "omega/Node.h"
+#include "omega/DisplaySystem.h"
 
 using namespace omega;
 
@@ -131,6 +132,9 @@ void Node::setParent(Node* parent)
 	mParentNotified = false ;
     needUpdate();
 
+    // Attaching or detaching a node changes the scene.
+    if(different) DisplaySystem::requestRedraw();
+
 }
 
 ///////////////////////////////////////////////////////////////////////////////
@@ -201,6 +205,12 @@ void Node::update(bool updateChildren, bool parentHasChanged)
 ///////////////////////////////////////////////////////////////////////////////
 void Node::updateFromParent(void) const
 {
+    // Keep the previous transform: only actual changes wake up an idle 
+    // display.
+    Vector3f prevPosition = mDerivedPosition;
+    Quaternion prevOrientation = mDerivedOrientation;
+    Vector3f prevScale = mDerivedScale;
+
     if (mParent)
     {
         // Update orientation
@@ -247,6 +257,11 @@ void Node::updateFromParent(void) const
 	mCachedTransformOutOfDate = true;
 	mNeedParentUpdate = false;
 
+    if(mDerivedPosition != prevPosition || mDerivedScale != prevScale ||
+        mDerivedOrientation.coeffs() != prevOrientation.coeffs())
+    {
+        DisplaySystem::requestRedraw();
+    }
 }
 
 ///////////////////////////////////////////////////////////////////////////////
@@ -98,6 +98,11 @@ void ObserverUpdateServiceExt::setup(Setting& settings)
 		myOrientationSourceId = st["sourceId"];
 		myEnableOrientationSource = true;
 	}
+	if(settings.exists("posePrediction"))
+	{
+		myPosePredictor = new PosePredictor();
+		myPosePredictor->setup(settings["posePrediction"]);
+	}
 }
 
 ///////////////////////////////////////////////////////////////////////////////////////////////////
@@ -105,6 +110,12 @@ void ObserverUpdateServiceExt::initialize()
 {
 	DisplaySystem* ds = SystemManager::instance()->getDisplaySystem();
 	myObserver = Engine::instance()->getDefaultCamera();
+	// The observer camera extrapolates the head pose at each frame update,
+	// using the samples fed by this service only.
+	if(myPosePredictor != NULL)
+	{
+		myObserver->setHeadPosePredictor(myPosePredictor, true);
+	}
 }
 
 ///////////////////////////////////////////////////////////////////////////////////////////////////
@@ -162,6 +173,10 @@ void ObserverUpdateServiceExt::poll()
 					//ofmsg("mvth: %1%", %myCurrentMovementThreshold);
 					myObserver->setHeadOffset(myLastPosition);
 					myObserver->setHeadOrientation(q);
+					if(myPosePredictor != NULL)
+					{
+						myPosePredictor->addSample(evt->getTimestamp() / 1000.0, myLastPosition, q);
+					}
 				}
 			}
 			else if(myEnableOrientationSource && evt->getSourceId() == myOrientationSourceId)
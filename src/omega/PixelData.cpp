@@ -33,8 +33,11 @@
  *	A class to store pixels and modify pixels
  ******************************************************************************/
 #include "omega/PixelData.h"
+#include "omega/ImageUtils.h"
 #include "omega/glheaders.h"
 
+#include <fstream>
+
 using namespace omega;
 
 ///////////////////////////////////////////////////////////////////////////////
@@ -52,7 +55,10 @@ PixelData::PixelData(Format fmt, int width, int height, byte* data, uint usageFl
 	myFormat(fmt),
 	mySize(0),
 	myDeleteDisabled(false),
-	myChangingPixels(false)
+	myChangingPixels(false),
+	myCompressedFormat(0),
+	myCompressedData(NULL),
+	myCompressedSize(0)
 	//myDirty(true)
 {
 	setDirty(true);
@@ -65,7 +71,7 @@ PixelData::PixelData(Format fmt, int width, int height, byte* data, uint usageFl
         glBindBuffer(GL_PIXEL_UNPACK_BUFFER, myPBOId);
         glBufferData(GL_PIXEL_UNPACK_BUFFER, mySize, data, GL_STREAM_DRAW);
 	}
-	else
+	else if(!checkUsage(CompressedStorage))
 	{
 		// If no user pointer is passed, allocate memory. Otherwise, use user pointer and
 		// Disable deallocation.
@@ -89,6 +95,60 @@ PixelData::~PixelData()
 	{
 		glDeleteBuffers(1, &myPBOId);
 	}
+	clearCompressedData();
+}
+
+///////////////////////////////////////////////////////////////////////////////
+void PixelData::setCompressedData(uint glFormat, byte* data, size_t size)
+{
+	myLock.lock();
+	if(myCompressedData != NULL) free(myCompressedData);
+	myCompressedFormat = glFormat;
+	myCompressedData = data;
+	myCompressedSize = size;
+	setDirty(true);
+	myLock.unlock();
+}
+
+///////////////////////////////////////////////////////////////////////////////
+void PixelData::clearCompressedData()
+{
+	if(myCompressedData != NULL)
+	{
+		free(myCompressedData);
+		myCompressedData = NULL;
+		myCompressedSize = 0;
+		myCompressedFormat = 0;
+	}
+}
+
+///////////////////////////////////////////////////////////////////////////////
+void PixelData::decodeSourceFile()
+{
+	// Called with the pixel data lock held. Compressed-only pixel data gets 
+	// uncompressed storage, filled by decoding the source image file.
+	if(myData != NULL || checkUsage(PixelBufferObject)) return;
+
+	myData = (byte*)malloc(mySize);
+	myDeleteDisabled = false;
+	myUsageFlags &= ~CompressedStorage;
+
+	Ref<PixelData> decoded;
+	if(!mySourceFile.empty())
+	{
+		std::ifstream fin(mySourceFile.c_str(), std::ios::in | std::ios::binary);
+		if(fin.good()) decoded = ImageUtils::loadImageFromStream(fin, mySourceFile);
+	}
+	if(!decoded.isNull() && decoded->getSize() == mySize)
+	{
+		memcpy(myData, decoded->map(true), mySize);
+		decoded->unmap();
+	}
+	else
+	{
+		ofwarn("PixelData::decodeSourceFile: could not decode %1%", %mySourceFile);
+		memset(myData, 0, mySize);
+	}
 }
 
 ///////////////////////////////////////////////////////////////////////////////
@@ -121,6 +181,8 @@ void PixelData::resize(int width, int height)
 		if(!myDeleteDisabled) free(myData);
 		updateSize();
 		myData = (byte*)malloc(mySize);
+		clearCompressedData();
+		myTextureCacheKey = "";
 
 		setDirty(true);
 		myLock.unlock();
@@ -158,13 +220,21 @@ int PixelData::getBpp()
 }
 
 ///////////////////////////////////////////////////////////////////////////////
-byte* PixelData::map()
+byte* PixelData::map(bool readOnly)
 {
 	myLock.lock();
+	// Pixel data loaded from the texture cache is decoded first.
+	if(checkUsage(CompressedStorage)) decodeSourceFile();
+	// Pixels are about to change: compressed data and cache key are stale.
+	if(!readOnly)
+	{
+		clearCompressedData();
+		myTextureCacheKey = "";
+	}
 	if(checkUsage(PixelBufferObject))
 	{
 		glBindBuffer(GL_PIXEL_UNPACK_BUFFER, myPBOId);
-        byte* ptr = (byte*)glMapBuffer(GL_PIXEL_UNPACK_BUFFER, GL_WRITE_ONLY);
+        byte* ptr = (byte*)glMapBuffer(GL_PIXEL_UNPACK_BUFFER, readOnly ? GL_READ_ONLY : GL_WRITE_ONLY);
 		return ptr;
 	}
 	return myData;
@@ -259,7 +329,7 @@ void PixelData::copyFrom(PixelData* other)
 		}
 
 		void* meptr = map();
-		void* otherptr = other->map();
+		void* otherptr = other->map(true);
 		memcpy(meptr, otherptr, mySize);
 		unmap();
 		other->unmap();
@@ -270,6 +340,22 @@ void PixelData::copyFrom(PixelData* other)
 ///////////////////////////////////////////////////////////////////////////////
 void PixelData::refreshTexture(Texture* texture, const DrawContext& context)
 {
+	if(myCompressedData != NULL)
+	{
+		if(GLEW_EXT_texture_compression_s3tc)
+		{
+			myLock.lock();
+			texture->initializeCompressed(myWidth, myHeight, myCompressedFormat, myCompressedData, myCompressedSize);
+			myLock.unlock();
+			return;
+		}
+		// No S3TC support on this gpu: upload uncompressed pixels, decoding
+		// them from the source file if needed.
+		myLock.lock();
+		if(checkUsage(CompressedStorage)) decodeSourceFile();
+		myLock.unlock();
+	}
+
 	if(!texture->isInitialized()) texture->initialize(myWidth, myHeight);
 	texture->writePixels(this);
 }
@@ -0,0 +1,197 @@
+/******************************************************************************
+ * THE OMEGA LIB PROJECT
+ *-----------------------------------------------------------------------------
+ * Copyright 2010-2013		Electronic Visualization Laboratory, 
+ *							University of Illinois at Chicago
+ * Authors:										
+ *  Alessandro Febretti		febret@gmail.com
+ *-----------------------------------------------------------------------------
+ * Copyright (c) 2010-2013, Electronic Visualization Laboratory,  
+ * University of Illinois at Chicago
+ * All rights reserved.
+ * Redistribution and use in source and binary forms, with or without modification, 
+ * are permitted provided that the following conditions are met:
+ * 
+ * Redistributions of source code must retain the above copyright notice, this 
+ * list of conditions and the following disclaimer. Redistributions in binary 
+ * form must reproduce the above copyright notice, this list of conditions and 
+ * the following disclaimer in the documentation and/or other materials provided 
+ * with the distribution. 
+ * 
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" 
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO THE 
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE 
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE 
+ * LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL 
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE  GOODS OR 
+ * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER 
+ * CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, 
+ * OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE 
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ *-----------------------------------------------------------------------------
+ * What's in this file
+ *	A filter that smooths tracker poses and extrapolates them to the expected
+ *	display time, to reduce perceived motion-to-photon latency.
+ ******************************************************************************/
+#include "omega/PosePredictor.h"
+#include "omega/SystemManager.h"
+#include "omega/DisplaySystem.h"
+
+using namespace omega;
+
+///////////////////////////////////////////////////////////////////////////////
+// Returns the smoothing factor of an exponential filter with the specified
+// cutoff frequency, for a sample interval dt.
+inline float smoothingFactor(float cutoff, float dt)
+{
+    float tau = 1.0f / (2.0f * (float)Math::Pi * cutoff);
+    return 1.0f / (1.0f + tau / dt);
+}
+
+///////////////////////////////////////////////////////////////////////////////
+PosePredictor::PosePredictor():
+    myMinCutoff(1.0f),
+    myBeta(0.5f),
+    myDerivativeCutoff(1.0f),
+    myPredictionTime(-1.0f),
+    myMaxPredictionTime(0.1f),
+    myFrameTime(0),
+    myLastSampleUpdateTime(0)
+{
+    reset();
+}
+
+///////////////////////////////////////////////////////////////////////////////
+void PosePredictor::setup(const Setting& s)
+{
+    myMinCutoff = Config::getFloatValue("minCutoff", s, myMinCutoff);
+    myBeta = Config::getFloatValue("beta", s, myBeta);
+    myDerivativeCutoff = Config::getFloatValue("derivativeCutoff", s, myDerivativeCutoff);
+    myPredictionTime = Config::getFloatValue("predictionTime", s, myPredictionTime);
+    myMaxPredictionTime = Config::getFloatValue("maxPredictionTime", s, myMaxPredictionTime);
+}
+
+///////////////////////////////////////////////////////////////////////////////
+void PosePredictor::reset()
+{
+    myHasSamples = false;
+    myNewSample = false;
+    myLastSampleTime = 0;
+    myPosition = Vector3f::Zero();
+    myVelocity = Vector3f::Zero();
+    myOrientation = Quaternion::Identity();
+    myAngularVelocity = Vector3f::Zero();
+}
+
+///////////////////////////////////////////////////////////////////////////////
+void PosePredictor::addSample(double time, const Vector3f& position, const Quaternion& orientation)
+{
+    float dt = (float)(time - myLastSampleTime);
+
+    // Duplicate or out of order sample: skip it. Velocities can not be 
+    // computed from it, and restarting the filter would drop them.
+    if(myHasSamples && dt <= 0) return;
+
+    // First sample, or a gap in the sample timestamps: restart the filter 
+    // from this sample.
+    if(!myHasSamples || dt > 1.0f)
+    {
+        myPosition = position;
+        myOrientation = orientation;
+        myVelocity = Vector3f::Zero();
+        myAngularVelocity = Vector3f::Zero();
+        myLastSampleTime = time;
+        myHasSamples = true;
+        myNewSample = true;
+        return;
+    }
+
+    // Position: filter the velocity, then use its magnitude to adapt the 
+    // position cutoff frequency.
+    Vector3f velocity = (position - myPosition) / dt;
+    myVelocity += (velocity - myVelocity) * smoothingFactor(myDerivativeCutoff, dt);
+    float cutoff = myMinCutoff + myBeta * myVelocity.norm();
+    myPosition += (position - myPosition) * smoothingFactor(cutoff, dt);
+
+    // Orientation: same as above, using the angular velocity.
+    AngleAxis delta(orientation * myOrientation.inverse());
+    float angle = delta.angle();
+    // Take the shortest rotation.
+    if(angle > Math::Pi) angle -= 2.0f * (float)Math::Pi;
+    Vector3f angularVelocity = delta.axis() * (angle / dt);
+    myAngularVelocity += (angularVelocity - myAngularVelocity) * smoothingFactor(myDerivativeCutoff, dt);
+    cutoff = myMinCutoff + myBeta * myAngularVelocity.norm();
+    myOrientation = myOrientation.slerp(smoothingFactor(cutoff, dt), orientation);
+
+    myLastSampleTime = time;
+    myNewSample = true;
+}
+
+///////////////////////////////////////////////////////////////////////////////
+bool PosePredictor::predict(const UpdateContext& context, Vector3f* position, Quaternion* orientation)
+{
+    if(!myHasSamples) return false;
+
+    // Keep a running average of the frame time, used to estimate the latency
+    // between this update and the display of the frame.
+    if(myFrameTime == 0) myFrameTime = context.dt;
+    else myFrameTime += (context.dt - myFrameTime) * 0.1f;
+
+    if(myNewSample)
+    {
+        myLastSampleUpdateTime = context.time;
+        myNewSample = false;
+    }
+
+    // Also account for the age of the last sample.
+    float horizon = getLatency() + context.time - myLastSampleUpdateTime;
+
+    predict(horizon, position, orientation);
+    return true;
+}
+
+///////////////////////////////////////////////////////////////////////////////
+bool PosePredictor::predictLate(const UpdateContext& context, Vector3f* position, Quaternion* orientation)
+{
+    if(!myHasSamples) return false;
+
+    // Samples added after the update are as recent as the update itself.
+    float horizon = getLatency();
+    if(!myNewSample) horizon += context.time - myLastSampleUpdateTime;
+
+    predict(horizon, position, orientation);
+    return true;
+}
+
+///////////////////////////////////////////////////////////////////////////////
+float PosePredictor::getLatency()
+{
+    if(myPredictionTime >= 0) return myPredictionTime;
+
+    // The frame will be displayed after <latency> more frames plus the
+    // time needed to draw it.
+    int latency = 0;
+    DisplaySystem* ds = SystemManager::instance()->getDisplaySystem();
+    if(ds != NULL) latency = ds->getDisplayConfig().latency;
+    return myFrameTime * (latency + 1);
+}
+
+///////////////////////////////////////////////////////////////////////////////
+void PosePredictor::predict(float horizon, Vector3f* position, Quaternion* orientation)
+{
+    if(horizon > myMaxPredictionTime) horizon = myMaxPredictionTime;
+    if(horizon < 0) horizon = 0;
+
+    *position = myPosition + myVelocity * horizon;
+
+    float speed = myAngularVelocity.norm();
+    if(speed > 0)
+    {
+        *orientation = AngleAxis(speed * horizon, myAngularVelocity / speed) * myOrientation;
+        orientation->normalize();
+    }
+    else
+    {
+        *orientation = myOrientation;
+    }
+}
@@ -38,6 +38,7 @@
 #include "omega/ModuleServices.h"
 #include "omega/SystemManager.h"
 #include "omega/DisplaySystem.h"
+#include "omega/FrameArena.h"
 
 using namespace omega;
 
@@ -486,6 +487,24 @@ void PythonInterpreter::cleanRun(const String& filename)
 	queueCommand(ostr("from omega import *; from euclid import *; orun(\"%1%\")", %filename), true);
 }
 
+///////////////////////////////////////////////////////////////////////////////
+// Returns a readable name for a python callable, as module.function
+static String getCallbackName(PyObject* callback)
+{
+	String name = "<callback>";
+	PyObject* attr = PyObject_GetAttrString(callback, "__name__");
+	if(attr != NULL && PyString_Check(attr)) name = PyString_AsString(attr);
+	Py_XDECREF(attr);
+
+	attr = PyObject_GetAttrString(callback, "__module__");
+	if(attr != NULL && PyString_Check(attr)) name = ostr("%1%.%2%", %PyString_AsString(attr) %name);
+	Py_XDECREF(attr);
+
+	// Callables without these attributes are fine, just drop the error.
+	PyErr_Clear();
+	return name;
+}
+
 ///////////////////////////////////////////////////////////////////////////////
 void PythonInterpreter::registerCallback(void* callback, CallbackType type)
 {
@@ -494,16 +513,26 @@ void PythonInterpreter::registerCallback(void* callback, CallbackType type)
 	if(callback != NULL)
 	{
 		Py_INCREF(pyCallback);
+
+		ScriptCallback sc;
+		sc.callback = callback;
+		sc.frameTime = 0;
+		StatsManager* sm = SystemManager::instance()->getStatsManager();
+		String name = getCallbackName(pyCallback);
+
 		switch(type)
 		{
 		case CallbackUpdate:
-			myUpdateCallbacks.push_back(callback);
+			sc.timeStat = sm->createUniqueStat("Script update " + name, StatsManager::Time);
+			myUpdateCallbacks.push_back(sc);
 			return;
 		case CallbackEvent:
-			myEventCallbacks.push_back(callback);
+			sc.timeStat = sm->createUniqueStat("Script events " + name, StatsManager::Time);
+			myEventCallbacks.push_back(sc);
 			return;
 		case CallbackDraw:
-			myDrawCallbacks.push_back(callback);
+			sc.timeStat = sm->createUniqueStat("Script draw " + name, StatsManager::Time);
+			myDrawCallbacks.push_back(sc);
 			return;
 		}
 	}
@@ -524,7 +553,7 @@ void PythonInterpreter::update(const UpdateContext& context)
 	if(myCommandQueue.size() != 0)
 	{
 		// List of commands to be removed from queue
-		List<QueuedCommand*> cmdsToRemove;
+		FrameVector<QueuedCommand*>::Type cmdsToRemove;
 		foreach(QueuedCommand* qc, myCommandQueue)
 		{
 			if(qc->needsExecute) 
@@ -549,14 +578,24 @@ void PythonInterpreter::update(const UpdateContext& context)
 		myInteractiveCommandLock.unlock();
 	}
 	
+	// Events for this frame have been dispatched: sample the event callbacks
+	// cost.
+	foreach(ScriptCallback& sc, myEventCallbacks)
+	{
+		sc.timeStat->addSample(sc.frameTime);
+		sc.frameTime = 0;
+	}
+
 	PyObject *arglist;
 	arglist = Py_BuildValue("(lff)", (long int)context.frameNum, context.time, context.dt);
 
-	foreach(void* cb, myUpdateCallbacks)
+	foreach(ScriptCallback& sc, myUpdateCallbacks)
 	{
 		// BLAGH cast
-		PyObject* pyCallback =(PyObject*)cb;
+		PyObject* pyCallback =(PyObject*)sc.callback;
+		sc.timeStat->startTiming();
 		PyObject_CallObject(pyCallback, arglist);
+		sc.timeStat->stopTiming();
 	}
 
 	Py_DECREF(arglist);
@@ -572,6 +611,10 @@ void PythonInterpreter::queueCommand(const String& command, bool local)
 	myInteractiveCommandLock.lock();
 	myCommandQueue.push_back(new QueuedCommand(command, true, !local));
 	myInteractiveCommandLock.unlock();
+
+	// Queued commands are executed during frame updates: make sure an idle
+	// display runs a frame.
+	DisplaySystem::requestRedraw();
 }
 
 ///////////////////////////////////////////////////////////////////////////////
@@ -615,11 +658,14 @@ void PythonInterpreter::handleEvent(const Event& evt)
 	// Script code will be able to retrieve it using getEvent()
 	mysLastEvent = &evt;
 
-	foreach(void* cb, myEventCallbacks)
+	foreach(ScriptCallback& sc, myEventCallbacks)
 	{
 		// BLAGH cast
-		PyObject* pyCallback =(PyObject*)cb;
+		PyObject* pyCallback =(PyObject*)sc.callback;
+		myCallbackTimer.start();
 		PyObject_CallObject(pyCallback, NULL);
+		myCallbackTimer.stop();
+		sc.frameTime += myCallbackTimer.getElapsedTimeInMilliSec();
 	}
 
 	// We can't guarantee the event will live outside of this call tree, so 
@@ -648,12 +694,15 @@ void PythonInterpreter::draw(const DrawContext& context, Camera* cam)
 		boost::python::object odi(boost::python::ptr(di));
 
 		arglist = Py_BuildValue("((ii)(ii)OO)", width, height, tileWidth, tileHeight, ocam.ptr(), odi.ptr());
-		foreach(void* cb, myDrawCallbacks)
+		// Draw callbacks run with the interpreter locked, so render threads 
+		// do not race on the callback stats.
+		foreach(ScriptCallback& sc, myDrawCallbacks)
 		{
 			// BLAGH cast
-			PyObject* pyCallback =(PyObject*)cb;
+			PyObject* pyCallback =(PyObject*)sc.callback;
+			sc.timeStat->startTiming();
 			PyObject_CallObject(pyCallback, arglist);
-
+			sc.timeStat->stopTiming();
 		}
 		Py_DECREF(arglist);
 		unlockInterpreter();
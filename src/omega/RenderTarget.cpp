@@ -42,7 +42,8 @@ RenderTarget::RenderTarget(GpuContext* context, Type type, GLuint id):
     myRbHeight(0),
     myTextureColorTarget(NULL),
     myTextureDepthTarget(NULL),
-    myBound(false)
+    myBound(false),
+    myPreviousId(0)
 {
     if(myType != RenderOnscreen && myId == 0)
     {
@@ -65,6 +66,17 @@ void RenderTarget::dispose()
         glDeleteFramebuffers(1, &myId);
         myId = 0;
     }
+    if(myRbColorId != 0)
+    {
+        glDeleteRenderbuffers(1, &myRbColorId);
+        glDeleteRenderbuffers(1, &myRbDepthId);
+        myRbColorId = 0;
+        myRbDepthId = 0;
+        // Color (RGBA8) and depth (DEPTH32) renderbuffer storage.
+        getContext()->removeResidentBytes((size_t)myRbWidth * myRbHeight * 8);
+        myRbWidth = 0;
+        myRbHeight = 0;
+    }
 }
 
 ///////////////////////////////////////////////////////////////////////////////////////////////
@@ -128,7 +140,9 @@ void RenderTarget::unbind()
 
     if(myBound)
     {
-        glBindFramebuffer(GL_FRAMEBUFFER, 0);
+        // Restore the frame buffer that was bound before this target, so
+        // render targets can be nested.
+        glBindFramebuffer(GL_FRAMEBUFFER, myPreviousId);
         myBound = false;
         glPopAttrib();
     }
@@ -186,6 +200,10 @@ void RenderTarget::bind()
 {
     //omsg("RenderTarget::bind");
 
+    GLint previousId = 0;
+    glGetIntegerv(GL_FRAMEBUFFER_BINDING, &previousId);
+    if(!myBound) myPreviousId = previousId;
+
     glBindFramebuffer(GL_FRAMEBUFFER, myId);
     if(oglError) return;
 
@@ -221,6 +239,8 @@ void RenderTarget::bind()
         }
         if(myRbWidth != myReadbackColorTarget->getWidth() || myRbHeight != myReadbackColorTarget->getHeight())
         {
+            // Color (RGBA8) and depth (DEPTH32) renderbuffer storage.
+            getContext()->removeResidentBytes((size_t)myRbWidth * myRbHeight * 8);
             myRbWidth = myReadbackColorTarget->getWidth();
             myRbHeight = myReadbackColorTarget->getHeight();
             glBindRenderbuffer(GL_RENDERBUFFER, myRbColorId);
@@ -228,6 +248,7 @@ void RenderTarget::bind()
             glBindRenderbuffer(GL_RENDERBUFFER, myRbDepthId);
             glRenderbufferStorage(GL_RENDERBUFFER, GL_DEPTH_COMPONENT32, myRbWidth, myRbHeight);
             glBindRenderbuffer(GL_RENDERBUFFER, 0);
+            getContext()->addResidentBytes((size_t)myRbWidth * myRbHeight * 8);
         }
 
         glFramebufferRenderbuffer(GL_FRAMEBUFFER, GL_COLOR_ATTACHMENT0, GL_RENDERBUFFER, myRbColorId);
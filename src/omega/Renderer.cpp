@@ -39,13 +39,38 @@
 #include "omega/DisplaySystem.h"
 #include "omega/Texture.h"
 #include "omega/PythonInterpreter.h"
+#include "omega/FrameArena.h"
 #include "omega/glheaders.h"
 
 using namespace omega;
 
+// Maximum number of resources checked for disposal every frame.
+static const int sResourcesCollectedPerFrame = 32;
+
+uint Renderer::mysNumRenderers = 0;
+Lock Renderer::mysRendererLock = Lock();
+
 ///////////////////////////////////////////////////////////////////////////////
 Renderer::Renderer(Engine* engine)
 {
+	mysRendererLock.lock();
+	myId = mysNumRenderers++;
+	mysRendererLock.unlock();
+
+	myCollectIterator = myResources.end();
+	myTextureUploadBudget = 0;
+	myDynamicResolutionEnabled = false;
+	myTargetFrameTime = 16.0f;
+	myMinResolutionScale = 0.5f;
+	myResolutionScale = 1.0f;
+	myFrameTimeTolerance = 0.1f;
+	myGpuTimerIndex = 0;
+	myGpuTimerPending = 0;
+	myGpuTimerInitialized = false;
+	myGpuTimerSupported = false;
+	myGpuTimerActive = false;
+	mySavedPixels = 0;
+	mySavedPixelsFrame = 0;
 	myRenderer = new DrawInterface();
 	myServer = engine;
 	myServer->addRenderer(this);
@@ -67,6 +92,85 @@ RenderTarget* Renderer::createRenderTarget(RenderTarget::Type type)
 	return rt;
 }
 
+///////////////////////////////////////////////////////////////////////////////
+void Renderer::releaseResource(GpuResource* res)
+{
+	List< Ref<GpuResource> >::iterator it = 
+		std::find(myResources.begin(), myResources.end(), res);
+	if(it != myResources.end())
+	{
+		if(it == myCollectIterator) myCollectIterator++;
+		myReleaseQueue.push_back(*it);
+		myResources.erase(it);
+	}
+}
+
+///////////////////////////////////////////////////////////////////////////////
+void Renderer::collectUnusedResources(bool all)
+{
+	// Resources only referenced by the resource list are unused. Move them
+	// to the release queue.
+	int n = all ? myResources.size() : sResourcesCollectedPerFrame;
+	while(n > 0 && !myResources.empty())
+	{
+		if(myCollectIterator == myResources.end()) myCollectIterator = myResources.begin();
+		GpuResource* res = *myCollectIterator;
+		if(res->refCount() == 1 || all)
+		{
+			myReleaseQueue.push_back(*myCollectIterator);
+			myCollectIterator = myResources.erase(myCollectIterator);
+		}
+		else
+		{
+			myCollectIterator++;
+		}
+		n--;
+	}
+}
+
+///////////////////////////////////////////////////////////////////////////////
+bool TextureLruSortOp(Texture* t1, Texture* t2)
+{ return t1->getLastUsedFrame() < t2->getLastUsedFrame(); }
+
+///////////////////////////////////////////////////////////////////////////////
+void Renderer::evictTextures(const FrameInfo& frame)
+{
+	GpuContext* ctx = getGpuContext();
+	if(!ctx->isOverBudget()) return;
+
+	// Collect evictable textures that have not been used this frame, and 
+	// dispose them starting from the least recently used, until we are back
+	// within budget. Evicted textures will be regenerated by their 
+	// TextureSource the next time they are requested.
+	Vector<Texture*> candidates;
+	foreach(GpuResource* res, myResources)
+	{
+		Texture* tex = dynamic_cast<Texture*>(res);
+		if(tex != NULL && tex->isEvictable() && tex->isInitialized() &&
+			tex->getLastUsedFrame() < frame.frameNum)
+		{
+			candidates.push_back(tex);
+		}
+	}
+	std::sort(candidates.begin(), candidates.end(), TextureLruSortOp);
+
+	int evicted = 0;
+	foreach(Texture* tex, candidates)
+	{
+		if(!ctx->isOverBudget()) break;
+		tex->dispose();
+		evicted++;
+	}
+	if(ctx->isOverBudget())
+	{
+		ofwarn("Renderer(%1%): gpu memory over budget (%2% / %3% MB) after evicting %4% textures", 
+			%ctx->getId() 
+			%(ctx->getResidentBytes() / (1024 * 1024)) 
+			%(ctx->getMemoryBudget() / (1024 * 1024))
+			%evicted);
+	}
+}
+
 ///////////////////////////////////////////////////////////////////////////////
 bool RenderPassSortOp(RenderPass* p1, RenderPass* r2)
 { return p1->getPriority() < r2->getPriority(); }
@@ -113,6 +217,9 @@ RenderPass* Renderer::getRenderPass(const String& name)
 void Renderer::initialize()
 {
 	ofmsg("@Renderer::Initialize: id = %1%", %getGpuContext()->getId());
+	SystemManager* sys = getEngine()->getSystemManager();
+	String phase = ostr("ctx%1% renderer%2% initialize", %getGpuContext()->getId() %myId);
+	sys->beginStartupPhase(phase);
 
 	// Create the default font.
 	const FontInfo& fi = myServer->getDefaultFont();
@@ -124,6 +231,50 @@ void Renderer::initialize()
 
 	StatsManager* sm = getEngine()->getSystemManager()->getStatsManager();
 	myFrameTimeStat = sm->createStat(ostr("ctx%1% frame", %getGpuContext()->getId()), StatsManager::Time);
+	// Resident gpu memory, in megabytes.
+	myGpuMemoryStat = sm->createStat(ostr("ctx%1% gpu memory", %getGpuContext()->getId()), StatsManager::Memory);
+	// Scene resolution scale, in percent of the native tile resolution.
+	myResolutionScaleStat = sm->createStat(ostr("ctx%1% resolution scale", %getGpuContext()->getId()), StatsManager::Count1);
+	// Gpu time of this renderer frames, measured when dynamic resolution is
+	// enabled.
+	myGpuFrameTimeStat = sm->createStat(ostr("ctx%1% renderer%2% gpu frame", %getGpuContext()->getId() %myId), StatsManager::Time);
+
+	// Read the gpu memory budget (in megabytes, 0 = no budget)
+	Config* syscfg = getEngine()->getSystemManager()->getSystemConfig();
+	if(syscfg->exists("config"))
+	{
+		Setting& scfg = syscfg->lookup("config");
+		int budget = Config::getIntValue("gpuMemoryBudget", scfg, 0);
+		getGpuContext()->setMemoryBudget((size_t)budget * 1024 * 1024);
+		// Maximum texture data uploaded at each frame start (in megabytes, 
+		// 0 = no limit). Textures that do not fit are uploaded by following
+		// frames, or when drawn.
+		int uploadBudget = Config::getIntValue("textureUploadBudget", scfg, 0);
+		myTextureUploadBudget = (size_t)uploadBudget * 1024 * 1024;
+
+		// Dynamic resolution settings
+		if(scfg.exists("dynamicResolution"))
+		{
+			Setting& sdr = scfg["dynamicResolution"];
+			myDynamicResolutionEnabled = Config::getBoolValue("enabled", sdr, true);
+			myTargetFrameTime = Config::getFloatValue("targetFrameTime", sdr, myTargetFrameTime);
+			myMinResolutionScale = Config::getFloatValue("minScale", sdr, myMinResolutionScale);
+			myFrameTimeTolerance = Config::getFloatValue("tolerance", sdr, myFrameTimeTolerance);
+		}
+
+		// Tile quality settings
+		if(scfg.exists("tileQuality"))
+		{
+			myTileQualityPolicy = new TileQualityPolicy();
+			myTileQualityPolicy->setup(scfg["tileQuality"]);
+		}
+	}
+	if(myDynamicResolutionEnabled || myTileQualityPolicy != NULL)
+	{
+		// Pixels not drawn in a frame because of reduced tile quality.
+		mySavedPixelsStat = sm->createStat(ostr("ctx%1% pixels saved", %getGpuContext()->getId()), StatsManager::Count2);
+	}
+	sys->endStartupPhase(phase);
 }
 
 ///////////////////////////////////////////////////////////////////////////////
@@ -138,16 +289,44 @@ void Renderer::queueCommand(IRendererCommand* cmd)
 void Renderer::startFrame(const FrameInfo& frame)
 {
 	myFrameTimeStat->startTiming();
-	foreach(Ref<Camera> cam, myServer->getCameras())
+	if(myDynamicResolutionEnabled) beginGpuTiming();
+
+	// Release the transient allocations made by this thread last frame.
+	FrameArena::reset();
+
+	// A context may draw several channels per frame: pixels saved are 
+	// accumulated over all channels and sampled once per frame.
+	if(mySavedPixelsStat != NULL && frame.frameNum != mySavedPixelsFrame)
+	{
+		if(mySavedPixelsFrame != 0) mySavedPixelsStat->addSample((double)mySavedPixels);
+		mySavedPixels = 0;
+		mySavedPixelsFrame = frame.frameNum;
+	}
+
+	FrameVector< Ref<Camera> >::Type cameras;
+	myServer->getCameras(cameras);
+	foreach(Ref<Camera> cam, cameras)
 	{
 		cam->startFrame(frame);
 	}
+
+	// Run staged texture uploads for this context. Texture sources see the
+	// tile and default camera this renderer draws with. Queued uploads wait
+	// until the renderer has drawn its first frame.
+	if(myUploadContext.tile != NULL)
+	{
+		myUploadContext.frameNum = frame.frameNum;
+		myUploadContext.camera = myServer->getDefaultCamera();
+		getGpuContext()->processTextureUploads(myUploadContext, myTextureUploadBudget);
+	}
 }
 
 ///////////////////////////////////////////////////////////////////////////////
 void Renderer::finishFrame(const FrameInfo& frame)
 {
-	foreach(Ref<Camera> cam, myServer->getCameras())
+	FrameVector< Ref<Camera> >::Type cameras;
+	myServer->getCameras(cameras);
+	foreach(Ref<Camera> cam, cameras)
 	{
 		cam->finishFrame(frame);
 	}
@@ -155,30 +334,201 @@ void Renderer::finishFrame(const FrameInfo& frame)
 	bool shuttingDown = SystemManager::instance()->isExitRequested();
 
 	// Dispose of unused resources. When shutting down, clean everything.
-	List<GpuResource*> txlist;
-	foreach(GpuResource* tex, myResources)
+	collectUnusedResources(shuttingDown);
+	foreach(GpuResource* res, myReleaseQueue) res->dispose();
+	myReleaseQueue.clear();
+
+	if(!shuttingDown) evictTextures(frame);
+
+	// The gpu memory stat is shared by all renderers on this context.
+	if(getGpuContext()->beginStatsSample(frame.frameNum))
 	{
-		if(tex->refCount() == 1 || shuttingDown)
+		myGpuMemoryStat->addSample((double)getGpuContext()->getResidentBytes() / (1024 * 1024));
+	}
+	myFrameTimeStat->stopTiming();
+
+	// The resolution scale follows the gpu time of this renderer. Without 
+	// timer queries, use the cpu time of the context frame.
+	float frameTime = 0;
+	bool newFrameTime = endGpuTiming(&frameTime);
+	if(myDynamicResolutionEnabled)
+	{
+		if(!myGpuTimerSupported)
 		{
-			tex->dispose();
-			txlist.push_back(tex);
+			frameTime = myFrameTimeStat->getCur();
+			newFrameTime = true;
 		}
+		if(newFrameTime) updateResolutionScale(frameTime);
 	}
-	foreach(GpuResource* gr, txlist) myResources.remove(gr);
-	myFrameTimeStat->stopTiming();
+
+	SystemManager::instance()->notifyFrameFinished();
+}
+
+///////////////////////////////////////////////////////////////////////////////
+void Renderer::beginGpuTiming()
+{
+	if(!myGpuTimerInitialized)
+	{
+		myGpuTimerInitialized = true;
+		myGpuTimerSupported = GLEW_ARB_timer_query || GLEW_VERSION_3_3;
+		if(myGpuTimerSupported) glGenQueries(GpuTimerQueries, myGpuTimerQueries);
+		else owarn("Renderer: gpu timer queries not supported. Dynamic resolution will use the cpu frame time.");
+	}
+	if(!myGpuTimerSupported) return;
+
+	glBeginQuery(GL_TIME_ELAPSED, myGpuTimerQueries[myGpuTimerIndex]);
+	myGpuTimerActive = true;
+}
+
+///////////////////////////////////////////////////////////////////////////////
+bool Renderer::endGpuTiming(float* frameTime)
+{
+	// Dynamic resolution may have been toggled after the frame started: end
+	// the query only if one was started.
+	if(!myGpuTimerActive) return false;
+	glEndQuery(GL_TIME_ELAPSED);
+	myGpuTimerActive = false;
+
+	myGpuTimerIndex = (myGpuTimerIndex + 1) % GpuTimerQueries;
+	if(myGpuTimerPending < GpuTimerQueries) myGpuTimerPending++;
+	if(myGpuTimerPending < GpuTimerQueries) return false;
+
+	// Read the oldest query, the one that will be reused next frame.
+	GLuint query = myGpuTimerQueries[myGpuTimerIndex];
+	GLint available = 0;
+	glGetQueryObjectiv(query, GL_QUERY_RESULT_AVAILABLE, &available);
+	if(!available) return false;
+
+	GLuint64 elapsed = 0;
+	glGetQueryObjectui64v(query, GL_QUERY_RESULT, &elapsed);
+	// Query results are in nanoseconds.
+	*frameTime = (float)(elapsed / 1000000.0);
+	myGpuFrameTimeStat->addSample(*frameTime);
+	return true;
+}
+
+///////////////////////////////////////////////////////////////////////////////
+void Renderer::updateResolutionScale(float frameTime)
+{
+	if(frameTime <= 0) return;
+
+	// Only react when the frame time leaves the tolerance band around the 
+	// target, to avoid changing the resolution at every frame.
+	float ratio = myTargetFrameTime / frameTime;
+	if(ratio < 1.0f - myFrameTimeTolerance || ratio > 1.0f + myFrameTimeTolerance)
+	{
+		// Scene draw time is roughly proportional to the number of pixels,
+		// that is to the square of the resolution scale. Move the scale 
+		// gradually towards the value that would meet the target.
+		float desiredScale = myResolutionScale * sqrtf(ratio);
+		myResolutionScale += (desiredScale - myResolutionScale) * 0.25f;
+		if(myResolutionScale < myMinResolutionScale) myResolutionScale = myMinResolutionScale;
+		if(myResolutionScale > 1.0f) myResolutionScale = 1.0f;
+	}
+	myResolutionScaleStat->addSample(myResolutionScale * 100);
+}
+
+///////////////////////////////////////////////////////////////////////////////
+float Renderer::getSceneResolutionScale(const DrawContext& context)
+{
+	float scale = context.tileResolutionScale;
+	if(myDynamicResolutionEnabled) scale *= myResolutionScale;
+	return scale;
+}
+
+///////////////////////////////////////////////////////////////////////////////
+void Renderer::beginScaledSceneDraw(DrawContext& context, float scale)
+{
+	// Targets are allocated at the full tile resolution: the scene is drawn
+	// to a part of the target, so changing the resolution scale does not
+	// require reallocating gpu memory.
+	ScaledSceneTarget& sst = myScaledSceneTargets[context.tile];
+	int width = context.tile->pixelSize[0];
+	int height = context.tile->pixelSize[1];
+	if(sst.target == NULL)
+	{
+		sst.color = createTexture();
+		sst.depth = createTexture();
+		sst.target = createRenderTarget(RenderTarget::RenderToTexture);
+	}
+	if(!sst.color->isInitialized() || 
+		sst.color->getWidth() != width || sst.color->getHeight() != height)
+	{
+		sst.color->initialize(width, height);
+		sst.depth->initialize(width, height, GL_DEPTH_COMPONENT, GL_DEPTH_COMPONENT24);
+		sst.target->setTextureTarget(sst.color, sst.depth);
+	}
+
+	sst.scale = scale;
+	context.resolutionScale = scale;
+	sst.target->bind();
+	sst.target->clear();
+}
+
+///////////////////////////////////////////////////////////////////////////////
+void Renderer::endScaledSceneDraw(DrawContext& context)
+{
+	ScaledSceneTarget& sst = myScaledSceneTargets[context.tile];
+	sst.target->unbind();
+	context.resolutionScale = 1.0f;
+	drawScaledScene(context);
+}
+
+///////////////////////////////////////////////////////////////////////////////
+void Renderer::drawScaledScene(DrawContext& context)
+{
+	ScaledSceneTarget& sst = myScaledSceneTargets[context.tile];
+	if(sst.target == NULL) return;
+
+	// Compute the target area the scene has been drawn to. For side-by-side
+	// stereo, this includes both eye viewports.
+	int width = context.tile->pixelSize[0];
+	int height = context.tile->pixelSize[1];
+	Vector2f maxUV(
+		(float)(int)(width * sst.scale) / width,
+		(float)(int)(height * sst.scale) / height);
+
+	// Upscale the scene into the tile viewport.
+	Rect viewport = context.viewport;
+	context.viewport = Rect(0, 0, width, height);
+	DrawInterface* di = getRenderer();
+	di->beginDraw2D(context);
+	// The scene replaces the tile contents: draw it without blending, and 
+	// restore the blend state for the overlays drawn after it.
+	GLboolean blendEnabled = glIsEnabled(GL_BLEND);
+	glDisable(GL_BLEND);
+	glColor4f(1, 1, 1, 1);
+	di->drawRectTexture(sst.color, 
+		Vector2f(context.tile->offset[0], context.tile->offset[1]), 
+		Vector2f(width, height), 0, Vector2f::Zero(), maxUV);
+	if(blendEnabled) glEnable(GL_BLEND);
+	di->endDraw();
+	context.viewport = viewport;
 }
 
 ///////////////////////////////////////////////////////////////////////////////
 void Renderer::draw(DrawContext& context)
 {
 	myRenderPassLock.lock();
-	// First of all make sure all render passes are initialized.
+	// First of all make sure all render passes are initialized. Render passes
+	// created during startup are timed as part of the startup sequence.
+	SystemManager* sys = SystemManager::instance();
+	String phase;
 	foreach(RenderPass* rp, myRenderPassList)
 	{
-		if(!rp->isInitialized()) rp->initialize();
+		if(!rp->isInitialized())
+		{
+			if(phase.empty() && sys->isStartingUp())
+			{
+				phase = ostr("ctx%1% renderer%2% render pass initialize", %getGpuContext()->getId() %myId);
+				sys->beginStartupPhase(phase);
+			}
+			rp->initialize();
+		}
 	}
+	if(!phase.empty()) sys->endStartupPhase(phase);
 	// Now check if some render passes need to be disposed
-	List<RenderPass*> tbdisposed;
+	FrameVector<RenderPass*>::Type tbdisposed;
 	foreach(RenderPass* rp, myRenderPassList)
 	{
 		if(rp->needsDispose())
@@ -199,7 +549,17 @@ void Renderer::draw(DrawContext& context)
 	}
 	myRenderCommandLock.unlock();
 
-	foreach(Ref<Camera> cam, myServer->getCameras())
+	if(myUploadContext.tile == NULL)
+	{
+		myUploadContext.gpuContext = getGpuContext();
+		myUploadContext.renderer = this;
+		myUploadContext.tile = context.tile;
+		myUploadContext.updateViewport();
+	}
+
+	FrameVector< Ref<Camera> >::Type cameras;
+	myServer->getCameras(cameras);
+	foreach(Ref<Camera> cam, cameras)
 	{
 		// See if camera is enabled for the current client and draw context.
 		if(cam->isEnabledInContext(context))
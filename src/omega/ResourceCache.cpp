@@ -0,0 +1,324 @@
+/**************************************************************************************************
+ * THE OMEGA LIB PROJECT
+ *-------------------------------------------------------------------------------------------------
+ * Copyright 2010-2013		Electronic Visualization Laboratory, University of Illinois at Chicago
+ * Authors:										
+ *  Alessandro Febretti		febret@gmail.com
+ *-------------------------------------------------------------------------------------------------
+ * Copyright (c) 2010-2013, Electronic Visualization Laboratory, University of Illinois at Chicago
+ * All rights reserved.
+ * Redistribution and use in source and binary forms, with or without modification, are permitted 
+ * provided that the following conditions are met:
+ * 
+ * Redistributions of source code must retain the above copyright notice, this list of conditions 
+ * and the following disclaimer. Redistributions in binary form must reproduce the above copyright 
+ * notice, this list of conditions and the following disclaimer in the documentation and/or other 
+ * materials provided with the distribution. 
+ * 
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND ANY EXPRESS OR 
+ * IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO THE IMPLIED WARRANTIES OF MERCHANTABILITY AND 
+ * FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR 
+ * CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL 
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE  GOODS OR SERVICES; LOSS OF 
+ * USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, 
+ * WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN 
+ * ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+#include "omega/ResourceCache.h"
+#include "omega/SystemManager.h"
+
+#include <co/base/condition.h>
+#include <sys/stat.h>
+
+using namespace omega;
+
+int ResourceCache::sNumPreloadThreads = 4;
+
+// A cached file. Contents are never deleted, so pointers to cached data stay
+// valid. When the file changes on disk, the entry points to new contents.
+struct CachedFile
+{
+    CachedFile(): data(NULL), modified(0) {}
+    const String* data;
+    time_t modified;
+};
+
+// Cached files, keyed by the requested file name.
+static Dictionary<String, CachedFile> sFiles;
+// Files queued for preloading or being loaded by a preload thread.
+static Dictionary<String, bool> sPendingFiles;
+static Queue<String> sFileQueue;
+// Protects the cache state. Signalled when preload threads finish loading 
+// a file.
+static co::base::Condition sResourceCacheCondition;
+static List<Thread*> sPreloadThreads;
+static int sActivePreloadThreads = 0;
+static bool sPreloadPhaseStarted = false;
+static bool sPreloadPhaseActive = false;
+
+static Dictionary<String, Ref<ImageUtils::LoadImageAsyncTask> > sPreloadedImages;
+
+///////////////////////////////////////////////////////////////////////////////////////////////////
+// Returns the modification time of a data file, or 0 if it can't be found.
+static time_t getModifiedTime(const String& filename)
+{
+    String path;
+    struct stat st;
+    if(!DataManager::findFile(filename, path) || stat(path.c_str(), &st) != 0) return 0;
+    return st.st_mtime;
+}
+
+///////////////////////////////////////////////////////////////////////////////////////////////////
+static bool readFileData(const String& filename, CachedFile& file)
+{
+    String path;
+    if(!DataManager::findFile(filename, path)) return false;
+
+    FILE* f = fopen(path.c_str(), "rb");
+    if(f == NULL) return false;
+
+    struct stat st;
+    file.modified = (stat(path.c_str(), &st) == 0) ? st.st_mtime : 0;
+
+    fseek(f, 0, SEEK_END);
+    size_t size = ftell(f);
+    fseek(f, 0, SEEK_SET);
+    String* data = new String(size, '\0');
+    size_t read = size > 0 ? fread(&(*data)[0], 1, size, f) : 0;
+    fclose(f);
+    if(read != size)
+    {
+        delete data;
+        return false;
+    }
+    file.data = data;
+    return true;
+}
+
+///////////////////////////////////////////////////////////////////////////////////////////////////
+class ResourcePreloadThread: public Thread
+{
+public:
+    virtual void threadProc()
+    {
+        sResourceCacheCondition.lock();
+        while(sFileQueue.size() > 0 && !SystemManager::instance()->isExitRequested())
+        {
+            String filename = sFileQueue.front();
+            sFileQueue.pop();
+            sResourceCacheCondition.unlock();
+
+            CachedFile file;
+            bool found = readFileData(filename, file);
+            if(!found)
+            {
+                ofwarn("ResourcePreloadThread: could not load %1%", %filename);
+            }
+
+            sResourceCacheCondition.lock();
+            if(found) sFiles[filename] = file;
+            sPendingFiles.erase(filename);
+            sResourceCacheCondition.broadcast();
+        }
+
+        sActivePreloadThreads--;
+        if(sActivePreloadThreads == 0 && sFileQueue.size() > 0)
+        {
+            // Exiting with files still queued: readers waiting for them 
+            // will load them directly.
+            while(sFileQueue.size() > 0)
+            {
+                sPendingFiles.erase(sFileQueue.front());
+                sFileQueue.pop();
+            }
+            sResourceCacheCondition.broadcast();
+        }
+        bool done = (sActivePreloadThreads == 0 && sPreloadPhaseActive);
+        if(done) sPreloadPhaseActive = false;
+        sResourceCacheCondition.unlock();
+
+        if(done) SystemManager::instance()->endStartupPhase("preload");
+    }
+};
+
+///////////////////////////////////////////////////////////////////////////////////////////////////
+void ResourceCache::preload(const Setting& s)
+{
+    sNumPreloadThreads = Config::getIntValue("threads", s, sNumPreloadThreads);
+
+    // Only the first preload call starts the preload phase. Following calls
+    // just queue more resources.
+    sResourceCacheCondition.lock();
+    bool startPhase = !sPreloadPhaseStarted;
+    if(startPhase)
+    {
+        sPreloadPhaseStarted = true;
+        sPreloadPhaseActive = true;
+    }
+    sResourceCacheCondition.unlock();
+    if(startPhase) SystemManager::instance()->beginStartupPhase("preload");
+
+    if(s.exists("files"))
+    {
+        const Setting& sf = s["files"];
+        for(int i = 0; i < sf.getLength(); i++) preloadFile((const char*)sf[i]);
+    }
+    if(s.exists("images"))
+    {
+        const Setting& si = s["images"];
+        for(int i = 0; i < si.getLength(); i++) preloadImage((const char*)si[i]);
+    }
+
+    // If nothing was queued, the preload phase is already complete.
+    sResourceCacheCondition.lock();
+    bool done = (sActivePreloadThreads == 0 && sPreloadPhaseActive);
+    if(done) sPreloadPhaseActive = false;
+    sResourceCacheCondition.unlock();
+    if(done) SystemManager::instance()->endStartupPhase("preload");
+}
+
+///////////////////////////////////////////////////////////////////////////////////////////////////
+void ResourceCache::preloadFile(const String& filename)
+{
+    sResourceCacheCondition.lock();
+    if(sFiles.find(filename) == sFiles.end() &&
+        sPendingFiles.find(filename) == sPendingFiles.end())
+    {
+        sPendingFiles[filename] = true;
+        sFileQueue.push(filename);
+    }
+    sResourceCacheCondition.unlock();
+
+    startPreloadThreads();
+}
+
+///////////////////////////////////////////////////////////////////////////////////////////////////
+void ResourceCache::preloadImage(const String& filename)
+{
+    String path;
+    if(!DataManager::findFile(filename, path))
+    {
+        if(!DataManager::findFile(ogetdataprefix() + filename, path))
+        {
+            ofwarn("ResourceCache::preloadImage: could not find %1%", %filename);
+            return;
+        }
+    }
+
+    // Load using the full path: this way the image loader does not look for 
+    // the image in the preload cache.
+    Ref<ImageUtils::LoadImageAsyncTask> task = ImageUtils::loadImageAsync(path, true);
+    sResourceCacheCondition.lock();
+    sPreloadedImages[filename] = task;
+    sResourceCacheCondition.unlock();
+}
+
+///////////////////////////////////////////////////////////////////////////////////////////////////
+void ResourceCache::startPreloadThreads()
+{
+    sResourceCacheCondition.lock();
+    while(sActivePreloadThreads < sNumPreloadThreads && 
+        sActivePreloadThreads < (int)sFileQueue.size())
+    {
+        Thread* t = new ResourcePreloadThread();
+        sPreloadThreads.push_back(t);
+        sActivePreloadThreads++;
+        t->start();
+    }
+    sResourceCacheCondition.unlock();
+}
+
+///////////////////////////////////////////////////////////////////////////////////////////////////
+const String* ResourceCache::findOrLoadFile(const String& filename)
+{
+    time_t modified = getModifiedTime(filename);
+
+    // If the file is being preloaded, wait for it.
+    sResourceCacheCondition.lock();
+    while(sPendingFiles.find(filename) != sPendingFiles.end())
+    {
+        sResourceCacheCondition.wait();
+    }
+    Dictionary<String, CachedFile>::iterator it = sFiles.find(filename);
+    if(it != sFiles.end() && it->second.modified == modified)
+    {
+        const String* res = it->second.data;
+        sResourceCacheCondition.unlock();
+        return res;
+    }
+    sResourceCacheCondition.unlock();
+
+    // File not in the cache or changed on disk: load it now.
+    CachedFile file;
+    if(!readFileData(filename, file)) return NULL;
+
+    sResourceCacheCondition.lock();
+    // If another thread loaded the same file version in the meantime, keep 
+    // its copy. Replaced contents are not deleted: getFileData callers may
+    // still point to them.
+    it = sFiles.find(filename);
+    if(it == sFiles.end() || it->second.modified != file.modified)
+    {
+        sFiles[filename] = file;
+    }
+    else
+    {
+        delete file.data;
+    }
+    const String* res = sFiles[filename].data;
+    sResourceCacheCondition.unlock();
+    return res;
+}
+
+///////////////////////////////////////////////////////////////////////////////////////////////////
+String ResourceCache::getTextFile(const String& filename)
+{
+    const String* data = findOrLoadFile(filename);
+    if(data == NULL) return "";
+    return *data;
+}
+
+///////////////////////////////////////////////////////////////////////////////////////////////////
+bool ResourceCache::getFileData(const String& filename, const byte** data, size_t* size)
+{
+    const String* fileData = findOrLoadFile(filename);
+    if(fileData == NULL) return false;
+    *data = (const byte*)fileData->c_str();
+    *size = fileData->size();
+    return true;
+}
+
+///////////////////////////////////////////////////////////////////////////////////////////////////
+Ref<PixelData> ResourceCache::takeImage(const String& filename)
+{
+    sResourceCacheCondition.lock();
+    Dictionary<String, Ref<ImageUtils::LoadImageAsyncTask> >::iterator it = 
+        sPreloadedImages.find(filename);
+    if(it == sPreloadedImages.end())
+    {
+        sResourceCacheCondition.unlock();
+        return NULL;
+    }
+    Ref<ImageUtils::LoadImageAsyncTask> task = it->second;
+    sPreloadedImages.erase(it);
+    sResourceCacheCondition.unlock();
+
+    // Wait for the image loader to finish decoding the image.
+    while(!task->isComplete() && !SystemManager::instance()->isExitRequested()) osleep(1);
+    return task->getData().image;
+}
+
+///////////////////////////////////////////////////////////////////////////////////////////////////
+void ResourceCache::internalDispose()
+{
+    // Cached file data is not released here, since fonts keep pointers to it.
+    foreach(Thread* t, sPreloadThreads)
+    {
+        t->stop();
+        delete t;
+    }
+    sPreloadThreads.clear();
+
+    sResourceCacheCondition.lock();
+    sPreloadedImages.clear();
+    sResourceCacheCondition.unlock();
+}
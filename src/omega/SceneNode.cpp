@@ -40,9 +40,11 @@
 #include "omega/ModuleServices.h"
 #include "omega/glheaders.h"
 #include "omega/TrackedObject.h"
+#include "omega/SceneReplicationModule.h"
 
 using namespace omega;
 
+Dictionary<uint, SceneNode*> SceneNode::mysNodesByReplicationId;
 
 ///////////////////////////////////////////////////////////////////////////////
 SceneNode* SceneNode::create(const String& name)
@@ -52,6 +54,52 @@ SceneNode* SceneNode::create(const String& name)
     return sn;
 }
 
+///////////////////////////////////////////////////////////////////////////////
+SceneNode::~SceneNode()
+{
+    if(myTransformInterpolationEnabled) myServer->removeInterpolatedNode(this);
+    setReplicationId(0);
+}
+
+///////////////////////////////////////////////////////////////////////////////
+void SceneNode::setReplicationId(uint id)
+{
+    if(id == myReplicationId) return;
+
+    if(id != 0 && getByReplicationId(id) != NULL)
+    {
+        ofwarn("SceneNode::setReplicationId: id %1% is already used by node %2%", 
+            %id %getByReplicationId(id)->getName());
+        return;
+    }
+
+    if(myReplicationId != 0)
+    {
+        mysNodesByReplicationId.erase(myReplicationId);
+        SceneReplicationModule::removeNode(this);
+    }
+
+    myReplicationId = id;
+
+    if(myReplicationId != 0)
+    {
+        mysNodesByReplicationId[myReplicationId] = this;
+        if(SceneReplicationModule::isCollecting())
+        {
+            SceneReplicationModule::markDirty(this, 
+                SceneReplicationModule::TransformDirty | SceneReplicationModule::VisibilityDirty);
+        }
+    }
+}
+
+///////////////////////////////////////////////////////////////////////////////
+SceneNode* SceneNode::getByReplicationId(uint id)
+{
+    Dictionary<uint, SceneNode*>::iterator it = mysNodesByReplicationId.find(id);
+    if(it != mysNodesByReplicationId.end()) return it->second;
+    return NULL;
+}
+
 ///////////////////////////////////////////////////////////////////////////////
 void SceneNode::addListener(SceneNodeListener* listener)
 {
@@ -81,6 +129,11 @@ void SceneNode::setVisible(bool value)
         }
     }
     myVisible = value; 
+
+    if(SceneReplicationModule::isCollecting())
+    {
+        SceneReplicationModule::markDirty(this, SceneReplicationModule::VisibilityDirty);
+    }
 }
 
 ///////////////////////////////////////////////////////////////////////////////
@@ -314,6 +367,11 @@ void SceneNode::needUpdate(bool forceParentUpdate)
 {
     Node::needUpdate();
     requestBoundingBoxUpdate();
+
+    if(SceneReplicationModule::isCollecting())
+    {
+        SceneReplicationModule::markDirty(this, SceneReplicationModule::TransformDirty);
+    }
 }
 
 ///////////////////////////////////////////////////////////////////////////////
@@ -537,3 +595,47 @@ void SceneNode::unfollow()
         myTracker = NULL;
     }
 }
+
+///////////////////////////////////////////////////////////////////////////////
+void SceneNode::setTransformInterpolationEnabled(bool value)
+{
+    if(value == myTransformInterpolationEnabled) return;
+    myTransformInterpolationEnabled = value;
+    myHasFixedTransform = false;
+    if(value) myServer->addInterpolatedNode(this);
+    else myServer->removeInterpolatedNode(this);
+}
+
+///////////////////////////////////////////////////////////////////////////////
+void SceneNode::beginFixedUpdate()
+{
+    // Restore the last simulated transform, replacing the interpolated one.
+    if(myHasFixedTransform)
+    {
+        setPosition(myFixedPosition);
+        setOrientation(myFixedOrientation);
+    }
+    myPrevFixedPosition = getPosition();
+    myPrevFixedOrientation = getOrientation();
+}
+
+///////////////////////////////////////////////////////////////////////////////
+void SceneNode::endFixedUpdate()
+{
+    myFixedPosition = getPosition();
+    myFixedOrientation = getOrientation();
+    myHasFixedTransform = true;
+}
+
+///////////////////////////////////////////////////////////////////////////////
+void SceneNode::interpolateTransform(float alpha)
+{
+    if(!myHasFixedTransform) return;
+
+    Vector3f pos = myPrevFixedPosition + (myFixedPosition - myPrevFixedPosition) * alpha;
+    Quaternion ori = myPrevFixedOrientation.slerp(alpha, myFixedOrientation);
+
+    // Avoid flagging the node as changed when it is at rest.
+    if(pos != getPosition()) setPosition(pos);
+    if(ori.coeffs() != getOrientation().coeffs()) setOrientation(ori);
+}
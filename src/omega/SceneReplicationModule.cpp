@@ -0,0 +1,270 @@
+/******************************************************************************
+ * THE OMEGA LIB PROJECT
+ *-----------------------------------------------------------------------------
+ * Copyright 2010-2013		Electronic Visualization Laboratory, 
+ *							University of Illinois at Chicago
+ * Authors:										
+ *  Alessandro Febretti		febret@gmail.com
+ *-----------------------------------------------------------------------------
+ * Copyright (c) 2010-2013, Electronic Visualization Laboratory,  
+ * University of Illinois at Chicago
+ * All rights reserved.
+ * Redistribution and use in source and binary forms, with or without modification, 
+ * are permitted provided that the following conditions are met:
+ * 
+ * Redistributions of source code must retain the above copyright notice, this 
+ * list of conditions and the following disclaimer. Redistributions in binary 
+ * form must reproduce the above copyright notice, this list of conditions and 
+ * the following disclaimer in the documentation and/or other materials provided 
+ * with the distribution. 
+ * 
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" 
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO THE 
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE 
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE 
+ * LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL 
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE  GOODS OR 
+ * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER 
+ * CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, 
+ * OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE 
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ *-----------------------------------------------------------------------------
+ * What's in this file
+ *	A module replicating scene node transforms from the master to slave nodes.
+ ******************************************************************************/
+#include "omega/SceneReplicationModule.h"
+#include "omega/SceneNode.h"
+#include "omega/SystemManager.h"
+#include "omega/StatsManager.h"
+
+using namespace omega;
+
+Ref<SceneReplicationModule> SceneReplicationModule::mysInstance = NULL;
+bool SceneReplicationModule::mysCollecting = false;
+
+///////////////////////////////////////////////////////////////////////////////
+SceneReplicationModule* SceneReplicationModule::enable()
+{
+	if(mysInstance == NULL)
+	{
+		mysInstance = new SceneReplicationModule();
+		ModuleServices::addModule(mysInstance);
+	}
+	return mysInstance;
+}
+
+///////////////////////////////////////////////////////////////////////////////
+void SceneReplicationModule::markDirty(SceneNode* node, uint flags)
+{
+	if(node->myReplicationId == 0) return;
+
+	if(node->myReplicationFlags == 0) mysInstance->myDirtyNodes.push_back(node);
+	node->myReplicationFlags |= flags;
+}
+
+///////////////////////////////////////////////////////////////////////////////
+void SceneReplicationModule::removeNode(SceneNode* node)
+{
+	if(mysInstance != NULL) 
+	{
+		if(node->myReplicationFlags != 0) mysInstance->myDirtyNodes.remove(node);
+		mysInstance->myNodeStates.erase(node);
+	}
+	node->myReplicationFlags = 0;
+}
+
+///////////////////////////////////////////////////////////////////////////////
+void SceneReplicationModule::applyCommittedState()
+{
+	if(!mysCollecting) return;
+
+	// Changing the nodes here must not mark them dirty again.
+	mysCollecting = false;
+	foreach(SceneNode* node, mysInstance->myDirtyNodes)
+	{
+		Dictionary<SceneNode*, NodeState>::iterator it = mysInstance->myNodeStates.find(node);
+		// Nodes never sent yet are displayed as they are.
+		if(it == mysInstance->myNodeStates.end()) continue;
+		NodeState& s = it->second;
+
+		if(!(node->myReplicationFlags & LiveStateStored))
+		{
+			s.livePosition = node->getPosition();
+			s.liveOrientation = node->getOrientation();
+			s.liveScale = node->getScale();
+			s.liveVisible = node->isVisible();
+			node->myReplicationFlags |= LiveStateStored;
+		}
+
+		if(node->myReplicationFlags & TransformDirty)
+		{
+			node->setPosition(s.position);
+			node->setOrientation(s.orientation);
+			node->setScale(s.scale);
+		}
+		if((node->myReplicationFlags & VisibilityDirty) && s.visible != s.liveVisible)
+		{
+			node->setVisible(s.visible);
+		}
+	}
+	mysCollecting = true;
+}
+
+///////////////////////////////////////////////////////////////////////////////
+void SceneReplicationModule::restoreLiveState()
+{
+	if(!mysCollecting) return;
+
+	mysCollecting = false;
+	foreach(SceneNode* node, mysInstance->myDirtyNodes)
+	{
+		if(!(node->myReplicationFlags & LiveStateStored)) continue;
+
+		NodeState& s = mysInstance->myNodeStates[node];
+		if(node->myReplicationFlags & TransformDirty)
+		{
+			node->setPosition(s.livePosition);
+			node->setOrientation(s.liveOrientation);
+			node->setScale(s.liveScale);
+		}
+		if((node->myReplicationFlags & VisibilityDirty) && s.visible != s.liveVisible)
+		{
+			node->setVisible(s.liveVisible);
+		}
+		node->myReplicationFlags &= ~LiveStateStored;
+	}
+	mysCollecting = true;
+}
+
+///////////////////////////////////////////////////////////////////////////////
+SceneReplicationModule::SceneReplicationModule():
+	EngineModule("SceneReplicationModule")
+{
+	enableSharedData();
+}
+
+///////////////////////////////////////////////////////////////////////////////
+void SceneReplicationModule::initialize()
+{
+	// Only the master collects changes. Slaves apply the changes they 
+	// receive, and must not send them back.
+	mysCollecting = SystemManager::instance()->isMaster();
+
+	StatsManager* sm = SystemManager::instance()->getStatsManager();
+	myReplicatedNodesStat = sm->createStat("Replicated scene nodes", StatsManager::Count1);
+}
+
+///////////////////////////////////////////////////////////////////////////////
+void SceneReplicationModule::dispose()
+{
+	// Give nodes back their application values before forgetting them.
+	restoreLiveState();
+	mysCollecting = false;
+	foreach(SceneNode* node, myDirtyNodes) node->myReplicationFlags = 0;
+	myDirtyNodes.clear();
+	myNodeStates.clear();
+	mysInstance = NULL;
+}
+
+///////////////////////////////////////////////////////////////////////////////
+void SceneReplicationModule::commitSharedData(SharedOStream& out)
+{
+	// Nodes get marked dirty by calls that do not change them (i.e. setting
+	// the same position at every frame): only send the values that changed.
+	std::vector< std::pair<SceneNode*, byte> > changes;
+	foreach(SceneNode* node, myDirtyNodes)
+	{
+		NodeState& s = myNodeStates[node];
+		byte changed = 0;
+		if(node->myReplicationFlags & TransformDirty)
+		{
+			if(!s.committed || s.position != node->getPosition()) changed |= PositionChanged;
+			if(!s.committed || s.orientation.coeffs() != node->getOrientation().coeffs()) changed |= OrientationChanged;
+			if(!s.committed || s.scale != node->getScale()) changed |= ScaleChanged;
+		}
+		if(node->myReplicationFlags & VisibilityDirty)
+		{
+			if(!s.committed || s.visible != node->isVisible()) changed |= VisibilityChanged;
+		}
+		if(!s.committed)
+		{
+			// The first commit sends the full node state, so later commits
+			// can compare against all of it.
+			changed = PositionChanged | OrientationChanged | ScaleChanged | VisibilityChanged;
+		}
+
+		s.committed = true;
+		s.position = node->getPosition();
+		s.orientation = node->getOrientation();
+		s.scale = node->getScale();
+		s.visible = node->isVisible();
+		node->myReplicationFlags = 0;
+
+		if(changed != 0) changes.push_back(std::make_pair(node, changed));
+	}
+	myDirtyNodes.clear();
+
+	myReplicatedNodesStat->addSample(changes.size());
+
+	out << (int)changes.size();
+	typedef std::pair<SceneNode*, byte> NodeChange;
+	foreach(NodeChange c, changes)
+	{
+		SceneNode* node = c.first;
+		byte flags = c.second;
+		out << node->myReplicationId << flags;
+		if(flags & PositionChanged) out << node->getPosition();
+		if(flags & OrientationChanged) out << node->getOrientation();
+		if(flags & ScaleChanged) out << node->getScale();
+		if(flags & VisibilityChanged) out << node->isVisible();
+	}
+}
+
+///////////////////////////////////////////////////////////////////////////////
+void SceneReplicationModule::updateSharedData(SharedIStream& in)
+{
+	int numNodes;
+	int missing = 0;
+	in >> numNodes;
+	for(int i = 0; i < numNodes; i++)
+	{
+		uint id;
+		byte flags;
+		in >> id >> flags;
+		
+		// Always read the node data, even if we do not know the node, to
+		// keep the stream consistent.
+		SceneNode* node = SceneNode::getByReplicationId(id);
+		if(node == NULL) missing++;
+		if(flags & PositionChanged)
+		{
+			Vector3f position;
+			in >> position;
+			if(node != NULL) node->setPosition(position);
+		}
+		if(flags & OrientationChanged)
+		{
+			Quaternion orientation;
+			in >> orientation;
+			if(node != NULL) node->setOrientation(orientation);
+		}
+		if(flags & ScaleChanged)
+		{
+			Vector3f scale;
+			in >> scale;
+			if(node != NULL) node->setScale(scale);
+		}
+		if(flags & VisibilityChanged)
+		{
+			bool visible;
+			in >> visible;
+			if(node != NULL) node->setVisible(visible);
+		}
+	}
+	myReplicatedNodesStat->addSample(numNodes);
+
+	if(missing != 0)
+	{
+		ofwarn("SceneReplicationModule: %1% replicated nodes not found. Make sure all nodes set the same replication ids.", %missing);
+	}
+}
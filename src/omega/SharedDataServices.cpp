@@ -34,6 +34,22 @@ Dictionary<String, SharedObject*> SharedDataServices::mysRegistrationQueue;
 void SharedOStream::write( const void* data, uint64_t size )
 { 
 	myStream->write(data, size); 
+	if(myHashEnabled)
+	{
+		// 64 bit FNV-1a
+		const byte* bytes = static_cast<const byte*>(data);
+		for(uint64_t i = 0; i < size; i++)
+		{
+			myHash = (myHash ^ bytes[i]) * 1099511628211ULL;
+		}
+	}
+}
+
+///////////////////////////////////////////////////////////////////////////////////////////////////
+void SharedOStream::setHashEnabled(bool value)
+{
+	myHashEnabled = value;
+	myHash = 14695981039346656037ULL;
 }
 
 ///////////////////////////////////////////////////////////////////////////////////////////////////
@@ -98,6 +114,13 @@ void SharedData::getInstanceData( co::DataOStream& os )
 
 	// Serialize update context.
 	out << myUpdateContext.frameNum << myUpdateContext.dt << myUpdateContext.time;
+	out << myHeadPosesID;
+
+	// When the display idle mode is enabled, hash the object data to 
+	// detect changes. Changes wake up an idle display.
+	DisplaySystem* ds = SystemManager::instance()->getDisplaySystem();
+	bool hashData = ds != NULL && ds->getDisplayConfig().idleMode;
+	out.setHashEnabled(hashData);
 
 	int numObjects = myObjects.size();
 	out << numObjects;
@@ -107,6 +130,12 @@ void SharedData::getInstanceData( co::DataOStream& os )
 		out << obj.getKey();
 		obj->commitSharedData(out);
 	}
+
+	if(hashData && out.getHash() != myLastDataHash)
+	{
+		myLastDataHash = out.getHash();
+		DisplaySystem::requestRedraw();
+	}
 }
 
 ///////////////////////////////////////////////////////////////////////////////////////////////////
@@ -117,6 +146,7 @@ void SharedData::applyInstanceData( co::DataIStream& is )
 
 	// Desrialize update context.
 	in >> myUpdateContext.frameNum >> myUpdateContext.dt >> myUpdateContext.time;
+	in >> myHeadPosesID;
 
 	int numObjects;
 	in >> numObjects;
@@ -185,3 +215,57 @@ void SharedDataServices::cleanup()
 	// Shared data should take care of cleanup internally, here we just clean up the queue.
 	mysRegistrationQueue.clear();
 }
+
+///////////////////////////////////////////////////////////////////////////////////////////////////
+// Memory-backed collage streams used by SharedDataServices::loopbackObject.
+// The output stream saves everything written to it and sends nothing.
+class LoopbackOStream: public co::DataOStream
+{
+public:
+	LoopbackOStream() { enableSave(); _enable(); }
+	const co::base::Bufferb& finish() { disable(); return getSaveBuffer(); }
+
+protected:
+	virtual void sendData(const void* buffer, const uint64_t size, const bool last) {}
+};
+
+///////////////////////////////////////////////////////////////////////////////////////////////////
+class LoopbackIStream: public co::DataIStream
+{
+public:
+	LoopbackIStream(const co::base::Bufferb& data): myData(data), myConsumed(false) {}
+
+	virtual size_t nRemainingBuffers() const { return myConsumed ? 0 : 1; }
+	virtual eq::uint128_t getVersion() const { return co::VERSION_NONE; }
+
+protected:
+	virtual bool getNextBuffer(uint32_t* compressor, uint32_t* nChunks, const void** chunkData, uint64_t* size)
+	{
+		if(myConsumed) return false;
+		myConsumed = true;
+		*compressor = EQ_COMPRESSOR_NONE;
+		*nChunks = 1;
+		*chunkData = myData.getData();
+		*size = myData.getSize();
+		return true;
+	}
+
+private:
+	const co::base::Bufferb& myData;
+	bool myConsumed;
+};
+
+///////////////////////////////////////////////////////////////////////////////////////////////////
+size_t SharedDataServices::loopbackObject(SharedObject* obj)
+{
+	LoopbackOStream os;
+	SharedOStream out(&os);
+	obj->commitSharedData(out);
+	const co::base::Bufferb& data = os.finish();
+
+	LoopbackIStream is(data);
+	SharedIStream in(&is);
+	obj->updateSharedData(in);
+
+	return data.getSize();
+}
@@ -53,7 +53,8 @@ Stat* Stat::find(const String& name)
 }
 
 ///////////////////////////////////////////////////////////////////////////////
-StatsManager::StatsManager()
+StatsManager::StatsManager():
+	myVersion(0)
 {
 }
 
@@ -65,6 +66,7 @@ Stat* StatsManager::createStat(const String& name, StatType type)
 		Stat* s = new Stat(this, name, type);
 		myStatDictionary[name] = s;
 		myStatList.push_back(s);
+		myVersion++;
 	}
 	else
 	{
@@ -73,11 +75,26 @@ Stat* StatsManager::createStat(const String& name, StatType type)
 	return findStat(name);
 }
 
+///////////////////////////////////////////////////////////////////////////////
+Stat* StatsManager::createUniqueStat(const String& name, StatType type)
+{
+	String uniqueName = name;
+	int i = 2;
+	while(findStat(uniqueName) != NULL)
+	{
+		uniqueName = ostr("%1% (%2%)", %name %i++);
+	}
+	return createStat(uniqueName, type);
+}
+
 ///////////////////////////////////////////////////////////////////////////////
 void StatsManager::removeStat(Stat* s)
 {
 	oassert(s != NULL);
 	myStatList.remove(s);
+	// Do not leave a dangling pointer for findStat to return.
+	if(myStatDictionary[s->getName()] == s) myStatDictionary.erase(s->getName());
+	myVersion++;
 }
 
 ///////////////////////////////////////////////////////////////////////////////
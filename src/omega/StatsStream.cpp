@@ -0,0 +1,573 @@
+/******************************************************************************
+ * THE OMEGA LIB PROJECT
+ *-----------------------------------------------------------------------------
+ * Copyright 2010-2013		Electronic Visualization Laboratory, 
+ *							University of Illinois at Chicago
+ * Authors:										
+ *  Alessandro Febretti		febret@gmail.com
+ *-----------------------------------------------------------------------------
+ * Copyright (c) 2010-2013, Electronic Visualization Laboratory,  
+ * University of Illinois at Chicago
+ * All rights reserved.
+ * Redistribution and use in source and binary forms, with or without modification, 
+ * are permitted provided that the following conditions are met:
+ * 
+ * Redistributions of source code must retain the above copyright notice, this 
+ * list of conditions and the following disclaimer. Redistributions in binary 
+ * form must reproduce the above copyright notice, this list of conditions and 
+ * the following disclaimer in the documentation and/or other materials provided 
+ * with the distribution. 
+ * 
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" 
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO THE 
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE 
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE 
+ * LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL 
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE  GOODS OR 
+ * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER 
+ * CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, 
+ * OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE 
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ *-----------------------------------------------------------------------------
+ * What's in this file
+ *	Classes used to stream statistics from omegalib instances to mission 
+ *  control clients in a compact binary format, and to merge the streams of 
+ *  the nodes of a cluster.
+ ******************************************************************************/
+#include "omega/StatsStream.h"
+
+using namespace omega;
+
+#ifdef OMEGA_OS_LINUX
+const int StatsStreamEncoder::Version;
+const int StatsStreamEncoder::KeyframeInterval;
+const int StatsAggregator::MaxPendingFrames;
+#endif
+
+// Stream message layout. All integers are variable-length encoded, 7 bits 
+// per byte, except the first two bytes:
+//  version (byte), flags (byte), source name length, source name, 
+//  definition count, [stat id, name length, name]*,
+//  frame count, [frame delta, value count, [id delta, value delta]*]*
+// Value deltas are zigzag-encoded, so small negative deltas are short too.
+static const char KeyframeFlag = 1;
+
+///////////////////////////////////////////////////////////////////////////////
+static void writeVarint(Vector<char>& buffer, uint64 value)
+{
+    while(value >= 0x80)
+    {
+        buffer.push_back((char)((value & 0x7f) | 0x80));
+        value >>= 7;
+    }
+    buffer.push_back((char)value);
+}
+
+///////////////////////////////////////////////////////////////////////////////
+static void writeSignedVarint(Vector<char>& buffer, int64 value)
+{
+    writeVarint(buffer, ((uint64)value << 1) ^ (uint64)(value >> 63));
+}
+
+///////////////////////////////////////////////////////////////////////////////
+static void writeString(Vector<char>& buffer, const String& str)
+{
+    writeVarint(buffer, str.size());
+    buffer.insert(buffer.end(), str.begin(), str.end());
+}
+
+///////////////////////////////////////////////////////////////////////////////
+// Reads data from a stream message, checking for buffer overruns.
+class StreamReader
+{
+public:
+    StreamReader(const char* data, int size): 
+      myData((const unsigned char*)data), mySize(size), myPos(0), myValid(true) {}
+
+    bool isValid() { return myValid; }
+
+    int readByte()
+    {
+        if(myPos >= mySize) { myValid = false; return 0; }
+        return myData[myPos++];
+    }
+
+    uint64 readVarint()
+    {
+        uint64 value = 0;
+        int shift = 0;
+        while(myValid && shift < 64)
+        {
+            int b = readByte();
+            value |= (uint64)(b & 0x7f) << shift;
+            if(!(b & 0x80)) return value;
+            shift += 7;
+        }
+        myValid = false;
+        return 0;
+    }
+
+    int64 readSignedVarint()
+    {
+        uint64 v = readVarint();
+        return (int64)(v >> 1) ^ -(int64)(v & 1);
+    }
+
+    String readString()
+    {
+        uint64 len = readVarint();
+        if(!myValid || len > (uint64)(mySize - myPos)) { myValid = false; return ""; }
+        String str((const char*)myData + myPos, (size_t)len);
+        myPos += (int)len;
+        return str;
+    }
+
+private:
+    const unsigned char* myData;
+    int mySize;
+    int myPos;
+    bool myValid;
+};
+
+///////////////////////////////////////////////////////////////////////////////
+// Matches a stat name against a pattern containing * wildcards.
+static bool matchPattern(const char* pattern, const char* str)
+{
+    if(*pattern == '\0') return *str == '\0';
+    if(*pattern == '*')
+    {
+        // Try to match the rest of the pattern at every position.
+        do
+        {
+            if(matchPattern(pattern + 1, str)) return true;
+        } while(*str++ != '\0');
+        return false;
+    }
+    return *pattern == *str && matchPattern(pattern + 1, str + 1);
+}
+
+///////////////////////////////////////////////////////////////////////////////
+StatsStreamEncoder::StatsStreamEncoder():
+    mySampleInterval(0),
+    mySendInterval(0),
+    myLastSampleTime(0),
+    myLastSendTime(0),
+    myLastKeyframeTime(0),
+    myStatsVersion(0),
+    myStatsDirty(true),
+    myKeyframe(false),
+    myLastFrame(0),
+    myNumDefinitions(0),
+    myNumFrames(0)
+{
+}
+
+///////////////////////////////////////////////////////////////////////////////
+void StatsStreamEncoder::subscribe(const Vector<String>& patterns, float sampleRate, float sendRate)
+{
+    bool wasActive = isActive();
+    foreach(String p, patterns)
+    {
+        if(!p.empty() && 
+            std::find(myPatterns.begin(), myPatterns.end(), p) == myPatterns.end())
+        {
+            myPatterns.push_back(p);
+        }
+    }
+
+    // Subscriptions from different listeners are merged: keep the highest
+    // rates requested.
+    float sampleInterval = sampleRate > 0 ? 1.0f / sampleRate : 0;
+    float sendInterval = sendRate > 0 ? 1.0f / sendRate : 0;
+    if(!wasActive || sampleInterval < mySampleInterval) mySampleInterval = sampleInterval;
+    if(!wasActive || sendInterval < mySendInterval) mySendInterval = sendInterval;
+
+    myStatsDirty = true;
+    if(!wasActive)
+    {
+        // Start with a keyframe.
+        myNumFrames = 0;
+        myLastKeyframeTime = -KeyframeInterval;
+    }
+}
+
+///////////////////////////////////////////////////////////////////////////////
+void StatsStreamEncoder::clear()
+{
+    myPatterns.clear();
+    myStats.clear();
+    myNumFrames = 0;
+}
+
+///////////////////////////////////////////////////////////////////////////////
+void StatsStreamEncoder::refreshStats(StatsManager* sm)
+{
+    // Stats may have been destroyed: refresh all pointers.
+    foreach(StreamStat& ss, myStats)
+    {
+        ss.stat = sm->findStat(ss.name);
+    }
+
+    // Add new stats matching the subscription patterns.
+    foreach(Stat* s, sm->getStats())
+    {
+        const String& name = s->getName();
+        bool found = false;
+        foreach(StreamStat& ss, myStats)
+        {
+            if(ss.name == name) { found = true; break; }
+        }
+        if(found) continue;
+
+        foreach(String p, myPatterns)
+        {
+            if(matchPattern(p.c_str(), name.c_str()))
+            {
+                StreamStat ss;
+                ss.name = name;
+                ss.stat = s;
+                ss.lastValue = 0;
+                ss.defined = false;
+                myStats.push_back(ss);
+                break;
+            }
+        }
+    }
+    myStatsVersion = sm->getVersion();
+    myStatsDirty = false;
+}
+
+///////////////////////////////////////////////////////////////////////////////
+void StatsStreamEncoder::beginBatch(float time)
+{
+    myDefinitions.clear();
+    myFrames.clear();
+    myNumDefinitions = 0;
+    myNumFrames = 0;
+
+    myKeyframe = time - myLastKeyframeTime >= KeyframeInterval;
+    if(myKeyframe)
+    {
+        // Decoders reset their state on keyframes: we can compact stat ids,
+        // dropping stats that have been destroyed, and start over.
+        Vector<StreamStat> stats;
+        foreach(StreamStat& ss, myStats)
+        {
+            if(ss.stat != NULL)
+            {
+                ss.lastValue = 0;
+                ss.defined = false;
+                stats.push_back(ss);
+            }
+        }
+        myStats.swap(stats);
+        myLastFrame = 0;
+        myLastKeyframeTime = time;
+    }
+}
+
+///////////////////////////////////////////////////////////////////////////////
+void StatsStreamEncoder::sample(uint64 frame)
+{
+    Vector<char> values;
+    int numValues = 0;
+    int lastId = -1;
+    for(int id = 0; id < myStats.size(); id++)
+    {
+        StreamStat& ss = myStats[id];
+        if(ss.stat == NULL || !ss.stat->isValid()) continue;
+
+        if(!ss.defined)
+        {
+            writeVarint(myDefinitions, id);
+            writeString(myDefinitions, ss.name);
+            myNumDefinitions++;
+            ss.defined = true;
+        }
+
+        int64 value = (int64)floor(ss.stat->getCur() * 1000.0 + 0.5);
+        if(value != ss.lastValue)
+        {
+            writeVarint(values, id - lastId - 1);
+            writeSignedVarint(values, value - ss.lastValue);
+            ss.lastValue = value;
+            lastId = id;
+            numValues++;
+        }
+    }
+
+    // Frames are written even if no stat changed, so listeners know this
+    // frame has been sampled.
+    writeVarint(myFrames, frame - myLastFrame);
+    writeVarint(myFrames, numValues);
+    myFrames.insert(myFrames.end(), values.begin(), values.end());
+    myLastFrame = frame;
+    myNumFrames++;
+}
+
+///////////////////////////////////////////////////////////////////////////////
+bool StatsStreamEncoder::update(StatsManager* sm, uint64 frame, float time, Vector<char>& message)
+{
+    if(!isActive() || sm == NULL) return false;
+
+    if(myStatsDirty || sm->getVersion() != myStatsVersion) refreshStats(sm);
+
+    if(time - myLastSampleTime >= mySampleInterval)
+    {
+        if(myNumFrames == 0) beginBatch(time);
+        sample(frame);
+        myLastSampleTime = time;
+    }
+
+    if(myNumFrames == 0 || time - myLastSendTime < mySendInterval) return false;
+
+    message.clear();
+    message.push_back((char)Version);
+    message.push_back(myKeyframe ? KeyframeFlag : 0);
+    writeString(message, mySourceName);
+    writeVarint(message, myNumDefinitions);
+    message.insert(message.end(), myDefinitions.begin(), myDefinitions.end());
+    writeVarint(message, myNumFrames);
+    message.insert(message.end(), myFrames.begin(), myFrames.end());
+
+    myNumFrames = 0;
+    myLastSendTime = time;
+    return true;
+}
+
+///////////////////////////////////////////////////////////////////////////////
+String StatsStreamDecoder::peekSourceName(const char* data, int size)
+{
+    StreamReader r(data, size);
+    r.readByte();
+    r.readByte();
+    String name = r.readString();
+    return r.isValid() ? name : "";
+}
+
+///////////////////////////////////////////////////////////////////////////////
+int StatsStreamDecoder::findStat(const String& name)
+{
+    for(int id = 0; id < myNames.size(); id++)
+    {
+        if(myNames[id] == name) return id;
+    }
+    return -1;
+}
+
+///////////////////////////////////////////////////////////////////////////////
+bool StatsStreamDecoder::decode(const char* data, int size, IListener* listener)
+{
+    StreamReader r(data, size);
+    if(r.readByte() != StatsStreamEncoder::Version) return false;
+    int flags = r.readByte();
+    String sourceName = r.readString();
+    if(!r.isValid()) return false;
+
+    if(flags & KeyframeFlag)
+    {
+        mySynchronized = true;
+        mySourceName = sourceName;
+        myNames.clear();
+        myValues.clear();
+        myFrame = 0;
+    }
+    // We can't decode deltas until we get a keyframe.
+    else if(!mySynchronized) return true;
+
+    uint64 numDefinitions = r.readVarint();
+    for(uint64 i = 0; i < numDefinitions && r.isValid(); i++)
+    {
+        uint64 id = r.readVarint();
+        String name = r.readString();
+        // Ids are dense: anything bigger is garbage.
+        if(id > myNames.size()) return false;
+        if(id == myNames.size())
+        {
+            myNames.push_back(name);
+            myValues.push_back(0);
+        }
+        else
+        {
+            myNames[id] = name;
+            myValues[id] = 0;
+        }
+    }
+
+    uint64 numFrames = r.readVarint();
+    for(uint64 i = 0; i < numFrames && r.isValid(); i++)
+    {
+        myFrame += r.readVarint();
+        uint64 numValues = r.readVarint();
+        uint64 id = (uint64)-1;
+        for(uint64 j = 0; j < numValues && r.isValid(); j++)
+        {
+            id += r.readVarint() + 1;
+            int64 delta = r.readSignedVarint();
+            if(id >= myValues.size()) return false;
+            myValues[id] += delta;
+        }
+        if(!r.isValid()) return false;
+        if(listener != NULL) listener->onStatsFrame(this, myFrame);
+    }
+    return r.isValid();
+}
+
+///////////////////////////////////////////////////////////////////////////////
+StatsAggregator::StatsAggregator(const String& rankingStat):
+    myRankingStat(rankingStat),
+    myReportInterval(5),
+    myDecodingSourceId(-1),
+    myNewestFrame(0),
+    myLastFrame(0),
+    myLastSlowestValue(0),
+    myCompletedFrames(0)
+{
+    myReportTimer.start();
+}
+
+///////////////////////////////////////////////////////////////////////////////
+StatsAggregator::~StatsAggregator()
+{
+    typedef Dictionary<int, Source*>::Item SourceItem;
+    foreach(SourceItem item, mySources) delete item.getValue();
+    mySources.clear();
+}
+
+///////////////////////////////////////////////////////////////////////////////
+String StatsAggregator::getSubscription()
+{
+    // Sample every frame, send 10 times per second.
+    return "0 10 " + myRankingStat;
+}
+
+///////////////////////////////////////////////////////////////////////////////
+void StatsAggregator::handleStream(int sourceId, const String& sourceName, const char* data, int size)
+{
+    // Sources are keyed by id and not by the name they report in the stream:
+    // several nodes may report the same name (or none).
+    Source* source = mySources[sourceId];
+    if(source == NULL)
+    {
+        source = new Source();
+        mySources[sourceId] = source;
+    }
+    source->name = sourceName;
+
+    myDecodingSourceId = sourceId;
+    if(!source->decoder.decode(data, size, this))
+    {
+        ofwarn("StatsAggregator: malformed stat stream from %1%", %sourceName);
+    }
+    myDecodingSourceId = -1;
+    completeFrames(false);
+}
+
+///////////////////////////////////////////////////////////////////////////////
+void StatsAggregator::removeSource(int sourceId)
+{
+    Dictionary<int, Source*>::iterator it = mySources.find(sourceId);
+    if(it != mySources.end())
+    {
+        delete it->second;
+        mySources.erase(it);
+        // Frames may be waiting on this source: see if they are done.
+        completeFrames(false);
+    }
+}
+
+///////////////////////////////////////////////////////////////////////////////
+void StatsAggregator::onStatsFrame(StatsStreamDecoder* decoder, uint64 frame)
+{
+    // Frames reported this late have already been completed.
+    if(frame + MaxPendingFrames < myNewestFrame) return;
+
+    int id = decoder->findStat(myRankingStat);
+    if(id < 0) return;
+
+    double value = decoder->getStatValue(id);
+    FrameRecord& fr = myPendingFrames[frame];
+    if(fr.reports == 0 || value > fr.slowestValue)
+    {
+        fr.slowestValue = value;
+        fr.slowestSourceId = myDecodingSourceId;
+        fr.slowestSource = mySources[myDecodingSourceId]->name;
+    }
+    fr.reports++;
+    if(frame > myNewestFrame) myNewestFrame = frame;
+}
+
+///////////////////////////////////////////////////////////////////////////////
+void StatsAggregator::completeFrames(bool all)
+{
+    // Only sources we can decode report frames.
+    int numSources = 0;
+    typedef Dictionary<int, Source*>::Item SourceItem;
+    foreach(SourceItem item, mySources)
+    {
+        if(item.getValue()->decoder.isSynchronized()) numSources++;
+    }
+
+    Vector<uint64> completed;
+    typedef Dictionary<uint64, FrameRecord>::Item FrameItem;
+    foreach(FrameItem item, myPendingFrames)
+    {
+        if(all || item.getValue().reports >= numSources ||
+            item.getKey() + MaxPendingFrames < myNewestFrame)
+        {
+            completed.push_back(item.getKey());
+        }
+    }
+
+    foreach(uint64 frame, completed)
+    {
+        FrameRecord& fr = myPendingFrames[frame];
+        // The slowest source may have disconnected in the meantime.
+        Dictionary<int, Source*>::iterator it = mySources.find(fr.slowestSourceId);
+        if(it != mySources.end()) it->second->slowestCount++;
+        if(frame >= myLastFrame)
+        {
+            myLastFrame = frame;
+            myLastSlowestSource = fr.slowestSource;
+            myLastSlowestValue = fr.slowestValue;
+        }
+        myCompletedFrames++;
+        myPendingFrames.erase(frame);
+    }
+}
+
+///////////////////////////////////////////////////////////////////////////////
+void StatsAggregator::update()
+{
+    if(myReportInterval > 0 && 
+        myReportTimer.getElapsedTimeInSec() >= myReportInterval)
+    {
+        report();
+        myReportTimer.start();
+    }
+}
+
+///////////////////////////////////////////////////////////////////////////////
+void StatsAggregator::report()
+{
+    if(myCompletedFrames == 0) return;
+
+    String slowest;
+    int slowestCount = 0;
+    typedef Dictionary<int, Source*>::Item SourceItem;
+    foreach(SourceItem item, mySources)
+    {
+        Source* s = item.getValue();
+        if(s->slowestCount > slowestCount)
+        {
+            slowest = s->name;
+            slowestCount = s->slowestCount;
+        }
+        s->slowestCount = 0;
+    }
+
+    ofmsg("Frame %1%: slowest node %2% (%3% = %4%). Over the last %5% frames, %6% was slowest %7% times", 
+        %myLastFrame %myLastSlowestSource %myRankingStat %myLastSlowestValue
+        %myCompletedFrames %slowest %slowestCount);
+    myCompletedFrames = 0;
+}
@@ -42,6 +42,7 @@
 #include "omega/WandEmulationService.h"
 #include "omega/PythonInterpreter.h"
 #include "omega/MissionControl.h"
+#include "omega/AsyncLogSink.h"
 
 #ifdef OMEGA_USE_DISPLAY_EQUALIZER
     #include "omega/EqualizerDisplaySystem.h"
@@ -110,8 +111,11 @@ SystemManager::SystemManager():
     myIsMaster(true),
     myServiceManager(NULL),
     myMissionControlServer(NULL),
-    myMissionControlClient(NULL)
+    myMissionControlClient(NULL),
+    myMissionControlPort(0),
+    myFirstFrameFinished(false)
 {
+    myStartupTimer.start();
     myDataManager = DataManager::getInstance();
     myStatsManager = new StatsManager();
     myInterpreter = new PythonInterpreter();
@@ -138,7 +142,7 @@ SystemManager::~SystemManager()
     }
     if(myMissionControlServer != NULL)
     {
-        ologremlistener(myMissionControlServer);
+        AsyncLogSink::removeListener(myMissionControlServer);
         myMissionControlServer->unref();
         myMissionControlServer = NULL;
     }
@@ -148,10 +152,11 @@ SystemManager::~SystemManager()
 }
 
 ///////////////////////////////////////////////////////////////////////////////
-void SystemManager::setupRemote(Config* cfg, const String& hostname)
+void SystemManager::setupRemote(Config* cfg, const String& hostname, const String& launcherAddress)
 {
     myIsMaster = false;
     myHostname = hostname;
+    myLauncherAddress = launcherAddress;
     setup(cfg);
 }
 
@@ -159,6 +164,7 @@ void SystemManager::setupRemote(Config* cfg, const String& hostname)
 void SystemManager::setup(Config* appcfg)
 {
     omsg("SystemManager::setup");
+    beginStartupPhase("setup");
 
     setupConfig(appcfg);
     try
@@ -203,6 +209,7 @@ void SystemManager::setup(Config* appcfg)
     {
         oferror("Wrong setting type at %1% (HINT: make floats have a decimal part in your configuration)", %ste.getPath());
     }
+    endStartupPhase("setup");
 }
 
 ///////////////////////////////////////////////////////////////////////////////
@@ -254,6 +261,17 @@ void SystemManager::setupConfig(Config* appcfg)
     if(!mySystemConfig->isLoaded()) mySystemConfig->load();
 
     oassert(mySystemConfig->isLoaded());
+
+    // Enable asynchronous logging before any log listener gets registered.
+    if(mySystemConfig->exists("config"))
+    {
+        const Setting& sConfig = mySystemConfig->lookup("config");
+        if(Config::getBoolValue("asyncLogging", sConfig, false))
+        {
+            omsg("SystemManager::setup: asynchronous logging enabled");
+            AsyncLogSink::enable();
+        }
+    }
 }
 
 ///////////////////////////////////////////////////////////////////////////////
@@ -369,6 +387,11 @@ void SystemManager::setupMissionControl(const String& mode)
     int port = MissionControlServer::DefaultPort;
     String host = "127.0.0.1";
     bool serverEnabled = false;
+    String aggregateStat;
+
+    // Cluster nodes never run a server: they only connect to the master one
+    // when the master launched them with its address.
+    if(!myIsMaster && (mode.empty() || mode[0] != '@')) return;
 
     // Read config from file.
     if(mySystemConfig->exists("config/missionControl"))
@@ -377,6 +400,7 @@ void SystemManager::setupMissionControl(const String& mode)
         port = Config::getIntValue("port", s, port);
         host = Config::getStringValue("host", s, host);
         serverEnabled = Config::getBoolValue("serverEnabled", s, serverEnabled);
+        aggregateStat = Config::getStringValue("aggregateStats", s, aggregateStat);
     }
 
     // If mode is default and server is enabled in the configuration, or
@@ -404,13 +428,21 @@ void SystemManager::setupMissionControl(const String& mode)
             myMissionControlServer->ref();
             //myMissionControlServer->setMessageHandler(myMissionControlClient);
             myMissionControlServer->setPort(port);
+            // Merge the stat streams of the cluster nodes, and report the 
+            // slowest node according to the specified stat.
+            if(!aggregateStat.empty())
+            {
+                myMissionControlServer->setStatsAggregator(
+                    new StatsAggregator(aggregateStat));
+            }
 
-            ologaddlistener(myMissionControlServer);
+            AsyncLogSink::addListener(myMissionControlServer);
 
             // Register the mission control server. The service manager will take care of polling the server
             // periodically to check for new connections.
             myServiceManager->addService(myMissionControlServer);
             myMissionControlServer->start();
+            myMissionControlPort = port;
 
             myMissionControlClient = MissionControlClient::create();
             myMissionControlClient->ref();
@@ -423,7 +455,9 @@ void SystemManager::setupMissionControl(const String& mode)
     {
         omsg("Initializing mission control client...");
         myMissionControlClient = MissionControlClient::create();
+        myMissionControlClient->ref();
         myMissionControlClient->connect(host, port);
+        setMissionControlTarget(host, port);
     }
     // If string begins with @, we are going to connect to a server specified 
     // in the string.
@@ -439,15 +473,37 @@ void SystemManager::setupMissionControl(const String& mode)
         else
         {
             port = boost::lexical_cast<int>(mode.substr(pos + 1));
-            host = mode.substr(1, pos - 2);
+            host = mode.substr(1, pos - 1);
         }
 
         omsg("Initializing mission control client...");
         myMissionControlClient = MissionControlClient::create();
+        myMissionControlClient->ref();
+        if(!myIsMaster)
+        {
+            // Name cluster nodes by hostname:port, so nodes running on the 
+            // same host can be told apart.
+            myMissionControlClient->initialize();
+            myMissionControlClient->setName(myHostname);
+        }
+        else
+        {
+            setMissionControlTarget(host, port);
+        }
         myMissionControlClient->connect(host, port);
     }
 }
 
+///////////////////////////////////////////////////////////////////////////////
+void SystemManager::setMissionControlTarget(const String& host, int port)
+{
+    // Cluster nodes reach a server on the master loopback interface through 
+    // the master host name (see EqualizerDisplaySystem::launchNodes)
+    if(host == "127.0.0.1" || host == "localhost") myMissionControlHost = "";
+    else myMissionControlHost = host;
+    myMissionControlPort = port;
+}
+
 ///////////////////////////////////////////////////////////////////////////////
 void SystemManager::initialize()
 {
@@ -455,13 +511,66 @@ void SystemManager::initialize()
     // a chance to modify the display configuration before the display is 
     // initialized. This is used by services in external modules like the
     // Oculus Rift service.
+    beginStartupPhase("service initialize");
     myServiceManager->initialize();
+    endStartupPhase("service initialize");
 
+    beginStartupPhase("display initialize");
     if(myDisplaySystem) myDisplaySystem->initialize(this);
+    endStartupPhase("display initialize");
 
     myIsInitialized = true;
 }
 
+///////////////////////////////////////////////////////////////////////////////
+void SystemManager::beginStartupPhase(const String& name)
+{
+    myStartupLock.lock();
+    myStartupPhases[name] = myStartupTimer.getElapsedTimeInMilliSec();
+    myStartupLock.unlock();
+}
+
+///////////////////////////////////////////////////////////////////////////////
+void SystemManager::endStartupPhase(const String& name)
+{
+    myStartupLock.lock();
+    Dictionary<String, double>::iterator it = myStartupPhases.find(name);
+    if(it == myStartupPhases.end())
+    {
+        myStartupLock.unlock();
+        ofwarn("SystemManager::endStartupPhase: phase %1% was never started", %name);
+        return;
+    }
+    double duration = myStartupTimer.getElapsedTimeInMilliSec() - it->second;
+    myStartupPhases.erase(it);
+
+    String statName = "startup " + name;
+    Stat* s = myStatsManager->findStat(statName);
+    if(s == NULL) s = myStatsManager->createStat(statName, StatsManager::Time);
+    s->addSample(duration);
+    myStartupLock.unlock();
+
+    ofmsg("Startup phase %1%: %2% ms", %name %(int)duration);
+}
+
+///////////////////////////////////////////////////////////////////////////////
+void SystemManager::notifyFrameFinished()
+{
+    // Fast path: this is called by every renderer at every frame.
+    if(myFirstFrameFinished) return;
+
+    myStartupLock.lock();
+    if(!myFirstFrameFinished)
+    {
+        double t = myStartupTimer.getElapsedTimeInMilliSec();
+        Stat* s = myStatsManager->createStat("startup first frame", StatsManager::Time);
+        s->addSample(t);
+        myFirstFrameFinished = true;
+        ofmsg("Time to first frame: %1% ms", %(int)t);
+    }
+    myStartupLock.unlock();
+}
+
 ///////////////////////////////////////////////////////////////////////////////
 void SystemManager::run()
 {
@@ -514,6 +623,10 @@ void SystemManager::cleanup()
         myInterpreter = NULL;
     }
 
+    // Deliver pending log lines and go back to synchronous logging: the 
+    // remaining listeners are removed while disposing myself.
+    AsyncLogSink::disable();
+
     // Dispose myself.
     delete mysInstance;
     mysInstance = NULL;
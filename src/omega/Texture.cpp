@@ -36,12 +36,70 @@ bool Texture::sUsePbo = false;
 Texture::Texture(GpuContext* context): 
 	GpuResource(context),
 	myInitialized(false),
-	myTextureUnit(GpuContext::TextureUnitInvalid) 
+	myId(0),
+	myGlFormat(0),
+	myGlInternalFormat(0),
+	myPboId(0),
+	myTextureUnit(GpuContext::TextureUnitInvalid),
+	myMemorySize(0),
+	myEvictable(false),
+	myLastUsedFrame(0)
 {}
 
 ///////////////////////////////////////////////////////////////////////////////////////////////////
-void Texture::initialize(int width, int height, uint format)
+void Texture::dispose()
 {
+	if(myId != 0)
+	{
+		glDeleteTextures(1, &myId);
+		myId = 0;
+	}
+	if(myPboId != 0)
+	{
+		glDeleteBuffers(1, &myPboId);
+		myPboId = 0;
+	}
+	getContext()->removeResidentBytes(myMemorySize);
+	myMemorySize = 0;
+	myInitialized = false;
+	myTextureUnit = GpuContext::TextureUnitInvalid;
+}
+
+///////////////////////////////////////////////////////////////////////////////////////////////////
+void Texture::updateMemorySize()
+{
+	size_t size;
+	if(myGlInternalFormat == GL_COMPRESSED_RGB_S3TC_DXT1_EXT)
+	{
+		// 8 bytes per 4x4 block
+		size = (size_t)((myWidth + 3) / 4) * ((myHeight + 3) / 4) * 8;
+	}
+	else if(myGlInternalFormat == GL_COMPRESSED_RGBA_S3TC_DXT5_EXT)
+	{
+		// 16 bytes per 4x4 block
+		size = (size_t)((myWidth + 3) / 4) * ((myHeight + 3) / 4) * 16;
+	}
+	else
+	{
+		size_t bpp = 4;
+		if(myGlInternalFormat == GL_RGB) bpp = 3;
+		else if(myGlInternalFormat == GL_LUMINANCE || myGlInternalFormat == GL_ALPHA) bpp = 1;
+		size = (size_t)myWidth * myHeight * bpp;
+	}
+
+	if(myPboId != 0) size += (size_t)myWidth * myHeight * 4;
+
+	getContext()->removeResidentBytes(myMemorySize);
+	getContext()->addResidentBytes(size);
+	myMemorySize = size;
+}
+
+///////////////////////////////////////////////////////////////////////////////////////////////////
+void Texture::initialize(int width, int height, uint format, uint internalFormat)
+{
+	// Release storage from a previous initialization.
+	if(myInitialized) dispose();
+
 	myWidth = width; 
 	myHeight = height; 
 
@@ -50,11 +108,16 @@ void Texture::initialize(int width, int height, uint format)
 	{
 		myGlFormat = format;
 	}
+	myGlInternalFormat = myGlFormat;
+	if(internalFormat != 0)
+	{
+		myGlInternalFormat = internalFormat;
+	}
 
 	//Now generate the OpenGL texture object 
 	glGenTextures(1, &myId);
 	glBindTexture(GL_TEXTURE_2D, myId);
-	glTexImage2D(GL_TEXTURE_2D, 0, myGlFormat, myWidth, myHeight, 0, myGlFormat, GL_UNSIGNED_BYTE, NULL);
+	glTexImage2D(GL_TEXTURE_2D, 0, myGlInternalFormat, myWidth, myHeight, 0, myGlFormat, GL_UNSIGNED_BYTE, NULL);
 	glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR);
 	
 	if(sUsePbo)
@@ -74,6 +137,44 @@ void Texture::initialize(int width, int height, uint format)
 	}
 
 	myInitialized = true;
+	updateMemorySize();
+}
+
+///////////////////////////////////////////////////////////////////////////////////////////////////
+void Texture::initializeCompressed(int width, int height, uint internalFormat, const byte* data, size_t size)
+{
+	// Release storage from a previous initialization.
+	if(myInitialized) dispose();
+
+	myWidth = width; 
+	myHeight = height; 
+	myGlFormat = GL_RGBA;
+	myGlInternalFormat = internalFormat;
+
+	glGenTextures(1, &myId);
+	glBindTexture(GL_TEXTURE_2D, myId);
+	glCompressedTexImage2D(GL_TEXTURE_2D, 0, myGlInternalFormat, myWidth, myHeight, 0, size, data);
+	glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR);
+
+	GLenum glErr = glGetError();
+
+	if(glErr)
+	{
+		const unsigned char* str = gluErrorString(glErr);
+		oferror("Texture::initializeCompressed: %1%", %str);
+		return;
+	}
+
+	myInitialized = true;
+	updateMemorySize();
+}
+
+///////////////////////////////////////////////////////////////////////////////////////////////////
+bool Texture::isCompressed()
+{
+	return myInitialized && 
+		(myGlInternalFormat == GL_COMPRESSED_RGB_S3TC_DXT1_EXT || 
+		myGlInternalFormat == GL_COMPRESSED_RGBA_S3TC_DXT5_EXT);
 }
 
 ///////////////////////////////////////////////////////////////////////////////////////////////////
@@ -96,7 +197,8 @@ void Texture::writePixels(PixelData* data)
 		{
 			myHeight = h;
 			myWidth = w;
-			glTexImage2D(GL_TEXTURE_2D, 0, myGlFormat, myWidth, myHeight, 0, myGlFormat, GL_UNSIGNED_BYTE, NULL);
+			glTexImage2D(GL_TEXTURE_2D, 0, myGlInternalFormat, myWidth, myHeight, 0, myGlFormat, GL_UNSIGNED_BYTE, NULL);
+			updateMemorySize();
 		}
 
 		byte* pixels = data->bind(getContext());
@@ -34,23 +34,39 @@ using namespace omega;
 Texture* TextureSource::getTexture(const DrawContext& context)
 {
 	uint id = context.gpuContext->getId();
+	uint64_t bit = (uint64_t)1 << id;
+
+	myLock.lock();
 	if(myTextures[id].isNull())
 	{
 		myTextures[id] = context.renderer->createTexture();
-		myTextureUpdateFlags |= 1 << id;
+		// This source can always regenerate the texture, so the renderer is
+		// free to evict it when the gpu context runs out of memory budget.
+		myTextures[id]->setEvictable(true);
+		myTextureUpdateFlags |= bit;
 	}
 
-	// See if the texture needs refreshing
-	if(myDirty && (myTextureUpdateFlags & (1 << id)))
+	Texture* tex = myTextures[id];
+	tex->setLastUsedFrame(context.frameNum);
+
+	// See if the texture needs refreshing. Textures that have been evicted 
+	// by the renderer always need to be refreshed. The update flag is reset
+	// before refreshing, so a setDirty call during the refresh is not lost.
+	bool refresh = (myDirty && (myTextureUpdateFlags & bit)) || !tex->isInitialized();
+	if(refresh) myTextureUpdateFlags &= ~bit;
+	myLock.unlock();
+
+	if(refresh)
 	{
-		refreshTexture(myTextures[id], context);
-		myTextureUpdateFlags &= ~(1 << id);
+		refreshTexture(tex, context);
 
 		// If no other texture needs refreshing, reset the dirty flag
+		myLock.lock();
 		if(!myTextureUpdateFlags && !myRequireExplicitClean) myDirty = false;
+		myLock.unlock();
 	}
 
-	return myTextures[id];
+	return tex;
 }
 
 ///////////////////////////////////////////////////////////////////////////////////////////////////
@@ -59,16 +75,36 @@ void TextureSource::attachTexture(Texture* tex, const DrawContext& context)
 	uint id = context.gpuContext->getId();
 	// If a texture already exists for this context it will be deattached and will not be refreshed
 	// by this object anymore. Texture ref counting should take care of deletion when needed.
+	myLock.lock();
 	myTextures[id] = tex;
-	// always refresh the texture
-	refreshTexture(myTextures[id], context);
 	// Make sure the refresh flag for this texture is reset.
-	myTextureUpdateFlags &= ~(1 << id);
+	myTextureUpdateFlags &= ~((uint64_t)1 << id);
+	myLock.unlock();
+	// always refresh the texture
+	refreshTexture(tex, context);
+}
+
+///////////////////////////////////////////////////////////////////////////////////////////////////
+Texture* TextureSource::stageUpload(const DrawContext& context)
+{
+	uint id = context.gpuContext->getId();
+	uint64_t bit = (uint64_t)1 << id;
+	myLock.lock();
+	myQueuedUploadFlags &= ~bit;
+	// The texture may have been refreshed by a draw call since it was queued.
+	// Textures this context did not draw last frame are left to getTexture,
+	// and refreshed only if they are drawn again.
+	bool pending = myDirty && (myTextureUpdateFlags & bit) &&
+		myTextures[id]->getLastUsedFrame() + 1 >= context.frameNum;
+	myLock.unlock();
+	if(!pending) return NULL;
+	return getTexture(context);
 }
 
 ///////////////////////////////////////////////////////////////////////////////////////////////////
 void TextureSource::setDirty(bool value)
 {
+	myLock.lock();
 	myDirty = value;
 	if(myDirty)
 	{
@@ -76,7 +112,20 @@ void TextureSource::setDirty(bool value)
 		for(int i = 0; i < GpuContext::MaxContexts; i++)
 		{
 			// if the ith texture exists, set the ith bit in the update mask.
-			if(!myTextures[i].isNull()) myTextureUpdateFlags |= 1 << i;
+			if(!myTextures[i].isNull())
+			{
+				uint64_t bit = (uint64_t)1 << i;
+				myTextureUpdateFlags |= bit;
+				// Queue a staged upload on the texture context, so the pixels
+				// are uploaded at the start of the next frame on every pipe
+				// instead of during drawing.
+				if(!(myQueuedUploadFlags & bit))
+				{
+					myQueuedUploadFlags |= bit;
+					myTextures[i]->getContext()->queueTextureUpload(this);
+				}
+			}
 		}
 	}
+	myLock.unlock();
 }
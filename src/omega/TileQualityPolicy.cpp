@@ -0,0 +1,117 @@
+/******************************************************************************
+ * THE OMEGA LIB PROJECT
+ *-----------------------------------------------------------------------------
+ * Copyright 2010-2013		Electronic Visualization Laboratory, 
+ *							University of Illinois at Chicago
+ * Authors:										
+ *  Alessandro Febretti		febret@gmail.com
+ *-----------------------------------------------------------------------------
+ * Copyright (c) 2010-2013, Electronic Visualization Laboratory,  
+ * University of Illinois at Chicago
+ * All rights reserved.
+ * Redistribution and use in source and binary forms, with or without modification, 
+ * are permitted provided that the following conditions are met:
+ * 
+ * Redistributions of source code must retain the above copyright notice, this 
+ * list of conditions and the following disclaimer. Redistributions in binary 
+ * form must reproduce the above copyright notice, this list of conditions and 
+ * the following disclaimer in the documentation and/or other materials provided 
+ * with the distribution. 
+ * 
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" 
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO THE 
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE 
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE 
+ * LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL 
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE  GOODS OR 
+ * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER 
+ * CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, 
+ * OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE 
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ *-----------------------------------------------------------------------------
+ * What's in this file
+ *	A policy that lowers the rendering quality of display tiles outside the
+ *	field of view of a tracked user.
+ ******************************************************************************/
+#include "omega/TileQualityPolicy.h"
+
+using namespace omega;
+
+///////////////////////////////////////////////////////////////////////////////
+bool QualityClassSortOp(const TileQualityPolicy::QualityClass& c1, const TileQualityPolicy::QualityClass& c2)
+{ return c1.angle < c2.angle; }
+
+///////////////////////////////////////////////////////////////////////////////
+TileQualityPolicy::TileQualityPolicy():
+    myEnabled(false),
+    myHysteresis(10)
+{
+}
+
+///////////////////////////////////////////////////////////////////////////////
+void TileQualityPolicy::setup(const Setting& s)
+{
+    myEnabled = Config::getBoolValue("enabled", s, true);
+    myHysteresis = Config::getFloatValue("hysteresis", s, myHysteresis);
+
+    myClasses.clear();
+    if(s.exists("classes"))
+    {
+        const Setting& sc = s["classes"];
+        for(int i = 0; i < sc.getLength(); i++)
+        {
+            const Setting& scl = sc[i];
+            QualityClass qc;
+            qc.name = scl.getName();
+            qc.angle = Config::getFloatValue("angle", scl, 90);
+            qc.resolutionScale = Config::getFloatValue("resolutionScale", scl, 1.0f);
+            qc.mono = Config::getBoolValue("mono", scl, false);
+            qc.frameInterval = Config::getIntValue("frameInterval", scl, 1);
+            if(qc.frameInterval < 1) qc.frameInterval = 1;
+            myClasses.push_back(qc);
+
+            ofmsg("TileQualityPolicy: class %1% angle %2% scale %3% mono %4% interval %5%", 
+                %qc.name %qc.angle %qc.resolutionScale %qc.mono %qc.frameInterval);
+        }
+    }
+    std::sort(myClasses.begin(), myClasses.end(), QualityClassSortOp);
+}
+
+///////////////////////////////////////////////////////////////////////////////
+int TileQualityPolicy::classifyTile(const DisplayTileConfig* tile, 
+    const Vector3f& headPosition, const Quaternion& headOrientation, 
+    int currentClass)
+{
+    // Tiles attached to the head are always in front of the user.
+    if(!myEnabled || tile->isHMD) return -1;
+
+    // Measure the angle on the horizontal plane: on a cylindrical display
+    // we only care about the user looking around, not up or down.
+    Vector3f forward = headOrientation * -Vector3f::UnitZ();
+    Vector3f toTile = tile->center - headPosition;
+    forward[1] = 0;
+    toTile[1] = 0;
+    // The user is looking straight up or down, or is standing on the tile 
+    // center: keep the current classification.
+    if(forward.squaredNorm() < 0.0001f || toTile.squaredNorm() < 0.0001f) return currentClass;
+    forward.normalize();
+    toTile.normalize();
+
+    float d = forward.dot(toTile);
+    if(d > 1.0f) d = 1.0f;
+    if(d < -1.0f) d = -1.0f;
+    float angle = acos(d) * Math::RadToDeg;
+
+    // Find the class for this angle. Class thresholds are moved by the 
+    // hysteresis value, so that tiles close to a class boundary keep their
+    // current class instead of switching back and forth.
+    int newClass = -1;
+    for(int i = 0; i < myClasses.size(); i++)
+    {
+        float threshold = myClasses[i].angle;
+        if(i <= currentClass) threshold -= myHysteresis;
+        else threshold += myHysteresis;
+        if(angle >= threshold) newClass = i;
+    }
+    return newClass;
+}
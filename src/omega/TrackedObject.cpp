@@ -34,6 +34,7 @@
  *  based on a events generated from a tracking system
  ******************************************************************************/
 #include "omega/TrackedObject.h"
+#include "omega/SystemManager.h"
 
 using namespace omega;
 
@@ -63,6 +64,20 @@ TrackedObject::~TrackedObject()
 {
 }
 
+///////////////////////////////////////////////////////////////////////////////
+void TrackedObject::setTrackableSourceId(int value) 
+{ 
+    myTrackableSourceId = value; 
+
+    // Setup pose prediction for this source, if configured.
+    String predictorSetting = ostr("config/posePrediction/source%1%", %value);
+    if(SystemManager::settingExists(predictorSetting))
+    {
+        myPosePredictor = new PosePredictor();
+        myPosePredictor->setup(SystemManager::settingLookup(predictorSetting));
+    }
+}
+
 ///////////////////////////////////////////////////////////////////////////////
 void TrackedObject::handleEvent(const Event& evt)
 {
@@ -72,6 +87,12 @@ void TrackedObject::handleEvent(const Event& evt)
         myTrackedPosition = evt.getPosition();
         myTrackedOrientation = evt.getOrientation();
         myEventReceivedSinceLastUpdate = true;
+        if(myPosePredictor != NULL)
+        {
+            // Event timestamps are in milliseconds.
+            myPosePredictor->addSample(evt.getTimestamp() / 1000.0, 
+                myTrackedPosition, myTrackedOrientation);
+        }
     }
 }
 
@@ -80,7 +101,16 @@ void TrackedObject::update(const UpdateContext& context)
 {
     if(myNode != NULL)
     {
-        if(myEventReceivedSinceLastUpdate)
+        // With pose prediction, the object is moved at every update while 
+        // tracking is active, extrapolating its pose between tracker events.
+        bool trackingActive = myEventReceivedSinceLastUpdate ||
+            (myPosePredictor != NULL && context.time - myLastEventTime <= myHideTimeout);
+        if(myPosePredictor != NULL)
+        {
+            myPosePredictor->predict(context, &myTrackedPosition, &myTrackedOrientation);
+        }
+
+        if(trackingActive)
         {
             // If auto-hide mode is enabled and the mode is hidden,
             // make it visible.
@@ -99,8 +129,8 @@ void TrackedObject::update(const UpdateContext& context)
                 Quaternion orientation = myTrackedOrientation;
                 myNode->setOrientation(myTrackedOrientation * myOrientationOffset);
             }
+            if(myEventReceivedSinceLastUpdate) myLastEventTime = context.time;
             myEventReceivedSinceLastUpdate = false;
-            myLastEventTime = context.time;
         }
         else
         {
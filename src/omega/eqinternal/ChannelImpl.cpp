@@ -92,9 +92,21 @@ void ChannelImpl::frameDraw( const co::base::uint128_t& frameID )
 
     if(myDC.tile->enabled)
     {
+        ConfigImpl* config = static_cast<ConfigImpl*>(getConfig());
+        Timer drawTimer;
+        if(config->isFrameTimingEnabled()) drawTimer.start();
+
         // (spin is 128 bits, gets truncated to 64... 
         // do we really need 128 bits anyways!?)
         myDC.drawFrame(frameID.low());
+
+        if(config->isFrameTimingEnabled())
+        {
+            drawTimer.stop();
+            NodeImpl* node = static_cast<NodeImpl*>(getNode());
+            node->addDrawTime(getPipe()->getCurrentFrame(), myDC.tile->name, 
+                (float)drawTimer.getElapsedTimeInMilliSec());
+        }
     }
 	
 	// NOTE: This call NEEDS to stay after drawFrames, or frames will not 
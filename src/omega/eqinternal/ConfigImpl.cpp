@@ -28,6 +28,7 @@
 #include "omega/MouseService.h"
 #include "omega/KeyboardService.h"
 #include "omega/EventSharingModule.h"
+#include "omega/SceneReplicationModule.h"
 
 #include "eqinternal.h"
 
@@ -83,17 +84,80 @@ void EventUtils::deserializeEvent(Event& evt, co::DataIStream& is)
     }
 }
 
+///////////////////////////////////////////////////////////////////////////////////////////////////
+void LatchedHeadPoses::addPose(int cameraId, const Vector3f& position, const Quaternion& orientation)
+{
+    Pose p;
+    p.cameraId = cameraId;
+    p.position[0] = position[0];
+    p.position[1] = position[1];
+    p.position[2] = position[2];
+    p.orientation[0] = orientation.w();
+    p.orientation[1] = orientation.x();
+    p.orientation[2] = orientation.y();
+    p.orientation[3] = orientation.z();
+    myPoses.push_back(p);
+}
+
+///////////////////////////////////////////////////////////////////////////////////////////////////
+void LatchedHeadPoses::apply(Engine* engine)
+{
+    Camera* defaultCamera = engine->getDefaultCamera();
+    foreach(const Pose& p, myPoses)
+    {
+        Camera* cam = defaultCamera;
+        if(cam->getCameraId() != p.cameraId) cam = engine->getCameraById(p.cameraId);
+        if(cam != NULL)
+        {
+            cam->setLatchedHeadPose(myFrameNum,
+                Vector3f(p.position[0], p.position[1], p.position[2]),
+                Quaternion(p.orientation[0], p.orientation[1], p.orientation[2], p.orientation[3]));
+        }
+    }
+}
+
+///////////////////////////////////////////////////////////////////////////////////////////////////
+void LatchedHeadPoses::getInstanceData( co::DataOStream& os )
+{
+    uint32_t numPoses = myPoses.size();
+    os << myFrameNum << numPoses;
+    if(numPoses > 0) os.write(&myPoses[0], numPoses * sizeof(Pose));
+}
+
+///////////////////////////////////////////////////////////////////////////////////////////////////
+void LatchedHeadPoses::applyInstanceData( co::DataIStream& is )
+{
+    uint32_t numPoses;
+    is >> myFrameNum >> numPoses;
+    myPoses.resize(numPoses);
+    if(numPoses > 0) is.read(&myPoses[0], numPoses * sizeof(Pose));
+}
+
 ///////////////////////////////////////////////////////////////////////////////////////////////////
 ConfigImpl::ConfigImpl( co::base::RefPtr< eq::Server > parent): 
-    eq::Config(parent) 
+    eq::Config(parent),
+    myFrameTimingEnabled(false),
+    myFrameTimingMonitor(NULL),
+    myLocalNode(NULL)
 {
     omsg("[EQ] ConfigImpl::ConfigImpl");
     SharedDataServices::setSharedData(&mySharedData);
+
+    // All nodes read the same configuration, so they all agree on whether 
+    // to send frame timings.
+    Config* syscfg = SystemManager::instance()->getSystemConfig();
+    if(syscfg->exists("config"))
+    {
+        const Setting& sConfig = syscfg->lookup("config");
+        myFrameTimingEnabled = Config::getBoolValue("clusterTiming", sConfig, false);
+    }
 }
 
 ///////////////////////////////////////////////////////////////////////////////////////////////////
 ConfigImpl::~ConfigImpl()
 {
+    if(myFrameTimingMonitor != NULL) delete myFrameTimingMonitor;
+
     if(mySharedData.isAttached())
     {
         if(mySharedData.isMaster())
@@ -105,6 +169,11 @@ ConfigImpl::~ConfigImpl()
             unmapObject(&mySharedData);
         }
     }
+    if(myHeadPoses.isAttached())
+    {
+        if(myHeadPoses.isMaster()) deregisterObject(&myHeadPoses);
+        else unmapObject(&myHeadPoses);
+    }
 }
 
 ///////////////////////////////////////////////////////////////////////////////////////////////////
@@ -128,6 +197,17 @@ bool ConfigImpl::init()
     StatsManager* sm = SystemManager::instance()->getStatsManager();
     myFpsStat = sm->createStat("fps", StatsManager::Fps);
 
+    if(myFrameTimingEnabled)
+    {
+        // Every node in the equalizer configuration reports each frame.
+        EqualizerDisplaySystem* eqds = (EqualizerDisplaySystem*)SystemManager::instance()->getDisplaySystem();
+        myFrameTimingMonitor = new FrameTimingMonitor(eqds->getNumEqNodes());
+        const Setting& sConfig = SystemManager::instance()->getSystemConfig()->lookup("config");
+        myFrameTimingMonitor->setReportInterval(
+            Config::getFloatValue("clusterTimingReportInterval", sConfig, 10));
+        myFrameTimer.start();
+    }
+
     myGlobalTimer.start();
 
     return eq::Config::init(mySharedData.getID());
@@ -168,6 +248,15 @@ uint ConfigImpl::processMouseButtons(uint btns)
 ///////////////////////////////////////////////////////////////////////////////////////////////////
 bool ConfigImpl::handleEvent(const eq::ConfigEvent* event)
 {
+    if(event->data.type == NodeTimingEvent::Type)
+    {
+        if(myFrameTimingMonitor != NULL)
+        {
+            myFrameTimingMonitor->handleTiming(static_cast<const NodeTimingEvent*>(event));
+        }
+        return true;
+    }
+
     switch( event->data.type )
     {
         case eq::Event::KEY_PRESS:
@@ -228,6 +317,14 @@ uint32_t ConfigImpl::startFrame( const uint128_t& version )
     
     UpdateContext uc;
     uc.dt = t - lt;
+    // Do not count the time an idle display spent waiting for changes, or 
+    // the first frame after waking up would see a huge time step.
+    DisplaySystem* ds = SystemManager::instance()->getDisplaySystem();
+    if(ds != NULL)
+    {
+        uc.dt -= ds->getIdleWaitTime();
+        if(uc.dt < 0) uc.dt = 0;
+    }
     tt += uc.dt;
     uc.time = tt;
     uc.frameNum = version.low();
@@ -249,12 +346,18 @@ uint32_t ConfigImpl::startFrame( const uint128_t& version )
         // nodes. On single-node configs, we clear the previous frame queue here.
         EventSharingModule::clearQueue();
 
+        // Replicated scene nodes displayed their committed values during the
+        // last frame: give them back the ones set by the application.
+        SceneReplicationModule::restoreLiveState();
+
         ServiceManager* im = SystemManager::instance()->getServiceManager();
         im->poll();
         int av = im->getAvailableEvents();
         //ofmsg("Events: %1%", %av);
         if(av != 0)
         {
+            // Input events wake up an idle display.
+            DisplaySystem::requestRedraw();
             im->lockEvents();
             // Dispatch events to application server.
             for( int evtNum = 0; evtNum < av; evtNum++)
@@ -276,12 +379,35 @@ uint32_t ConfigImpl::startFrame( const uint128_t& version )
     }
 
     // Send shared data.
+    double commitStart = myFrameTimingEnabled ? myFrameTimer.getElapsedTimeInMilliSec() : 0;
     mySharedData.commit();
+    double updateStart = myFrameTimingEnabled ? myFrameTimer.getElapsedTimeInMilliSec() : 0;
 
     myServer->update(uc);
 
+    // Latch head poses as late as possible, right before sending the frame.
+    if(SystemManager::instance()->isMaster()) latchHeadPoses(uc);
+
+    float syncTime = 0;
+    float updateTime = 0;
+    if(myFrameTimingEnabled)
+    {
+        syncTime = (float)(updateStart - commitStart);
+        updateTime = (float)(myFrameTimer.getElapsedTimeInMilliSec() - updateStart);
+        if(myFrameTimingMonitor != NULL) myFrameTimingMonitor->update();
+    }
+
     // NOTE: This call NEEDS to stay after Engine::update, or frames will not update / display correctly.
-    return eq::Config::startFrame( version );;
+    uint32_t frameNumber = eq::Config::startFrame( version );
+
+    // The local node runs this frame on its own thread, possibly while we 
+    // start the next ones: hand it the times for this frame number.
+    if(myFrameTimingEnabled && myLocalNode != NULL)
+    {
+        myLocalNode->setUpdateTime(frameNumber, updateTime, syncTime);
+    }
+
+    return frameNumber;
 }
 
 ///////////////////////////////////////////////////////////////////////////////////////////////////
@@ -302,6 +428,85 @@ void ConfigImpl::updateSharedData( )
     }
 }
 
+///////////////////////////////////////////////////////////////////////////////////////////////////
+void ConfigImpl::latchHeadPoses(const UpdateContext& context)
+{
+    FrameVector< Ref<Camera> >::Type cameras;
+    myServer->getCameras(cameras);
+    cameras.push_back(myServer->getDefaultCamera());
+
+    FrameVector<Camera*>::Type latched;
+    foreach(Ref<Camera> cam, cameras)
+    {
+        if(cam->isLateLatchEnabled()) latched.push_back(cam);
+    }
+
+    // Nothing to send until a camera enables late latching. After that, 
+    // poses are sent every frame, since slaves expect them.
+    if(latched.empty() && !myHeadPoses.isAttached()) return;
+    if(!myHeadPoses.isAttached())
+    {
+        registerObject(&myHeadPoses);
+        mySharedData.setHeadPosesID(myHeadPoses.getID());
+    }
+
+    if(!latched.empty())
+    {
+        // Pass the tracker samples received during the update to the 
+        // cameras. The events stay in the queue, and get dispatched as usual
+        // at the next frame.
+        ServiceManager* im = SystemManager::instance()->getServiceManager();
+        im->poll();
+        int av = im->getAvailableEvents();
+        if(av != 0)
+        {
+            im->lockEvents();
+            for(int evtNum = 0; evtNum < av; evtNum++)
+            {
+                Event* evt = im->getEvent(evtNum);
+                foreach(Camera* cam, latched) cam->addLateSample(*evt);
+            }
+            im->unlockEvents();
+        }
+    }
+
+    myHeadPoses.clear(context.frameNum);
+    foreach(Camera* cam, latched)
+    {
+        Vector3f position;
+        Quaternion orientation;
+        cam->computeLateHeadPose(context, &position, &orientation);
+        cam->setLatchedHeadPose(context.frameNum, position, orientation);
+        myHeadPoses.addPose(cam->getCameraId(), position, orientation);
+    }
+    myHeadPoses.commit();
+}
+
+///////////////////////////////////////////////////////////////////////////////////////////////////
+void ConfigImpl::updateHeadPoses(Engine* engine)
+{
+    const uint128_t& id = mySharedData.getHeadPosesID();
+    if(id == uint128_t()) return;
+
+    if(!myHeadPoses.isAttached())
+    {
+        if(!mapObject(&myHeadPoses, id))
+        {
+            oferror("ConfigImpl::updateHeadPoses: mapObject failed (object id = %1%)", %id);
+            return;
+        }
+    }
+
+    // The master commits the poses once per frame, after the shared data. 
+    // When mapped, the object may already be at the current frame or later.
+    uint64 frameNum = mySharedData.getUpdateContext().frameNum;
+    while(myHeadPoses.getFrameNum() < frameNum)
+    {
+        myHeadPoses.sync(co::VERSION_NEXT);
+    }
+    if(myHeadPoses.getFrameNum() == frameNum) myHeadPoses.apply(engine);
+}
+
 ///////////////////////////////////////////////////////////////////////////////////////////////////
 const UpdateContext& ConfigImpl::getUpdateContext()
 {
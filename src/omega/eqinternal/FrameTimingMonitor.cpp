@@ -0,0 +1,214 @@
+/**************************************************************************************************
+ * THE OMEGA LIB PROJECT
+ *-------------------------------------------------------------------------------------------------
+ * Copyright 2010-2013		Electronic Visualization Laboratory, University of Illinois at Chicago
+ * Authors:										
+ *  Alessandro Febretti		febret@gmail.com
+ *-------------------------------------------------------------------------------------------------
+ * Copyright (c) 2010-2013, Electronic Visualization Laboratory, University of Illinois at Chicago
+ * All rights reserved.
+ * Redistribution and use in source and binary forms, with or without modification, are permitted 
+ * provided that the following conditions are met:
+ * 
+ * Redistributions of source code must retain the above copyright notice, this list of conditions 
+ * and the following disclaimer. Redistributions in binary form must reproduce the above copyright 
+ * notice, this list of conditions and the following disclaimer in the documentation and/or other 
+ * materials provided with the distribution. 
+ * 
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND ANY EXPRESS OR 
+ * IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO THE IMPLIED WARRANTIES OF MERCHANTABILITY AND 
+ * FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR 
+ * CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL 
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE  GOODS OR SERVICES; LOSS OF 
+ * USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, 
+ * WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN 
+ * ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+#include "omega/SystemManager.h"
+
+#include "eqinternal.h"
+
+using namespace omega;
+using namespace co::base;
+using namespace std;
+
+#ifdef OMEGA_OS_LINUX
+const int FrameTimingMonitor::MaxPendingFrames;
+const int FrameTimingMonitor::FrameTimeout;
+#endif
+
+///////////////////////////////////////////////////////////////////////////////////////////////////
+FrameTimingMonitor::FrameTimingMonitor(int expectedNodes):
+    myExpectedNodes(expectedNodes),
+    myNewestFrame(0),
+    myCompletedFrames(0),
+    myIncompleteFrames(0),
+    myReportInterval(10)
+{
+    StatsManager* sm = SystemManager::instance()->getStatsManager();
+    mySlowestBusyStat = sm->createStat("cluster slowest busy", StatsManager::Time);
+    myReportTimer.start();
+    myTimer.start();
+}
+
+///////////////////////////////////////////////////////////////////////////////////////////////////
+FrameTimingMonitor::~FrameTimingMonitor()
+{
+    typedef Dictionary<String, NodeData*>::Item NodeItem;
+    foreach(NodeItem item, myNodes) delete item.getValue();
+    myNodes.clear();
+}
+
+///////////////////////////////////////////////////////////////////////////////////////////////////
+void FrameTimingMonitor::handleTiming(const NodeTimingEvent* evt)
+{
+    String name = evt->node;
+    NodeData* nd = myNodes[name];
+    if(nd == NULL)
+    {
+        ofmsg("FrameTimingMonitor: receiving timings from node %1%", %name);
+        StatsManager* sm = SystemManager::instance()->getStatsManager();
+        nd = new NodeData();
+        nd->busyStat = sm->createStat("node " + name + " busy", StatsManager::Time);
+        nd->drawStat = sm->createStat("node " + name + " draw", StatsManager::Time);
+        nd->swapStat = sm->createStat("node " + name + " swap", StatsManager::Time);
+        nd->waitStat = sm->createStat("node " + name + " wait", StatsManager::Time);
+        myNodes[name] = nd;
+    }
+
+    // Busy time is what the node needs to produce a frame. The rest of the 
+    // frame period is spent waiting for swap, the swap barrier or the 
+    // application node: a node that never waits is holding back the cluster.
+    float busy = evt->update + evt->sync + evt->draw;
+    float wait = evt->period - busy - evt->swap;
+    if(wait < 0) wait = 0;
+
+    nd->busyStat->addSample(busy);
+    nd->drawStat->addSample(evt->draw);
+    nd->swapStat->addSample(evt->swap);
+    nd->waitStat->addSample(wait);
+    nd->busyTotal += busy;
+    nd->drawTotal += evt->draw;
+    nd->swapTotal += evt->swap;
+    nd->waitTotal += wait;
+    nd->frames++;
+
+    // Frames reported this late have already been completed.
+    if(evt->frame + MaxPendingFrames < myNewestFrame) return;
+
+    FrameRecord& fr = myFrames[evt->frame];
+    if(fr.reports == 0) fr.firstReportTime = myTimer.getElapsedTimeInMilliSec();
+    if(fr.reports == 0 || busy > fr.slowestBusy)
+    {
+        fr.slowestBusy = busy;
+        fr.slowestNode = name;
+        fr.slowestTile = evt->tile;
+    }
+    fr.reports++;
+    if(evt->frame > myNewestFrame) myNewestFrame = evt->frame;
+}
+
+///////////////////////////////////////////////////////////////////////////////////////////////////
+void FrameTimingMonitor::update()
+{
+    // A frame is complete when all the nodes in the configuration reported
+    // it. Nodes that stopped reporting (or never started) do not hold frames
+    // forever: frames time out after a while, or when many newer frames came in.
+    double now = myTimer.getElapsedTimeInMilliSec();
+    // (frame, timed out) pairs
+    typedef std::pair<uint32_t, bool> CompletedFrame;
+    Vector<CompletedFrame> completed;
+    typedef Dictionary<uint32_t, FrameRecord>::Item FrameItem;
+    foreach(FrameItem item, myFrames)
+    {
+        if(item.getValue().reports >= myExpectedNodes)
+        {
+            completed.push_back(CompletedFrame(item.getKey(), false));
+        }
+        else if(item.getKey() + MaxPendingFrames < myNewestFrame ||
+            now - item.getValue().firstReportTime > FrameTimeout)
+        {
+            completed.push_back(CompletedFrame(item.getKey(), true));
+        }
+    }
+    std::sort(completed.begin(), completed.end());
+    foreach(CompletedFrame c, completed) completeFrame(c.first, c.second);
+
+    if(myReportInterval > 0 && 
+        myReportTimer.getElapsedTimeInSec() >= myReportInterval)
+    {
+        report();
+        myReportTimer.start();
+    }
+}
+
+///////////////////////////////////////////////////////////////////////////////////////////////////
+void FrameTimingMonitor::completeFrame(uint32_t frame, bool timedOut)
+{
+    FrameRecord& fr = myFrames[frame];
+    if(timedOut) myIncompleteFrames++;
+
+    mySlowestNode = fr.slowestNode;
+    mySlowestTile = fr.slowestTile;
+    mySlowestBusyStat->addSample(fr.slowestBusy);
+
+    myNodes[fr.slowestNode]->slowestCount++;
+    if(!fr.slowestTile.empty()) myTileSlowestCount[fr.slowestTile]++;
+    myCompletedFrames++;
+
+    myFrames.erase(frame);
+}
+
+///////////////////////////////////////////////////////////////////////////////////////////////////
+void FrameTimingMonitor::report()
+{
+    if(myCompletedFrames == 0) return;
+
+    ofmsg("FrameTimingMonitor: last %1% frames (average ms)", %myCompletedFrames);
+    if(myIncompleteFrames > 0)
+    {
+        ofmsg("  %1% frames timed out before all %2% nodes reported them", 
+            %myIncompleteFrames %myExpectedNodes);
+    }
+    typedef Dictionary<String, NodeData*>::Item NodeItem;
+    foreach(NodeItem item, myNodes)
+    {
+        NodeData* nd = item.getValue();
+        if(nd->frames > 0)
+        {
+            ofmsg("  %-24s busy %6.1f  draw %6.1f  swap %6.1f  wait %6.1f  slowest %5.1f%%", 
+                %item.getKey() 
+                %(nd->busyTotal / nd->frames)
+                %(nd->drawTotal / nd->frames)
+                %(nd->swapTotal / nd->frames)
+                %(nd->waitTotal / nd->frames)
+                %(100.0 * nd->slowestCount / myCompletedFrames));
+        }
+        nd->slowestCount = 0;
+        nd->frames = 0;
+        nd->busyTotal = 0;
+        nd->drawTotal = 0;
+        nd->swapTotal = 0;
+        nd->waitTotal = 0;
+    }
+
+    // The tile most often on the slowest channel is the first candidate for
+    // simplification.
+    String slowestTile;
+    int slowestTileCount = 0;
+    typedef Dictionary<String, int>::Item TileItem;
+    foreach(TileItem item, myTileSlowestCount)
+    {
+        if(item.getValue() > slowestTileCount)
+        {
+            slowestTile = item.getKey();
+            slowestTileCount = item.getValue();
+        }
+    }
+    if(slowestTileCount > 0)
+    {
+        ofmsg("  slowest tile: %1% (%2% frames)", %slowestTile %slowestTileCount);
+    }
+    myTileSlowestCount.clear();
+    myCompletedFrames = 0;
+    myIncompleteFrames = 0;
+}
@@ -34,7 +34,9 @@ using namespace std;
 ///////////////////////////////////////////////////////////////////////////////////////////////////
 NodeImpl::NodeImpl( eq::Config* parent ):
 	Node(parent),
-	myServer(NULL)
+	myServer(NULL),
+	myTimingEnabled(false),
+	myLastFrameStart(0)
 {
 	omsg("[EQ] NodeImpl::NodeImpl");
 
@@ -65,6 +67,16 @@ bool NodeImpl::configInit( const eq::uint128_t& initID )
 		eqds->finishInitialize(config, myServer);
 	}
 
+	ConfigImpl* config = static_cast<ConfigImpl*>( getConfig());
+	myTimingEnabled = config->isFrameTimingEnabled();
+	if(myTimingEnabled)
+	{
+		myTimingName = sys->isMaster() ? "master" : sys->getHostnameAndPort();
+		for(int i = 0; i < TimingSlots; i++) myTimings[i].frame = 0;
+		myFrameTimer.start();
+		if(sys->isMaster()) config->setLocalNode(this);
+	}
+
 	return Node::configInit(initID);
 }
 
@@ -78,6 +90,10 @@ bool NodeImpl::configExit()
 	{
 		myServer->dispose();
 	}
+	else if(myTimingEnabled)
+	{
+		static_cast<ConfigImpl*>(getConfig())->setLocalNode(NULL);
+	}
 	return Node::configExit();
 }
 
@@ -86,13 +102,35 @@ void NodeImpl::frameStart( const eq::uint128_t& frameID, const uint32_t frameNum
 {
 	// If server is not NULL (only on slave nodes) call update here
 	// on the master node, update is invoked in ConfigImpl.
+	ConfigImpl* config = (ConfigImpl*)getConfig();
+	double frameStart = myTimingEnabled ? myFrameTimer.getElapsedTimeInMilliSec() : 0;
+	double syncEnd = frameStart;
 	if(myServer != NULL)
 	{
-		ConfigImpl* config = (ConfigImpl*)getConfig();
 		config->updateSharedData();
+		if(myTimingEnabled) syncEnd = myFrameTimer.getElapsedTimeInMilliSec();
 
 		const UpdateContext& uc = config->getUpdateContext();
 		myServer->update(uc);
+
+		// Late-latched cameras draw with the head poses sent by the master.
+		config->updateHeadPoses(myServer);
+	}
+
+	if(myTimingEnabled)
+	{
+		myTimingLock.lock();
+		FrameTiming& t = getTiming(frameNumber);
+		// On the application node, update and commit run in 
+		// ConfigImpl::startFrame, which sets their times (see setUpdateTime)
+		if(myServer != NULL)
+		{
+			t.sync = (float)(syncEnd - frameStart);
+			t.update = (float)(myFrameTimer.getElapsedTimeInMilliSec() - syncEnd);
+		}
+		t.period = myLastFrameStart > 0 ? (float)(frameStart - myLastFrameStart) : 0;
+		myLastFrameStart = frameStart;
+		myTimingLock.unlock();
 	}
 
 	if(!getClient()->isConnected()) getClient()->exitLocal();
@@ -101,3 +139,77 @@ void NodeImpl::frameStart( const eq::uint128_t& frameID, const uint32_t frameNum
 	Node::frameStart(frameID, frameNumber);
 }
 
+///////////////////////////////////////////////////////////////////////////////////////////////////
+void NodeImpl::frameFinish( const eq::uint128_t& frameID, const uint32_t frameNumber )
+{
+	if(myTimingEnabled)
+	{
+		// Send this frame timings to the application node.
+		NodeTimingEvent evt;
+		myTimingLock.lock();
+		FrameTiming& t = getTiming(frameNumber);
+		evt.frame = frameNumber;
+		evt.update = t.update;
+		evt.sync = t.sync;
+		evt.draw = t.draw;
+		evt.swap = t.swap;
+		evt.period = t.period;
+		strncpy(evt.node, myTimingName.c_str(), NodeTimingEvent::MaxNameLength - 1);
+		evt.node[NodeTimingEvent::MaxNameLength - 1] = '\0';
+		strncpy(evt.tile, t.tile.c_str(), NodeTimingEvent::MaxNameLength - 1);
+		evt.tile[NodeTimingEvent::MaxNameLength - 1] = '\0';
+		myTimingLock.unlock();
+
+		getConfig()->sendEvent(evt);
+	}
+	Node::frameFinish(frameID, frameNumber);
+}
+
+///////////////////////////////////////////////////////////////////////////////////////////////////
+NodeImpl::FrameTiming& NodeImpl::getTiming(uint32_t frame)
+{
+	FrameTiming& t = myTimings[frame % TimingSlots];
+	if(t.frame != frame)
+	{
+		t.frame = frame;
+		t.update = 0;
+		t.sync = 0;
+		t.draw = 0;
+		t.swap = 0;
+		t.period = 0;
+		t.tile = "";
+	}
+	return t;
+}
+
+///////////////////////////////////////////////////////////////////////////////////////////////////
+void NodeImpl::addDrawTime(uint32_t frame, const String& tile, float ms)
+{
+	myTimingLock.lock();
+	FrameTiming& t = getTiming(frame);
+	if(ms > t.draw)
+	{
+		t.draw = ms;
+		t.tile = tile;
+	}
+	myTimingLock.unlock();
+}
+
+///////////////////////////////////////////////////////////////////////////////////////////////////
+void NodeImpl::setUpdateTime(uint32_t frame, float update, float sync)
+{
+	myTimingLock.lock();
+	FrameTiming& t = getTiming(frame);
+	t.update = update;
+	t.sync = sync;
+	myTimingLock.unlock();
+}
+
+///////////////////////////////////////////////////////////////////////////////////////////////////
+void NodeImpl::addSwapTime(uint32_t frame, float ms)
+{
+	myTimingLock.lock();
+	FrameTiming& t = getTiming(frame);
+	if(ms > t.swap) t.swap = ms;
+	myTimingLock.unlock();
+}
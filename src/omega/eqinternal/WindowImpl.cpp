@@ -138,6 +138,27 @@ void WindowImpl::frameStart( const uint128_t& frameID, const uint32_t frameNumbe
 	const GLEWContext* glewc = glewGetContext();
 	glewSetContext(glewc);
 }
+
+///////////////////////////////////////////////////////////////////////////////
+void WindowImpl::swapBuffers()
+{
+	ConfigImpl* config = static_cast<ConfigImpl*>(getConfig());
+	if(config->isFrameTimingEnabled())
+	{
+		// Swap time includes waiting for vertical sync.
+		Timer swapTimer;
+		swapTimer.start();
+		eq::Window::swapBuffers();
+		swapTimer.stop();
+		NodeImpl* node = static_cast<NodeImpl*>(getNode());
+		node->addSwapTime(getPipe()->getCurrentFrame(), 
+			(float)swapTimer.getElapsedTimeInMilliSec());
+	}
+	else
+	{
+		eq::Window::swapBuffers();
+	}
+}
 
 ///////////////////////////////////////////////////////////////////////////////
 Renderer* WindowImpl::getRenderer() 
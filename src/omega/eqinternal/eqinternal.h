@@ -84,11 +84,124 @@ namespace omicron {
 namespace omega {
     class RenderTarget;
 	class Camera;
+	class FrameTimingMonitor;
+	class NodeImpl;
+
+///////////////////////////////////////////////////////////////////////////////
+//! @internal
+//! Sent by each node to the application node at the end of each frame, when
+//! cluster frame timing is enabled (config/clusterTiming). All times are in
+//! milliseconds.
+struct NodeTimingEvent: public eq::ConfigEvent
+{
+	enum { Type = eq::Event::USER };
+	static const int MaxNameLength = 64;
+
+	NodeTimingEvent()
+	{
+		size = sizeof(NodeTimingEvent);
+		data.type = Type;
+		node[0] = '\0';
+		tile[0] = '\0';
+	}
+
+	uint32_t frame;
+	//! Engine update
+	float update;
+	//! Shared data commit (master) or sync (slaves)
+	float sync;
+	//! Draw time of the slowest channel
+	float draw;
+	//! Longest buffer swap. Includes waiting for vsync.
+	float swap;
+	//! Time since the previous frame start
+	float period;
+	char node[MaxNameLength];
+	//! Name of the tile of the slowest channel
+	char tile[MaxNameLength];
+};
+
+///////////////////////////////////////////////////////////////////////////////
+//! @internal
+//! Runs on the application node: collects node timing events, publishes 
+//! them as stats, finds the slowest node and tile of each frame, and 
+//! periodically prints a report.
+class FrameTimingMonitor
+{
+public:
+	//! Frames are considered complete after this many newer frames have 
+	//! been reported, even if some nodes did not report them.
+	static const int MaxPendingFrames = 16;
+	//! Frames are considered complete this many milliseconds after their 
+	//! first report, even if some nodes did not report them.
+	static const int FrameTimeout = 1000;
+
+public:
+	//! expectedNodes is the number of nodes in the equalizer configuration.
+	FrameTimingMonitor(int expectedNodes);
+	~FrameTimingMonitor();
+
+	//! Sets the interval between reports, in seconds. Zero disables reports.
+	void setReportInterval(float value) { myReportInterval = value; }
+	void handleTiming(const NodeTimingEvent* evt);
+	//! Completes pending frames and prints a report if it is time to.
+	void update();
+
+	const String& getSlowestNode() { return mySlowestNode; }
+	const String& getSlowestTile() { return mySlowestTile; }
+
+private:
+	void completeFrame(uint32_t frame, bool timedOut);
+	void report();
+
+private:
+	struct NodeData
+	{
+		NodeData(): slowestCount(0), frames(0), busyTotal(0), drawTotal(0), swapTotal(0), waitTotal(0) {}
+		Ref<Stat> busyStat;
+		Ref<Stat> drawStat;
+		Ref<Stat> swapStat;
+		Ref<Stat> waitStat;
+		int slowestCount;
+		int frames;
+		double busyTotal;
+		double drawTotal;
+		double swapTotal;
+		double waitTotal;
+	};
+	struct FrameRecord
+	{
+		FrameRecord(): reports(0), slowestBusy(0), firstReportTime(0) {}
+		int reports;
+		double firstReportTime;
+		float slowestBusy;
+		String slowestNode;
+		String slowestTile;
+	};
+
+	int myExpectedNodes;
+	Dictionary<String, NodeData*> myNodes;
+	Dictionary<uint32_t, FrameRecord> myFrames;
+	uint32_t myNewestFrame;
+	Dictionary<String, int> myTileSlowestCount;
+	int myCompletedFrames;
+	// Completed frames some nodes did not report
+	int myIncompleteFrames;
+	Timer myTimer;
+
+	String mySlowestNode;
+	String mySlowestTile;
+	Ref<Stat> mySlowestBusyStat;
+
+	float myReportInterval;
+	Timer myReportTimer;
+};
 
 ///////////////////////////////////////////////////////////////////////////////
 class SharedData: public co::Object
 {
 public:
+	SharedData(): myLastDataHash(0) {}
 	void registerObject(SharedObject* object, const String& id);
 	void unregisterObject(const String& id);
     // The shared data is unbuffered: we do not store multiple versions of it.
@@ -100,6 +213,10 @@ public:
 	virtual ChangeType getChangeType() const { return UNBUFFERED; }
 	void setUpdateContext(const UpdateContext& ctx) { myUpdateContext = ctx; }
 	const UpdateContext& getUpdateContext() { return myUpdateContext; }
+	//! Id of the latched head pose object, sent to slaves with each frame. 
+	//! Zero until a camera enables late latching.
+	void setHeadPosesID(const uint128_t& id) { myHeadPosesID = id; }
+	const uint128_t& getHeadPosesID() { return myHeadPosesID; }
 
 
 protected:
@@ -110,6 +227,46 @@ private:
 	Dictionary<String, SharedObject*> myObjects;
 	typedef Dictionary<String, SharedObject*>::Item SharedObjectItem;
 	UpdateContext myUpdateContext;
+	// Hash of the last shared object data, used to detect changes.
+	uint64_t myLastDataHash;
+	uint128_t myHeadPosesID;
+};
+
+///////////////////////////////////////////////////////////////////////////////
+//! @internal
+//! Head poses of the late-latched cameras (see Camera::setLateLatchEnabled).
+//! The master computes them after the frame update and commits them right 
+//! before starting the frame, so all nodes draw the frame with the same 
+//! poses. Unbuffered, like SharedData.
+class LatchedHeadPoses: public co::Object
+{
+public:
+	struct Pose
+	{
+		int cameraId;
+		// NOTE: poses are stored as plain floats to avoid alignment 
+		// requirements on the pose vector.
+		float position[3];
+		float orientation[4];
+	};
+
+public:
+	LatchedHeadPoses(): myFrameNum(0) {}
+	virtual ChangeType getChangeType() const { return UNBUFFERED; }
+
+	void clear(uint64 frameNum) { myFrameNum = frameNum; myPoses.clear(); }
+	void addPose(int cameraId, const Vector3f& position, const Quaternion& orientation);
+	uint64 getFrameNum() { return myFrameNum; }
+	//! Passes the poses to the cameras they belong to.
+	void apply(Engine* engine);
+
+protected:
+	virtual void getInstanceData( co::DataOStream& os );
+	virtual void applyInstanceData( co::DataIStream& is );
+
+private:
+	uint64 myFrameNum;
+	Vector<Pose> myPoses;
 };
 
 ///////////////////////////////////////////////////////////////////////////////
@@ -127,20 +284,43 @@ public:
     virtual bool exit();
 	void mapSharedData(const uint128_t& initID);
 	void updateSharedData();
+	//! Applies the latched head poses for the frame being started. Called 
+	//! on slave nodes after the frame update.
+	void updateHeadPoses(Engine* engine);
     virtual bool handleEvent(const eq::ConfigEvent* event);
     virtual uint32_t startFrame( const uint128_t& version );
 	const UpdateContext& getUpdateContext();
 
+	//! Cluster frame timing
+	//@{
+	bool isFrameTimingEnabled() { return myFrameTimingEnabled; }
+	//! Returns NULL on nodes other than the application node, or when 
+	//! frame timing is disabled.
+	FrameTimingMonitor* getFrameTimingMonitor() { return myFrameTimingMonitor; }
+	//! Sets the node running on the application node. It receives the 
+	//! update and commit times measured in startFrame.
+	void setLocalNode(NodeImpl* node) { myLocalNode = node; }
+	//@}
+
 private:
     void processMousePosition(eq::Window* source, int x, int y, Vector2i& outPosition, Ray& ray);
     uint processMouseButtons(uint btns); 
+	//! Computes the head poses of late-latched cameras on the master, 
+	//! after the frame update.
+	void latchHeadPoses(const UpdateContext& context);
 
 private:
 	SharedData mySharedData;
+	LatchedHeadPoses myHeadPoses;
 	Timer myGlobalTimer;
 	//! Global fps counter.
 	Ref<Stat> myFpsStat;
 
+	bool myFrameTimingEnabled;
+	FrameTimingMonitor* myFrameTimingMonitor;
+	Timer myFrameTimer;
+	NodeImpl* myLocalNode;
+
     omicron::Ref<Engine> myServer;
 };
 
@@ -153,15 +333,50 @@ public:
 public:
     NodeImpl( eq::Config* parent );
 
+	//! Frame timing: called by channels and windows from pipe threads.
+	//@{
+	void addDrawTime(uint32_t frame, const String& tile, float ms);
+	void addSwapTime(uint32_t frame, float ms);
+	//! Called by ConfigImpl on the application node, where engine update
+	//! and shared data commit run in ConfigImpl::startFrame.
+	void setUpdateTime(uint32_t frame, float update, float sync);
+	//@}
+
 protected:
     virtual bool configInit( const eq::uint128_t& initID );
     virtual bool configExit();
     virtual void frameStart( const eq::uint128_t& frameID, const uint32_t frameNumber );
+    virtual void frameFinish( const eq::uint128_t& frameID, const uint32_t frameNumber );
+
+private:
+	struct FrameTiming
+	{
+		uint32_t frame;
+		float update;
+		float sync;
+		float draw;
+		float swap;
+		float period;
+		String tile;
+	};
+	//! Returns the timing slot for a frame, resetting it if it was used by
+	//! an older frame. Call with myTimingLock held.
+	FrameTiming& getTiming(uint32_t frame);
 
 private:
     //bool myInitialized;
     omicron::Ref<Engine> myServer;
     //FrameData myFrameData;
+
+	// Frames can overlap when latency is enabled: keep timings for the 
+	// last few frames.
+	static const int TimingSlots = 4;
+	bool myTimingEnabled;
+	String myTimingName;
+	omicron::Lock myTimingLock;
+	FrameTiming myTimings[TimingSlots];
+	Timer myFrameTimer;
+	double myLastFrameStart;
 };
 
 ///////////////////////////////////////////////////////////////////////////////
@@ -203,6 +418,7 @@ public:
 protected:
     virtual bool configInit(const uint128_t& initID);
     virtual void frameStart( const uint128_t& frameID, const uint32_t frameNumber );
+	virtual void swapBuffers();
 	bool processEvent(const eq::Event& event);
 
 private:
@@ -41,6 +41,7 @@
 #include "omega/ImageUtils.h"
 #include "omega/CameraController.h"
 #include "omega/MissionControl.h"
+#include "omega/SceneReplicationModule.h"
 
 #ifdef OMEGA_USE_PYTHON
 
@@ -749,6 +750,25 @@ bool isStereoEnabled()
     return false;
 }
 
+///////////////////////////////////////////////////////////////////////////////
+void requestRedraw()
+{
+    DisplaySystem::requestRedraw();
+}
+
+///////////////////////////////////////////////////////////////////////////////
+void enableSceneReplication()
+{
+    SceneReplicationModule::enable();
+}
+
+///////////////////////////////////////////////////////////////////////////////
+bool isDisplayIdle()
+{
+    DisplaySystem* ds = SystemManager::instance()->getDisplaySystem();
+    return ds != NULL && ds->isIdle();
+}
+
 ///////////////////////////////////////////////////////////////////////////////
 DisplayConfig* getDisplayConfig()
 {
@@ -1198,6 +1218,10 @@ BOOST_PYTHON_MODULE(omega)
         PYAPI_METHOD(SceneNode, setFlag)
         PYAPI_METHOD(SceneNode, unsetFlag)
         PYAPI_METHOD(SceneNode, isFlagSet)
+        PYAPI_METHOD(SceneNode, setTransformInterpolationEnabled)
+        PYAPI_METHOD(SceneNode, isTransformInterpolationEnabled)
+        PYAPI_METHOD(SceneNode, setReplicationId)
+        PYAPI_METHOD(SceneNode, getReplicationId)
     ;
 
     // CameraController
@@ -1257,6 +1281,8 @@ BOOST_PYTHON_MODULE(omega)
         PYAPI_METHOD(Camera, getEyeSeparation)
         PYAPI_METHOD(Camera, isTrackingEnabled)
         PYAPI_METHOD(Camera, setTrackingEnabled)
+        PYAPI_METHOD(Camera, isLateLatchEnabled)
+        PYAPI_METHOD(Camera, setLateLatchEnabled)
         PYAPI_METHOD(Camera, getTrackerSourceId)
         PYAPI_METHOD(Camera, setTrackerSourceId)
         PYAPI_METHOD(Camera, setControllerEnabled)
@@ -1493,6 +1519,9 @@ BOOST_PYTHON_MODULE(omega)
     def("setTileCamera", setTileCamera);
     def("toggleStereo", toggleStereo);
     def("isStereoEnabled", isStereoEnabled);
+    def("requestRedraw", requestRedraw);
+    def("isDisplayIdle", isDisplayIdle);
+    def("enableSceneReplication", enableSceneReplication);
     def("queueCommand", queueCommand);
     def("broadcastCommand", broadcastCommand);
     def("ogetdataprefix", ogetdataprefix);
@@ -160,6 +160,7 @@ namespace omega
             String configFilename = ostr("%1%.cfg", %app.getName());
             String multiAppString = "";
             String mcmode = "default";
+            String launcherAddress = "";
 
             // If we have an environment variable OMEGA_HOME, use it as the
             // default data path. The OMEGA_HOME macro is set to the
@@ -222,6 +223,12 @@ namespace omega
                 "Sets mission control mode. (default, server, disable) ", "In default mode, the application opens a mission control server if enabled in the configuration file. ",
                 mcmode);
 
+            sArgs.newNamedString(
+                'l',
+                "launcher",
+                "Address of the master node launcher (<hostname>:<port>). Set by the master node when launching cluster nodes", "",
+                launcherAddress);
+
             sArgs.newFlag(
                 'd',
                 "disable-sigint",
@@ -355,7 +362,8 @@ namespace omega
                 sys->setApplication(&app);
                 if(remote)
                 {
-                    sys->setupRemote(cfg, masterHostname);
+                    sys->setupRemote(cfg, masterHostname, launcherAddress);
+                    sys->setupMissionControl(mcmode);
                 }
                 else
                 {
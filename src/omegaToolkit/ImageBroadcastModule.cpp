@@ -124,7 +124,7 @@ void ImageBroadcastModule::commitSharedData(SharedOStream& out)
             else
             {
                 out << ch->data->getSize();
-                out.write(ch->data->map(), ch->data->getSize());
+                out.write(ch->data->map(true), ch->data->getSize());
                 ch->data->unmap();
             }
             ch->data->setDirty(false);
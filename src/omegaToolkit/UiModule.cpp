@@ -57,7 +57,8 @@ UiModule::UiModule():
 	myPointerInteractionEnabled(true),
 	myGamepadInteractionEnabled(false),
 	myActiveWidget(NULL),
-	myCullingEnabled(true)
+	myCullingEnabled(true),
+	myHitTestIndexThreshold(16)
 {
 	mysInstance = this;
 	// This module has high priority. It will receive events before modules with lower priority.
@@ -98,6 +99,7 @@ void UiModule::initialize()
 		mysClickButton = Event::parseButtonName(Config::getStringValue("clickButton", sUi, "Button1"));
 		myGamepadInteractionEnabled = Config::getBoolValue("gamepadInteractionEnabled", sUi, myGamepadInteractionEnabled);
 		myPointerInteractionEnabled = Config::getBoolValue("pointerInteractionEnabled", sUi, myPointerInteractionEnabled);
+		myHitTestIndexThreshold = Config::getIntValue("hitTestIndexThreshold", sUi, myHitTestIndexThreshold);
 	}
 
 	omsg("UiModule initialization OK");
@@ -159,6 +161,9 @@ void UiModule::update(const UpdateContext& context)
 ///////////////////////////////////////////////////////////////////////////////////////////////////
 void UiModule::handleEvent(const Event& evt)
 {
+	// New event: view rays computed for the previous one are stale.
+	ui::Container::resetEventCache();
+
 	// If we have an active widget, it always gets the first chance of processing the event.
 	if(myActiveWidget != NULL)
 	{
@@ -38,6 +38,7 @@
 #include "omegaToolkit/SceneEditorModule.h"
 #include "omegaToolkit/UiModule.h"
 #include "omegaToolkit/ui/MenuManager.h"
+#include "omegaToolkit/ui/TiledImage.h"
 #include "omegaToolkit/ToolkitUtils.h"
 #include "omegaToolkit/ImageBroadcastModule.h"
 
@@ -186,6 +187,8 @@ BOOST_PYTHON_MODULE(omegaToolkit)
 		PYAPI_REF_GETTER(UiModule, destroyExtendedUi)
 		PYAPI_METHOD(UiModule, setCullingEnabled)
 		PYAPI_METHOD(UiModule, isCullingEnabled)
+		PYAPI_METHOD(UiModule, setHitTestIndexThreshold)
+		PYAPI_METHOD(UiModule, getHitTestIndexThreshold)
 		;
 
 	// WidgetFactory
@@ -314,6 +317,20 @@ BOOST_PYTHON_MODULE(omegaToolkit)
 		PYAPI_METHOD(Image, setData)
 		;
 
+	// TiledImage
+	PYAPI_REF_CLASS(TiledImage, Widget)
+		PYAPI_STATIC_REF_GETTER(TiledImage, create)
+		PYAPI_METHOD(TiledImage, load)
+		PYAPI_METHOD(TiledImage, getImageWidth)
+		PYAPI_METHOD(TiledImage, getImageHeight)
+		PYAPI_METHOD(TiledImage, getTileSize)
+		PYAPI_METHOD(TiledImage, getNumLevels)
+		PYAPI_METHOD(TiledImage, setMaxCachedTiles)
+		PYAPI_METHOD(TiledImage, getMaxCachedTiles)
+		PYAPI_METHOD(TiledImage, setMaxPendingTiles)
+		PYAPI_METHOD(TiledImage, getMaxPendingTiles)
+		;
+
 	// Slider
 	PYAPI_REF_CLASS(Slider, Widget)
 		PYAPI_STATIC_REF_GETTER(Slider, create)
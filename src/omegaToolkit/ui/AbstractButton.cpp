@@ -54,6 +54,8 @@ void AbstractButton::update(const omega::UpdateContext& context)
 	Widget::update(context);
 	if(myPressedStateChanged)
 	{
+		invalidate();
+
 		// Button was pressed, and now it's not (that is, it has been clicked). Generate a click event.
 		if(!myPressed)
 		{
@@ -78,6 +80,7 @@ void AbstractButton::update(const omega::UpdateContext& context)
 								if(btn != NULL && btn != this && btn->isRadio())
 								{
 									btn->myChecked = false;
+									btn->invalidate();
 								}
 							}
 						}
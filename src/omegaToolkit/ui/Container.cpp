@@ -46,6 +46,185 @@ using namespace omegaToolkit::ui;
 
 NameGenerator sContainerNameGenerator("Container");
 
+// Maximum number of rows / columns in a container hit-testing grid.
+#define MAX_HIT_TEST_GRID_SIZE 64
+
+///////////////////////////////////////////////////////////////////////////////
+// Per-event view ray cache. During a single event dispatch, 3D containers 
+// (possibly nested, and each testing the event more than once) would convert
+// the same event to the same view ray over and over. Every distinct event 
+// gets a new serial, that containers use to cache their plane hits.
+struct ViewRayCache
+{
+    ViewRayCache(): serial(0), event(NULL) {}
+
+    uint serial;
+    const Event* event;
+    int type;
+    int serviceType;
+    int sourceId;
+    Vector3f position;
+    Quaternion orientation;
+    bool hasRay;
+    Ray ray;
+};
+ViewRayCache sViewRayCache;
+
+///////////////////////////////////////////////////////////////////////////////
+uint getCachedViewRay(const Event& evt, Ray& ray, bool& hasRay)
+{
+    ViewRayCache& c = sViewRayCache;
+    if(c.event != &evt || 
+        c.type != evt.getType() ||
+        c.serviceType != evt.getServiceType() ||
+        c.sourceId != evt.getSourceId() ||
+        c.position != evt.getPosition() ||
+        c.orientation.coeffs() != evt.getOrientation().coeffs())
+    {
+        c.serial++;
+        c.event = &evt;
+        c.type = evt.getType();
+        c.serviceType = evt.getServiceType();
+        c.sourceId = evt.getSourceId();
+        c.position = evt.getPosition();
+        c.orientation = evt.getOrientation();
+        c.hasRay = SystemManager::instance()->getDisplaySystem()->getViewRayFromEvent(evt, c.ray);
+    }
+    hasRay = c.hasRay;
+    ray = c.ray;
+    return c.serial;
+}
+
+///////////////////////////////////////////////////////////////////////////////
+bool ContainerHitTestIndex::getBounds(Widget* w, Vector2f& bmin, Vector2f& bmax)
+{
+    // Rotated widgets are not supported by the index.
+    if(w->getRotation() != 0) return false;
+
+    Vector2f lmin = Vector2f::Zero();
+    Vector2f lmax = w->getSize();
+
+    Container* c = dynamic_cast<Container*>(w);
+    if(c != NULL)
+    {
+        // 3D containers hit-test rays, not 2D positions.
+        if(c->get3dSettings().enable3d) return false;
+        // Children are hit-tested regardless of the container bounds (they
+        // can overflow it): include their bounds.
+        foreach(Widget* child, c->myChildren)
+        {
+            Vector2f cmin, cmax;
+            if(!getBounds(child, cmin, cmax)) return false;
+            lmin = lmin.cwiseMin(cmin);
+            lmax = lmax.cwiseMax(cmax);
+        }
+    }
+
+    // Convert to container space, following Widget::transformPoint
+    float s = w->getScale();
+    Vector2f offset = w->getPosition() + w->getSize() * (1 - s) * 0.5f;
+    bmin = lmin * s + offset;
+    bmax = lmax * s + offset;
+    return true;
+}
+
+///////////////////////////////////////////////////////////////////////////////
+void ContainerHitTestIndex::build(const List< Ref<Widget> >& children)
+{
+    myChildren.clear();
+    myChildIndices.clear();
+    myUnbounded.clear();
+    myCells.clear();
+    myColumns = 0;
+    myRows = 0;
+
+    Vector<Vector2f> mins;
+    Vector<Vector2f> maxs;
+    Vector<int> bounded;
+    Vector2f gmin(FLT_MAX, FLT_MAX);
+    Vector2f gmax(-FLT_MAX, -FLT_MAX);
+    foreach(Widget* w, children)
+    {
+        int i = myChildren.size();
+        myChildren.push_back(w);
+        myChildIndices[w] = i;
+
+        Vector2f bmin, bmax;
+        if(getBounds(w, bmin, bmax))
+        {
+            bounded.push_back(i);
+            mins.push_back(bmin);
+            maxs.push_back(bmax);
+            gmin = gmin.cwiseMin(bmin);
+            gmax = gmax.cwiseMax(bmax);
+        }
+        else
+        {
+            myUnbounded.push_back(i);
+        }
+    }
+    if(bounded.size() == 0) return;
+
+    // Aim at about one child per cell, following the aspect ratio of the
+    // area covered by the children (i.e. a vertical list gets a single 
+    // column).
+    int n = bounded.size();
+    Vector2f extent = gmax - gmin;
+    float aspect = (extent[0] > 0 && extent[1] > 0) ? extent[0] / extent[1] : 1.0f;
+    myColumns = (int)sqrt(n * aspect);
+    myColumns = max(1, min(myColumns, MAX_HIT_TEST_GRID_SIZE));
+    myRows = max(1, min((n + myColumns - 1) / myColumns, MAX_HIT_TEST_GRID_SIZE));
+
+    myMin = gmin;
+    myCellSize = Vector2f(
+        max(extent[0] / myColumns, 1.0f),
+        max(extent[1] / myRows, 1.0f));
+    myCells.resize(myColumns * myRows);
+
+    // Children are added in order, so cell lists stay sorted.
+    for(int i = 0; i < n; i++)
+    {
+        int x1 = max(0, min((int)((mins[i][0] - myMin[0]) / myCellSize[0]), myColumns - 1));
+        int y1 = max(0, min((int)((mins[i][1] - myMin[1]) / myCellSize[1]), myRows - 1));
+        int x2 = max(0, min((int)((maxs[i][0] - myMin[0]) / myCellSize[0]), myColumns - 1));
+        int y2 = max(0, min((int)((maxs[i][1] - myMin[1]) / myCellSize[1]), myRows - 1));
+        for(int y = y1; y <= y2; y++)
+        {
+            for(int x = x1; x <= x2; x++)
+            {
+                myCells[y * myColumns + x].push_back(bounded[i]);
+            }
+        }
+    }
+}
+
+///////////////////////////////////////////////////////////////////////////////
+void ContainerHitTestIndex::query(const Vector2f& point, const List<Widget*>& extra, Vector< Ref<Widget> >& result)
+{
+    Vector<int> indices = myUnbounded;
+    if(myColumns > 0)
+    {
+        float fx = (point[0] - myMin[0]) / myCellSize[0];
+        float fy = (point[1] - myMin[1]) / myCellSize[1];
+        if(fx >= 0 && fy >= 0 && fx < myColumns && fy < myRows)
+        {
+            const Vector<int>& cell = myCells[(int)fy * myColumns + (int)fx];
+            indices.insert(indices.end(), cell.begin(), cell.end());
+        }
+    }
+    foreach(Widget* w, extra)
+    {
+        Dictionary<Widget*, int>::iterator it = myChildIndices.find(w);
+        if(it != myChildIndices.end()) indices.push_back(it->second);
+    }
+
+    // Preserve the container order: children earlier in the list get the 
+    // first chance to process the event.
+    std::sort(indices.begin(), indices.end());
+    indices.erase(std::unique(indices.begin(), indices.end()), indices.end());
+    foreach(int i, indices) result.push_back(myChildren[i]);
+}
+
 ///////////////////////////////////////////////////////////////////////////////
 Container* Container::create(Layout layout, Container* container)
 {
@@ -63,7 +242,11 @@ Container::Container(Engine* server):
         myGridRows(1),
         myGridColumns(1),
         myClipping(false),
-        myPixelOutputEnabled(false)
+        myPixelOutputEnabled(false),
+        myHitTestIndexValid(false),
+        myHitTestIndexVersion(0),
+        myPlaneHitSerial(0),
+        myPlaneHit(false)
 {
     // Containers have autosize enabled by default.
     setAutosize(true);
@@ -151,6 +334,15 @@ void Container::addChild(Widget* child)
     requestLayoutRefresh();
     myChildren.push_back(child);
     child->setContainer(this);
+    // Changes made to the child before it was added (i.e. setting a label 
+    // text) did not flag this branch: flag it now.
+    child->requestAutosize();
+    // Keep track of pointer captures held in the child subtree.
+    if(child->myPointerCaptureCount > 0)
+    {
+        myCapturingChildren.push_back(child);
+        updatePointerCapture(child->myPointerCaptureCount);
+    }
     if(child->isNavigationEnabled()) updateChildrenNavigation();
 }
 
@@ -158,6 +350,11 @@ void Container::addChild(Widget* child)
 void Container::removeChild(Widget* child)
 {
     requestLayoutRefresh();
+    if(child->myPointerCaptureCount > 0)
+    {
+        myCapturingChildren.remove(child);
+        updatePointerCapture(-child->myPointerCaptureCount);
+    }
     myChildren.remove(child);
     child->setContainer(NULL);
     if(child->isNavigationEnabled())  updateChildrenNavigation();
@@ -221,14 +418,19 @@ Widget* Container::getChildByIndex(int index)
 ///////////////////////////////////////////////////////////////////////////////
 void Container::updateSize()
 {
-    if(needLayoutRefresh())
+    // Only visit the branches leading to widgets that need a refresh. Children
+    // changing size while they autosize will flag our own layout as dirty.
+    if(mySubtreeNeedLayoutRefresh)
     {
         foreach(Widget* w, myChildren)
         {
-            w->updateSize();
+            if(w->myNeedLayoutRefresh || w->mySubtreeNeedLayoutRefresh)
+            {
+                w->updateSize();
+            }
         }
-        Widget::updateSize();
     }
+    Widget::updateSize();
 }
 
 ///////////////////////////////////////////////////////////////////////////////
@@ -238,6 +440,7 @@ void Container::autosize()
     int height = 0;
     int maxwidth = 0;
     int maxheight = 0;
+    Vector2f prevSize = mySize;
     foreach(Widget* w, myChildren)
     {
         if(w->getWidth() > maxwidth) maxwidth = w->getWidth();
@@ -282,6 +485,9 @@ void Container::autosize()
     myMinimumSize = mySize;
     myMaximumSize = mySize;
     //setSize(Vector2f(width, height));
+
+    // Our size changed: our container needs to lay us out again.
+    if(mySize != prevSize) requestLayoutRefresh();
 }
 
 ///////////////////////////////////////////////////////////////////////////////
@@ -320,13 +526,20 @@ int Container::expandStep(int availableSpace, Orientation orientation)
     // Check space constraints for each child
     int childSpace = availableSpace / getNumChildren();
     int spaceLeft = availableSpace;
+    bool grown = false;
 
     foreach(Widget* w, myChildren)
     {
-        int size = w->getSize()[orientation] + childSpace;
+        int prevSize = w->getSize()[orientation];
+        int size = prevSize + childSpace;
         w->setActualSize(size, orientation);
-        spaceLeft -= (orientation == Horizontal ? w->getWidth(): w->getHeight());
+        int newSize = (orientation == Horizontal ? w->getWidth(): w->getHeight());
+        if(newSize != prevSize) grown = true;
+        spaceLeft -= newSize;
     }
+    // If no child could grow, further steps (with even less space to 
+    // distribute) would not change anything: tell the caller to stop.
+    if(!grown) return 0;
     return spaceLeft;
 }
 
@@ -480,8 +693,13 @@ void Container::layout()
 {
     if(getNumChildren() != 0)
     {
+        // Recompute our own layout only if needed.
         if(needLayoutRefresh())
         {
+            // Remember the children sizes, to find out which ones we resize.
+            Vector<Vector2f> childSizes;
+            foreach(Widget* w, myChildren) childSizes.push_back(w->getSize());
+
             if(myLayout == LayoutHorizontal)
             {
                 computeLinearLayout(Horizontal);
@@ -499,15 +717,28 @@ void Container::layout()
                 computeGridLayout(Vertical);
             }
 
-            // Layout children.
+            int i = 0;
             foreach(Widget* w, myChildren)
             {
-                w->layout();
+                // Resized children need to lay out their own content again.
+                if(w->getSize() != childSizes[i++])
+                {
+                    w->myNeedLayoutRefresh = true;
+                    w->invalidate();
+                }
             }
+        }
 
-            Widget::layout();
+        // Layout dirty branches only.
+        foreach(Widget* w, myChildren)
+        {
+            if(w->myNeedLayoutRefresh || w->mySubtreeNeedLayoutRefresh)
+            {
+                w->layout();
+            }
         }
     }
+    Widget::layout();
 }
 
 ///////////////////////////////////////////////////////////////////////////////
@@ -530,6 +761,7 @@ bool Container::isClippingEnabled()
 void Container::setClippingEnabled(bool value)
 {
     this->myClipping = value;
+    invalidate();
 }
 
 ///////////////////////////////////////////////////////////////////////////////
@@ -547,7 +779,24 @@ bool Container::rayToPointerEvent(const Event& inEvt, Event& outEvt)
     }
 
     Ray r;
-    if(!SystemManager::instance()->getDisplaySystem()->getViewRayFromEvent(inEvt, r))
+    bool hasRay;
+    uint serial = getCachedViewRay(inEvt, r, hasRay);
+
+    // We already intersected this event with our plane: reuse the result.
+    if(serial == myPlaneHitSerial)
+    {
+        if(myPlaneHit)
+        {
+            outEvt.reset(inEvt.getType(), Service::Pointer);
+            outEvt.setPosition(myPlaneHitPosition);
+            outEvt.setFlags(inEvt.getFlags());
+        }
+        return myPlaneHit;
+    }
+    myPlaneHitSerial = serial;
+    myPlaneHit = false;
+
+    if(!hasRay)
     {
         // we could not generate a ray from the input event, return.
         return false;
@@ -602,6 +851,9 @@ bool Container::rayToPointerEvent(const Event& inEvt, Event& outEvt)
         outEvt.setPosition(pointerPosition);
         outEvt.setFlags(inEvt.getFlags());
 
+        myPlaneHit = true;
+        myPlaneHitPosition = pointerPosition;
+
         if(isDebugModeEnabled())
         {
             ofmsg("intersection: %1%    ui pos: %2%", %intersection %pointerPosition);
@@ -647,10 +899,7 @@ void Container::handleEvent(const Event& evt)
             Event newEvt;
             if(rayToPointerEvent(evt, newEvt))
             {
-                foreach(Widget* w, myChildren)
-                {
-                    w->handleEvent(newEvt);
-                }
+                dispatchPointerEvent(newEvt);
             }
             // Copy back processe flag into original event.
             if(newEvt.isProcessed()) evt.setProcessed();
@@ -659,10 +908,19 @@ void Container::handleEvent(const Event& evt)
         {
             if(isPointerInteractionEnabled())
             {
-                // For pointer interaction, just dispatch the event to all children
-                foreach(Widget* w, myChildren)
+                // Pointer events only go to the children under the pointer.
+                // Other events (i.e. wand rays that may hit nested 3D 
+                // containers) go to all children.
+                if(evt.getServiceType() == Event::ServiceTypePointer)
+                {
+                    dispatchPointerEvent(evt);
+                }
+                else
                 {
-                    w->handleEvent(evt);
+                    foreach(Widget* w, myChildren)
+                    {
+                        w->handleEvent(evt);
+                    }
                 }
             }
         }
@@ -672,6 +930,46 @@ void Container::handleEvent(const Event& evt)
     }
 }
 
+///////////////////////////////////////////////////////////////////////////////
+void Container::dispatchPointerEvent(const Event& evt)
+{
+    // Small containers just forward the event to all their children.
+    int threshold = UiModule::instance()->getHitTestIndexThreshold();
+    if(threshold <= 0 || getNumChildren() < threshold)
+    {
+        foreach(Widget* w, myChildren)
+        {
+            w->handleEvent(evt);
+        }
+        return;
+    }
+
+    // Something changed in this container since the index was built 
+    // (children moved, resized, added or removed): rebuild it.
+    if(!myHitTestIndexValid || myHitTestIndexVersion != getContentVersion())
+    {
+        myHitTestIndex.build(myChildren);
+        myHitTestIndexValid = true;
+        myHitTestIndexVersion = getContentVersion();
+    }
+
+    Vector2f point = transformPoint(Vector2f(evt.getPosition().x(), evt.getPosition().y()));
+    // Keep references to the targets: event handlers may remove widgets.
+    Vector< Ref<Widget> > targets;
+    myHitTestIndex.query(point, myCapturingChildren, targets);
+    foreach(Widget* w, targets)
+    {
+        w->handleEvent(evt);
+    }
+}
+
+///////////////////////////////////////////////////////////////////////////////
+void Container::resetEventCache()
+{
+    // Forget the last event: the next ray request gets a new serial.
+    sViewRayCache.event = NULL;
+}
+
 ///////////////////////////////////////////////////////////////////////////////
 void Container::activate()
 {
@@ -710,6 +1008,7 @@ void Container::setPixelOutputEnabled(bool value)
     {
         myPixels = new PixelData(PixelData::FormatRgba, 100, 100);
     }
+    invalidate();
 }
 
 ///////////////////////////////////////////////////////////////////////////////
@@ -830,6 +1129,31 @@ void ContainerRenderable::draw3d(const DrawContext& context)
     }
 }
 
+///////////////////////////////////////////////////////////////////////////////
+bool ContainerRenderable::needsRedraw(const DrawContext& context)
+{
+    // Texture or pixel buffer not created yet or out of date.
+    if(myRenderTarget == NULL) return true;
+    if(myOwner->get3dSettings().enable3d)
+    {
+        if(myTexture->getWidth() != myOwner->getWidth() ||
+            myTexture->getHeight() != myOwner->getHeight()) return true;
+    }
+    else
+    {
+        PixelData* pixels = myOwner->getPixels();
+        if(pixels->getWidth() != myOwner->getWidth() ||
+            pixels->getHeight() != myOwner->getHeight()) return true;
+    }
+
+    uint version = myOwner->getContentVersion();
+    if(version != myRenderedVersion) return true;
+
+    // Content did not change, but we are still drawing the remaining eye 
+    // passes of the frame that re-rendered it.
+    return context.frameNum == myRenderedFrame && context.tile == myRenderedTile;
+}
+
 ///////////////////////////////////////////////////////////////////////////////
 void ContainerRenderable::beginDraw(const DrawContext& context)
 {
@@ -1002,6 +1326,18 @@ void ContainerRenderable::draw(const DrawContext& context)
                 if(!myrect.intersects(vprect)) return;
             }
 
+            // 3D and pixel output containers render to a texture / pixel 
+            // buffer: skip rendering if nothing changed since last time.
+            if(myOwner->get3dSettings().enable3d || myOwner->isPixelOutputEnabled())
+            {
+                if(!needsRedraw(context)) return;
+                // Record the version before drawing: widgets invalidated
+                // while we draw (i.e. loading image tiles) get drawn again.
+                myRenderedVersion = myOwner->getContentVersion();
+                myRenderedFrame = context.frameNum;
+                myRenderedTile = context.tile;
+            }
+
             beginDraw(context);
 
             // draw myself.
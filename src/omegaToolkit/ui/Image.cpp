@@ -83,6 +83,15 @@ void Image::setData(PixelData* value)
 	myData = value; 
 	setSize(Vector2f(myData->getWidth(), myData->getHeight()));
 	refresh(); 
+	invalidate();
+}
+
+///////////////////////////////////////////////////////////////////////////////
+void Image::update(const omega::UpdateContext& context)
+{
+	Widget::update(context);
+	// Image data changed (i.e. a video frame): redraw.
+	if(myData != NULL && myData->isDirty()) invalidate();
 }
 
 ///////////////////////////////////////////////////////////////////////////////
@@ -90,6 +99,7 @@ void Image::flipX(bool value)
 {
 	if(value) myFlipFlags |= DrawInterface::FlipX;
 	else myFlipFlags &= ~DrawInterface::FlipX;
+	invalidate();
 }
 
 ///////////////////////////////////////////////////////////////////////////////
@@ -97,6 +107,7 @@ void Image::flipY(bool value)
 {
 	if(value) myFlipFlags |= DrawInterface::FlipY;
 	else myFlipFlags &= ~DrawInterface::FlipY;
+	invalidate();
 }
 
 ///////////////////////////////////////////////////////////////////////////////
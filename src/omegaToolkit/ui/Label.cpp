@@ -191,7 +191,7 @@ void LabelRenderable::drawContent(const DrawContext& context)
 		}*/
 		// We just set the font: tell our owner that the layout needs to be
 		// refreshed (font size may have changed).
-		myOwner->requestLayoutRefresh();
+		myOwner->requestAutosize();
 
 	}
 
@@ -88,6 +88,7 @@ void Slider::handleEvent(const Event& evt)
 
 		if(evt.getType() == Event::Up)
 		{
+			if(myPressed) endPointerCapture();
 			myPressed = false;
 			if(myValueChanged)
 			{
@@ -101,6 +102,8 @@ void Slider::handleEvent(const Event& evt)
 		{
 			if(evt.getType() == Event::Down)
 			{
+				// Keep receiving pointer events while the slider is dragged.
+				if(!myPressed) beginPointerCapture();
 				myPressed = true;
 				myPressPos = evt.getPosition().x();
 			}
@@ -117,6 +120,7 @@ void Slider::handleEvent(const Event& evt)
 				if(newValue != myValue)
 				{
 					myValue = newValue;
+					invalidate();
 					if(!myDeferUpdate)
 					{
 						Event e;
@@ -172,6 +176,7 @@ void Slider::update(const omega::UpdateContext& context)
 			myValue += myIncrement;
 			if(myValue < 0) myValue = 0;
 			else if(myValue >= myTicks) myValue = myTicks - 1;
+			invalidate();
 			if(!myDeferUpdate)
 			{
 				Event e;
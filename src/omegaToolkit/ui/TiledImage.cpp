@@ -0,0 +1,387 @@
+/******************************************************************************
+ * THE OMEGA LIB PROJECT
+ *-----------------------------------------------------------------------------
+ * Copyright 2010-2013		Electronic Visualization Laboratory, 
+ *							University of Illinois at Chicago
+ * Authors:										
+ *  Alessandro Febretti		febret@gmail.com
+ *-----------------------------------------------------------------------------
+ * Copyright (c) 2010-2013, Electronic Visualization Laboratory,  
+ * University of Illinois at Chicago
+ * All rights reserved.
+ * Redistribution and use in source and binary forms, with or without modification, 
+ * are permitted provided that the following conditions are met:
+ * 
+ * Redistributions of source code must retain the above copyright notice, this 
+ * list of conditions and the following disclaimer. Redistributions in binary 
+ * form must reproduce the above copyright notice, this list of conditions and 
+ * the following disclaimer in the documentation and/or other materials provided 
+ * with the distribution. 
+ * 
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" 
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO THE 
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE 
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE 
+ * LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL 
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE  GOODS OR 
+ * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER 
+ * CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, 
+ * OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE 
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ *-----------------------------------------------------------------------------
+ * What's in this file:
+ *	A widget displaying very large images stored as tiled multiresolution
+ *	pyramids. Only the tiles visible on each display tile are loaded.
+ ******************************************************************************/
+#include "omega/Renderer.h"
+#include "omegaToolkit/ui/TiledImage.h"
+#include "omega/DrawInterface.h"
+#include "omegaToolkit/ui/Container.h"
+
+#include "omega/glheaders.h"
+
+using namespace omega;
+using namespace omegaToolkit;
+using namespace omegaToolkit::ui;
+
+///////////////////////////////////////////////////////////////////////////////
+TiledImage* TiledImage::create(Container* container)
+{
+	TiledImage* img = new TiledImage(Engine::instance());
+	container->addChild(img);
+	return img;
+}
+
+///////////////////////////////////////////////////////////////////////////////
+TiledImage::TiledImage(Engine* srv):
+	Widget(srv),
+	myImageWidth(0),
+	myImageHeight(0),
+	myTileSize(256),
+	myNumLevels(0),
+	myMaxCachedTiles(256),
+	myMaxPendingTiles(8),
+	myVersion(0),
+	myTileRedrawRequested(false)
+{
+	// Like images, tiled images are set to not enabled, and won't take part in navigation.
+	setEnabled(false);
+	setNavigationEnabled(false);
+
+	// Set the default shader.
+	setShaderName("ui/widget-image");
+}
+
+///////////////////////////////////////////////////////////////////////////////
+TiledImage::~TiledImage() 
+{
+}
+
+///////////////////////////////////////////////////////////////////////////////
+Renderable* TiledImage::createRenderable()
+{
+	return new TiledImageRenderable(this);
+}
+
+///////////////////////////////////////////////////////////////////////////////
+void TiledImage::update(const omega::UpdateContext& context)
+{
+	Widget::update(context);
+
+	myTileRedrawLock.lock();
+	bool redraw = myTileRedrawRequested;
+	myTileRedrawRequested = false;
+	myTileRedrawLock.unlock();
+
+	// Tiles are loading: redraw, so containers rendering to a texture draw
+	// us again when they are in.
+	if(redraw) invalidate();
+}
+
+///////////////////////////////////////////////////////////////////////////////
+void TiledImage::requestTileRedraw()
+{
+	myTileRedrawLock.lock();
+	myTileRedrawRequested = true;
+	myTileRedrawLock.unlock();
+}
+
+///////////////////////////////////////////////////////////////////////////////
+bool TiledImage::load(const String& descriptorFile)
+{
+	String path;
+	if(!DataManager::findFile(descriptorFile, path))
+	{
+		ofwarn("TiledImage::load: could not find %1%", %descriptorFile);
+		return false;
+	}
+
+	Ref<Config> cfg = new Config(path);
+	if(!cfg->load() || !cfg->exists("pyramid"))
+	{
+		ofwarn("TiledImage::load: %1% is not a valid pyramid descriptor", %path);
+		return false;
+	}
+
+	Setting& s = cfg->lookup("pyramid");
+	int width = Config::getIntValue("width", s, 0);
+	int height = Config::getIntValue("height", s, 0);
+	int tileSize = Config::getIntValue("tileSize", s, 256);
+	int levels = Config::getIntValue("levels", s, 0);
+	if(width <= 0 || height <= 0 || tileSize <= 0 || levels <= 0)
+	{
+		ofwarn("TiledImage::load: %1%: invalid pyramid size", %path);
+		return false;
+	}
+
+	myImageWidth = width;
+	myImageHeight = height;
+	myTileSize = tileSize;
+	myNumLevels = levels;
+	myTileFormat = Config::getStringValue("tileFormat", s, "jpg");
+
+	// Tiles are stored in the same directory as the descriptor.
+	size_t sep = path.find_last_of("/\\");
+	myTilePath = (sep == String::npos) ? "" : path.substr(0, sep + 1);
+
+	myVersion++;
+	setSize(Vector2f(myImageWidth, myImageHeight));
+	return true;
+}
+
+///////////////////////////////////////////////////////////////////////////////
+String TiledImage::getTilePath(int level, int col, int row)
+{
+	return ostr("%1%%2%/%3%_%4%.%5%", %myTilePath %level %col %row %myTileFormat);
+}
+
+///////////////////////////////////////////////////////////////////////////////
+void TiledImageRenderable::refresh()
+{
+	WidgetRenderable::refresh();
+	myTextureUniform = glGetUniformLocation(myShaderProgram, "unif_Texture");
+}
+
+///////////////////////////////////////////////////////////////////////////////
+TiledImageRenderable::~TiledImageRenderable() 
+{
+}
+
+///////////////////////////////////////////////////////////////////////////////
+TiledImageRenderable::Tile* TiledImageRenderable::requestTile(int level, int col, int row, const DrawContext& context)
+{
+	Tile& t = myTiles[getTileKey(level, col, row)];
+	t.lastUsedFrame = context.frameNum;
+	if(t.pixels.isNull() && t.task.isNull() && !t.failed && 
+		myNumPending < myOwner->myMaxPendingTiles)
+	{
+		t.task = ImageUtils::loadImageAsync(myOwner->getTilePath(level, col, row), true);
+		myNumPending++;
+		myOwner->requestTileRedraw();
+	}
+	return &t;
+}
+
+///////////////////////////////////////////////////////////////////////////////
+void TiledImageRenderable::updatePendingTiles()
+{
+	if(myNumPending == 0) return;
+
+	typedef Dictionary<uint64, Tile>::iterator TileIterator;
+	for(TileIterator it = myTiles.begin(); it != myTiles.end(); it++)
+	{
+		Tile& t = it->second;
+		if(!t.task.isNull() && t.task->isComplete())
+		{
+			t.pixels = t.task->getData().image;
+			// Do not try loading missing or broken tiles again.
+			if(t.pixels.isNull()) t.failed = true;
+			t.task = NULL;
+			myNumPending--;
+		}
+	}
+	if(myNumPending > 0) myOwner->requestTileRedraw();
+}
+
+///////////////////////////////////////////////////////////////////////////////
+bool TileLruSortOp(const std::pair<uint64, uint64>& a, const std::pair<uint64, uint64>& b)
+{ return a.first < b.first; }
+
+///////////////////////////////////////////////////////////////////////////////
+void TiledImageRenderable::trimCache(const DrawContext& context)
+{
+	int maxTiles = myOwner->myMaxCachedTiles;
+	if((int)myTiles.size() <= maxTiles) return;
+
+	// Collect (last used frame, key) pairs for tiles we can drop: tiles still
+	// loading, tiles used this frame and tiles of the coarsest level stay.
+	Vector< std::pair<uint64, uint64> > candidates;
+	typedef Dictionary<uint64, Tile>::iterator TileIterator;
+	for(TileIterator it = myTiles.begin(); it != myTiles.end(); it++)
+	{
+		Tile& t = it->second;
+		int level = (int)(it->first >> 48);
+		if(t.task.isNull() && t.lastUsedFrame < context.frameNum && 
+			level != myOwner->myNumLevels - 1)
+		{
+			candidates.push_back(std::pair<uint64, uint64>(t.lastUsedFrame, it->first));
+		}
+	}
+	std::sort(candidates.begin(), candidates.end(), TileLruSortOp);
+
+	int toRemove = (int)myTiles.size() - maxTiles;
+	for(int i = 0; i < toRemove && i < (int)candidates.size(); i++)
+	{
+		myTiles.erase(candidates[i].second);
+	}
+}
+
+///////////////////////////////////////////////////////////////////////////////
+void TiledImageRenderable::drawTile(int level, int col, int row, const DrawContext& context)
+{
+	int ts = myOwner->myTileSize;
+	Vector2f size = myOwner->getSize();
+
+	// Size of a level pixel in widget units.
+	float fx = (float)(1 << level) * size[0] / myOwner->myImageWidth;
+	float fy = (float)(1 << level) * size[1] / myOwner->myImageHeight;
+	int lw = (myOwner->myImageWidth + (1 << level) - 1) >> level;
+	int lh = (myOwner->myImageHeight + (1 << level) - 1) >> level;
+
+	// Tile extent in level pixels. Rows are counted from the image top.
+	int x0 = col * ts;
+	int y0 = row * ts;
+	int x1 = std::min(x0 + ts, lw);
+	int y1 = std::min(y0 + ts, lh);
+
+	// Find the tile or the closest loaded ancestor. While tiles stream in,
+	// we draw the corresponding region of a coarser level.
+	Tile* t = requestTile(level, col, row, context);
+	int k = 0;
+	while(t->pixels.isNull())
+	{
+		k++;
+		if(level + k >= myOwner->myNumLevels) return;
+		Dictionary<uint64, Tile>::iterator it = 
+			myTiles.find(getTileKey(level + k, col >> k, row >> k));
+		if(it != myTiles.end()) t = &it->second;
+	}
+
+	PixelData* pixels = t->pixels;
+	float pw = pixels->getWidth();
+	float ph = pixels->getHeight();
+
+	// Region of the (ancestor) tile covering this tile, in its pixels.
+	float ax0 = (float)x0 / (1 << k) - (col >> k) * ts;
+	float ay0 = (float)y0 / (1 << k) - (row >> k) * ts;
+	float ax1 = (float)x1 / (1 << k) - (col >> k) * ts;
+	float ay1 = (float)y1 / (1 << k) - (row >> k) * ts;
+
+	DrawInterface* di = getRenderer();
+	di->fillTexture(pixels);
+	di->textureFlip(0);
+	// Images are stored bottom-up: v = 1 is the top of the tile.
+	di->textureRegion(ax0 / pw, 1 - ay1 / ph, ax1 / pw, 1 - ay0 / ph);
+	di->rect(x0 * fx, y0 * fy, (x1 - x0) * fx, (y1 - y0) * fy);
+}
+
+///////////////////////////////////////////////////////////////////////////////
+void TiledImageRenderable::drawContent(const DrawContext& context)
+{
+	WidgetRenderable::drawContent(context);
+
+	if(myOwner->myNumLevels == 0) return;
+
+	// If a new pyramid has been loaded, flush the tile cache.
+	if(myVersion != myOwner->myVersion)
+	{
+		myTiles.clear();
+		myNumPending = 0;
+		myVersion = myOwner->myVersion;
+	}
+
+	updatePendingTiles();
+
+	Vector2f size = myOwner->getSize();
+	if(size[0] <= 0 || size[1] <= 0) return;
+
+	// Compute the visible widget region and the number of screen pixels per
+	// widget unit. Widgets in 3D containers are rendered to a texture: draw
+	// them whole.
+	float vx0 = 0;
+	float vy0 = 0;
+	float vx1 = size[0];
+	float vy1 = size[1];
+	float pixelScale = 1.0f;
+	if(!myOwner->isIn3DContainer())
+	{
+		GLfloat m[16];
+		glGetFloatv(GL_MODELVIEW_MATRIX, m);
+		float a = m[0];
+		float b = m[4];
+		float c = m[1];
+		float d = m[5];
+		float det = a * d - b * c;
+		if(det == 0) return;
+		pixelScale = sqrt(fabs(det));
+
+		// Transform the display tile corners (in canvas coordinates) into
+		// widget coordinates, and intersect their bounding box with the widget.
+		const DisplayTileConfig* tile = context.tile;
+		float cx[2] = { (float)tile->offset[0], (float)(tile->offset[0] + tile->pixelSize[0]) };
+		float cy[2] = { (float)tile->offset[1], (float)(tile->offset[1] + tile->pixelSize[1]) };
+		float minx = FLT_MAX, miny = FLT_MAX, maxx = -FLT_MAX, maxy = -FLT_MAX;
+		for(int i = 0; i < 4; i++)
+		{
+			float px = cx[i & 1] - m[12];
+			float py = cy[i >> 1] - m[13];
+			float lx = (d * px - b * py) / det;
+			float ly = (a * py - c * px) / det;
+			minx = std::min(minx, lx); maxx = std::max(maxx, lx);
+			miny = std::min(miny, ly); maxy = std::max(maxy, ly);
+		}
+		vx0 = std::max(vx0, minx);
+		vy0 = std::max(vy0, miny);
+		vx1 = std::min(vx1, maxx);
+		vy1 = std::min(vy1, maxy);
+		if(vx0 >= vx1 || vy0 >= vy1) return;
+	}
+
+	// Choose the level of detail: the finest level that does not have more 
+	// than one image pixel per screen pixel.
+	int numLevels = myOwner->myNumLevels;
+	float imagePixelsPerScreenPixel = myOwner->myImageWidth / (size[0] * pixelScale);
+	int level = 0;
+	if(imagePixelsPerScreenPixel > 1) level = (int)floor(log(imagePixelsPerScreenPixel) / log(2.0f));
+	level = std::max(0, std::min(level, numLevels - 1));
+
+	if(myTextureUniform != 0)
+	{
+		glUniform1i(myTextureUniform, 0);
+	}
+
+	// Always keep the coarsest level around, to have something to draw 
+	// while finer tiles are loading.
+	int ts = myOwner->myTileSize;
+	int top = numLevels - 1;
+	int tw = (((myOwner->myImageWidth + (1 << top) - 1) >> top) + ts - 1) / ts;
+	int th = (((myOwner->myImageHeight + (1 << top) - 1) >> top) + ts - 1) / ts;
+	for(int r = 0; r < th; r++)
+		for(int c = 0; c < tw; c++)
+			requestTile(top, c, r, context);
+
+	// Draw the visible tiles.
+	float tileW = (float)ts * (1 << level) * size[0] / myOwner->myImageWidth;
+	float tileH = (float)ts * (1 << level) * size[1] / myOwner->myImageHeight;
+	int lw = (myOwner->myImageWidth + (1 << level) - 1) >> level;
+	int lh = (myOwner->myImageHeight + (1 << level) - 1) >> level;
+	int c0 = (int)(vx0 / tileW);
+	int r0 = (int)(vy0 / tileH);
+	int c1 = std::min((int)ceil(vx1 / tileW), (lw + ts - 1) / ts);
+	int r1 = std::min((int)ceil(vy1 / tileH), (lh + ts - 1) / ts);
+	for(int r = r0; r < r1; r++)
+		for(int c = c0; c < c1; c++)
+			drawTile(level, c, r, context);
+
+	trimCache(context);
+}
@@ -37,6 +37,7 @@
 #include "omegaToolkit/ui/Container.h"
 //#include "omegaToolkit/ui/DefaultSkin.h"
 #include "omega/DrawInterface.h"
+#include "omega/DisplaySystem.h"
 #include "omega/EventSharingModule.h"
 #include "omegaToolkit/UiScriptCommand.h"
 
@@ -83,8 +84,12 @@ Widget::Widget(Engine* server):
     myUserData(NULL),
     myDraggable(false),
     myDragging(false),
+    myPointerCaptureCount(0),
     myPinned(false),
-    myShaderEnabled(true)
+    myShaderEnabled(true),
+    myNeedLayoutRefresh(true),
+    mySubtreeNeedLayoutRefresh(false),
+    myContentVersion(0)
 {
     myId = mysNameGenerator.getNext();
     myName = mysNameGenerator.generate();
@@ -254,6 +259,7 @@ void Widget::handleEvent(const Event& evt)
             else if(myDragging && evt.getType() == Event::Up)
             {
                 myDragging = false;
+                endPointerCapture();
                 myActive = false;
                 evt.setProcessed();
             }
@@ -283,6 +289,7 @@ void Widget::handleEvent(const Event& evt)
                     {
                         myUserMovePosition = pos2d;
                         evt.setProcessed();
+                        if(!myDragging) beginPointerCapture();
                         myDragging = true;
                         myActive = true;
                     }
@@ -381,6 +388,38 @@ void Widget::dispatchUIEvent(const Event& evt)
     }
 }
 
+///////////////////////////////////////////////////////////////////////////////
+void Widget::beginPointerCapture()
+{
+    updatePointerCapture(1);
+}
+
+///////////////////////////////////////////////////////////////////////////////
+void Widget::endPointerCapture()
+{
+    if(myPointerCaptureCount > 0) updatePointerCapture(-1);
+}
+
+///////////////////////////////////////////////////////////////////////////////
+void Widget::updatePointerCapture(int delta)
+{
+    // Walk up the container chain, keeping track in each container of the
+    // children holding a capture.
+    Widget* w = this;
+    while(w != NULL)
+    {
+        bool captured = w->myPointerCaptureCount > 0;
+        w->myPointerCaptureCount += delta;
+        Container* c = w->myContainer;
+        if(c != NULL)
+        {
+            if(!captured && w->myPointerCaptureCount > 0) c->myCapturingChildren.push_back(w);
+            else if(captured && w->myPointerCaptureCount == 0) c->myCapturingChildren.remove(w);
+        }
+        w = c;
+    }
+}
+
 ///////////////////////////////////////////////////////////////////////////////
 void Widget::playMenuScrollSound()
 {
@@ -401,10 +440,36 @@ void Widget::playMenuScrollSound()
 
 ///////////////////////////////////////////////////////////////////////////////
 void Widget::requestLayoutRefresh() 
+{ 
+    // Our container places us using our size constraints: its layout needs to
+    // be recomputed too.
+    if(myContainer != NULL) myContainer->myNeedLayoutRefresh = true;
+    requestAutosize();
+}
+
+///////////////////////////////////////////////////////////////////////////////
+void Widget::requestAutosize() 
 { 
     myNeedLayoutRefresh = true; 
-    if(myContainer != NULL) 
-        myContainer->requestLayoutRefresh(); 
+    // Flag the branch leading to this widget, so layout passes can skip the
+    // clean ones.
+    Container* c = myContainer;
+    while(c != NULL)
+    {
+        c->mySubtreeNeedLayoutRefresh = true;
+        c = c->myContainer;
+    }
+    // A layout change changes the widget appearance too.
+    invalidate();
+}
+
+///////////////////////////////////////////////////////////////////////////////
+void Widget::invalidate() 
+{ 
+    myContentVersion++;
+    // Widget changes wake up an idle display.
+    if(myContainer != NULL) myContainer->invalidate(); 
+    else DisplaySystem::requestRedraw();
 }
 
 ///////////////////////////////////////////////////////////////////////////////
@@ -417,6 +482,7 @@ bool Widget::needLayoutRefresh()
 void Widget::layout()
 { 
     myNeedLayoutRefresh = false; 
+    mySubtreeNeedLayoutRefresh = false;
 }
 
 ///////////////////////////////////////////////////////////////////////////////
@@ -537,6 +603,8 @@ void Widget::updateStyle()
     if(bdstyle != "") myBorders[2].fromString(bdstyle);
     bdstyle = getStyleValue("border-left");
     if(bdstyle != "") myBorders[3].fromString(bdstyle);
+
+    invalidate();
 }
 
 ///////////////////////////////////////////////////////////////////////////////